@@ -11,7 +11,9 @@
 #ifndef ARRAY_LIST_H
 #define ARRAY_LIST_H
 
+#include <utility>
 #include "list.h"
+#include "dynamic_memory.h"
 
 template<typename T>
 class ArrayList : public List<T>
@@ -19,15 +21,27 @@ class ArrayList : public List<T>
 public:
   ArrayList();
   ArrayList(const ArrayList<T>& rhs);
+  ArrayList(ArrayList<T>&& rhs);
   ~ArrayList();
   ArrayList& operator=(const ArrayList<T>& rhs);
+  ArrayList& operator=(ArrayList<T>&& rhs);
 
   void add(const T& item);
+  void add(T&& item);
+  template<typename... Args>
+  void emplace(Args&&... args);
   bool add(size_t index, const T& item);
+  bool add(size_t index, T&& item);
   bool get(size_t index, T& return_item) const;
   bool set(size_t index, const T& new_item);
+  // unchecked access to the item at index (no copy)
+  T& operator[](size_t index);
+  const T& operator[](size_t index) const;
   bool remove(size_t index);
   size_t size() const;
+  // bytes allocated for the items array (including unused capacity)
+  // and by the items themselves
+  size_t dynamic_memory() const;
   void selection_sort();
   void insertion_sort();
   void merge_sort();
@@ -64,6 +78,16 @@ ArrayList<T>::ArrayList(const ArrayList<T>& rhs)
   *this = rhs;
 }
 
+template<typename T>
+ArrayList<T>::ArrayList(ArrayList<T>&& rhs)
+  : items(rhs.items), capacity(rhs.capacity), length(rhs.length)
+{
+  // take the rhs array, leaving rhs empty
+  rhs.items = nullptr;
+  rhs.capacity = 0;
+  rhs.length = 0;
+}
+
 template<typename T>
 ArrayList<T>::~ArrayList()
 {
@@ -87,6 +111,22 @@ ArrayList<T>& ArrayList<T>::operator=(const ArrayList<T>& rhs)
   return *this;
 }
 
+template<typename T>
+ArrayList<T>& ArrayList<T>::operator=(ArrayList<T>&& rhs)
+{
+  if(this != &rhs){
+    delete[] items; // deletes the lhs array
+    // take the rhs array, leaving rhs empty
+    items = rhs.items;
+    capacity = rhs.capacity;
+    length = rhs.length;
+    rhs.items = nullptr;
+    rhs.capacity = 0;
+    rhs.length = 0;
+  }
+  return *this;
+}
+
 //  Function: add()
 //  Description: Appends a given input to the end of an ArrayList object
 //  Inputs: Item to be added
@@ -101,6 +141,37 @@ void ArrayList<T>::add(const T& item)
   length++; // update the length variable
 }
 
+//  Function: add()
+//  Description: Appends a given input to the end of an ArrayList object,
+//  moving it into the list instead of copying it
+//  Inputs: Item to be added
+//  Outputs: None
+template<typename T>
+void ArrayList<T>::add(T&& item)
+{
+  if(length == capacity){
+    resize(); // if the Array List is at capacity, then resize it
+  }
+  items[length] = std::move(item);
+  length++; // update the length variable
+}
+
+//  Function: emplace()
+//  Description: Builds a new item from the given arguments and appends it
+//  to the end of an ArrayList object
+//  Inputs: Arguments for the item's constructor
+//  Outputs: None
+template<typename T>
+template<typename... Args>
+void ArrayList<T>::emplace(Args&&... args)
+{
+  if(length == capacity){
+    resize(); // if the Array List is at capacity, then resize it
+  }
+  items[length] = T(std::forward<Args>(args)...);
+  length++; // update the length variable
+}
+
 //  Function: add()
 //  Description: Appends a given input at a given index of an ArrayList object
 //  Inputs: Index where you wouldlike to add the item, and the item to be added
@@ -115,13 +186,34 @@ bool ArrayList<T>::add(size_t index, const T& item)
   }
   if(length+1 > capacity) resize(); // if the new length will exceed the capacity, resize the array
   for(int i = length; i > index; --i){
-    items[i] = items[i-1];  // shifts the items after index right by one
+    items[i] = std::move(items[i-1]);  // shifts the items after index right by one
   }
   items[index] = item;  // sets the item at index to item
   length++; // increases the length by 1
   return true;
 }
 
+//  Function: add()
+//  Description: Moves a given input into a given index of an ArrayList object
+//  Inputs: Index where you would like to add the item, and the item to be added
+//  Outputs: None
+template<typename T>
+bool ArrayList<T>::add(size_t index, T&& item)
+{
+  if(index > length) return false;
+  if(index == length){
+    add(std::move(item));
+    return true;
+  }
+  if(length+1 > capacity) resize(); // if the new length will exceed the capacity, resize the array
+  for(size_t i = length; i > index; --i){
+    items[i] = std::move(items[i-1]);  // shifts the items after index right by one
+  }
+  items[index] = std::move(item);
+  length++; // increases the length by 1
+  return true;
+}
+
 //  Function: get()
 //  Description: Provides the user with the item at a specific index of an ArrayList object
 //  Inputs: Index you would like the item of
@@ -146,6 +238,23 @@ bool ArrayList<T>::set(size_t index, const T& new_item)
   return true;
 }
 
+//  Function: operator[]()
+//  Description: Gives direct access to the item at a specific index of an
+//  ArrayList object (the index is not checked)
+//  Inputs: Index you would like the item of
+//  Outputs: Reference to the item at the given index
+template<typename T>
+T& ArrayList<T>::operator[](size_t index)
+{
+  return items[index];
+}
+
+template<typename T>
+const T& ArrayList<T>::operator[](size_t index) const
+{
+  return items[index];
+}
+
 //  Function: remove()
 //  Description: Removes the item at the given index of an ArrayList object, and adjusts the remaining list accordingly
 //  Inputs: Index of where you would like the item to be removed from
@@ -155,7 +264,7 @@ bool ArrayList<T>::remove(size_t index)
 {
   if(index >= length || index < 0) return false;
   for(int i = index; i < length-1; i++){
-    items[i] = items[i+1];  // all items in the Array List are shifted one to the left and the item at index is overwritten
+    items[i] = std::move(items[i+1]);  // all items in the Array List are shifted one to the left and the item at index is overwritten
   }
   length--; // the length of the array is shortened, which cuts off the last value of the old Array List
   return true;
@@ -171,6 +280,20 @@ size_t ArrayList<T>::size() const
   return length;
 }
 
+//  Function: dynamic_memory()
+//  Description: Gives the heap memory used by an ArrayList object
+//  Inputs: None
+//  Outputs: Bytes of the items array (every slot, used or not) plus
+//  the dynamic memory of the items in it
+template<typename T>
+size_t ArrayList<T>::dynamic_memory() const
+{
+  size_t bytes = capacity * sizeof(T);
+  for(size_t i = 0; i < capacity; ++i)
+    bytes += DynamicMemory<T>::bytes(items[i]);
+  return bytes;
+}
+
 //  Function: resize()
 //  Description: Doubles the capacity of an ArrayList object
 //  Inputs: None
@@ -178,10 +301,10 @@ size_t ArrayList<T>::size() const
 template<typename T>
 void ArrayList<T>::resize()
 {
-  capacity *= 2;  // double capacity of the current array
+  capacity = capacity ? 2*capacity : 10;  // double capacity of the current array
   T* tmp = new T[capacity]; 
   for(int i = 0; i < length; i++){
-    tmp[i] = items[i];  // store items in new temporary arrray of size capacity
+    tmp[i] = std::move(items[i]);  // move items into new temporary arrray of size capacity
   }
   delete []items; // delete old Array List
   items = tmp;
@@ -323,4 +446,14 @@ void ArrayList<T>::sort()
   quick_sort();
 }
 
+// counts a list (and its items) held as a key or value
+template<typename T>
+struct DynamicMemory<ArrayList<T>>
+{
+  static size_t bytes(const ArrayList<T>& item)
+  {
+    return item.dynamic_memory();
+  }
+};
+
 #endif
\ No newline at end of file
@@ -17,10 +17,15 @@ class ArrayListCollection : public Collection<K,V>
     void add(const K& key, const V& val);
     void remove(const K& key);
     bool find(const K& search_key, V& return_val) const;
+    V& find_or_insert(const K& key);
+    bool insert_or_assign(const K& key, const V& val);
+    V* find_ptr(const K& key);
+    const V* find_ptr(const K& key) const;
     void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
     void keys(ArrayList<K>& all_keys) const;
     void sort(ArrayList<K>& all_keys_sorted) const;
     size_t size() const;
+    size_t memory_usage() const;
 
     private:
     ArrayList<std::pair<K,V>> kv_list;
@@ -73,6 +78,57 @@ bool ArrayListCollection<K,V>::find(const K& search_key, V& return_val) const
   return false; // return false if the given key is not found
 }
 
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value to the end of the list if it is not found
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V>
+V& ArrayListCollection<K,V>::find_or_insert(const K& key)
+{
+  V* val = find_ptr(key);
+  if(val) return *val;
+  kv_list.add(std::pair<K,V>(key, V()));
+  return kv_list[size()-1].second;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the collection
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V>
+bool ArrayListCollection<K,V>::insert_or_assign(const K& key, const V& val)
+{
+  V* cur = find_ptr(key);
+  if(cur){
+    *cur = val;
+    return false;
+  }
+  kv_list.add(std::pair<K,V>(key, val));
+  return true;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V>
+V* ArrayListCollection<K,V>::find_ptr(const K& key)
+{
+  const ArrayListCollection<K,V>* self = this;
+  return const_cast<V*>(self->find_ptr(key));
+}
+
+template<typename K, typename V>
+const V* ArrayListCollection<K,V>::find_ptr(const K& key) const
+{
+  for(size_t i = 0; i < size(); ++i){
+    if(kv_list[i].first == key) return &kv_list[i].second;
+  }
+  return nullptr; // return nullptr if the given key is not found
+}
+
 //  Function: find()
 //  Description: Finds and returns all keys between the given k1 and k2 keys
 //  Inputs: Given key "limits"
@@ -125,4 +181,15 @@ size_t ArrayListCollection<K,V>::size() const
   return kv_list.size();
 }
 
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection, including
+//  the unused capacity of the list
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V>
+size_t ArrayListCollection<K,V>::memory_usage() const
+{
+  return sizeof(*this) + kv_list.dynamic_memory();
+}
+
 #endif
\ No newline at end of file
@@ -9,26 +9,41 @@
 #ifndef AVL_COLLECTION_H
 #define AVL_COLLECTION_H
 
+#include <utility>
 #include "collection.h"
+#include "key_compare.h"
 #include "array_list.h"
 
-template<typename K, typename V>
+template<typename K, typename V, typename Compare = ThreeWayCompare<K>>
 class AVLCollection : public Collection<K,V>
 {
   public:
     AVLCollection();
-    AVLCollection(const AVLCollection<K,V>& rhs);
+    AVLCollection(const AVLCollection<K,V,Compare>& rhs);
+    AVLCollection(AVLCollection<K,V,Compare>&& rhs);
     ~AVLCollection();
-    AVLCollection& operator=(const AVLCollection<K,V>& rhs);
+    AVLCollection& operator=(const AVLCollection<K,V,Compare>& rhs);
+    AVLCollection& operator=(AVLCollection<K,V,Compare>&& rhs);
 
     void add(const K& key, const V& val);
+    void add(K&& key, V&& val);
+    template<typename KK, typename... Args>
+    void emplace(KK&& key, Args&&... args);
     void remove(const K& key);
+    void remove(const K& k1, const K& k2); // each key >= k1 and <= k2
     bool find(const K& search_key, V& return_val) const;
+    V& find_or_insert(const K& key);
+    bool insert_or_assign(const K& key, const V& val);
+    V* find_ptr(const K& key);
+    const V* find_ptr(const K& key) const;
+    template<typename Q>
+    bool find(const Q& search_key, V& return_val) const; // any key-like type
     void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
     void keys(ArrayList<K>& all_keys) const;
     void sort(ArrayList<K>& all_keys_sorted) const;
     size_t size() const;
     size_t height() const;
+    size_t memory_usage() const;
 
   private:
     struct Node{
@@ -37,67 +52,112 @@ class AVLCollection : public Collection<K,V>
       int height;
       Node* left;
       Node* right;
+
+      Node() {}
+      // builds the key and value in place for a new leaf
+      template<typename KK, typename... Args>
+      Node(KK&& k, Args&&... args)
+        : key(std::forward<KK>(k)), value(std::forward<Args>(args)...),
+          height(1), left(nullptr), right(nullptr) {}
     };
 
     Node* root; // root of the tree
     size_t node_count;  // number of Nodes in the tree
 
+    // three-way compare of two keys using the comparison policy
+    template<typename A, typename B>
+    static int compare(const A& a, const B& b) {return Compare()(a, b);}
+
     // helper functions
+    // for find and find_ptr
+    template<typename Q>
+    Node* find_node(const Q& search_key) const;
+    // for find_or_insert and insert_or_assign
+    template<typename... Args>
+    Node* find_or_add(const K& key, bool& added, Args&&... args);
     // for destructor
     void make_empty(Node* subtree_root);
     // for copy constructor
     void copy(Node* lhs_subtree_root, const Node* rhs_subtree_root);
     // for add
-    Node* add(Node* subtree_root, const K& key, const V& val);
-    // for remove
-    Node* remove(Node* subtree_root, const K& key);
+    Node* add(Node* subtree_root, Node* new_node);
+    // for find_or_add (sets found to the key's Node, adding one built
+    // from args if the key is not in the subtree)
+    template<typename... Args>
+    Node* add(Node* subtree_root, const K& key, bool& added, Node*& found,
+              Args&&... args);
+    // for remove (sets removed if the key was found)
+    Node* remove(Node* subtree_root, const K& key, bool& removed);
     // for find-range
     void find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const;
     // for keys
     void keys(const Node* subtree_root, ArrayList<K>& keys) const;
+    // for memory_usage
+    size_t dynamic_memory(const Node* subtree_root) const;
     // to help with right rotations
     Node* rotate_right(Node* k2);
     // to help with left rotations
     Node* rotate_left(Node* k2);
     // to rebalance the AVL tree
     Node* rebalance(Node* subtree_root);
+    // for range remove
+    Node* remove_range(Node* subtree_root, const K& k1, const K& k2);
+    // to join two trees with m in between (keys in l < m < keys in r)
+    Node* join(Node* l, Node* m, Node* r);
+    // to join two trees (keys in l < keys in r)
+    Node* join(Node* l, Node* r);
+    // to detach the smallest Node of a tree for join
+    Node* remove_min(Node* subtree_root, Node*& min);
+    // to restore the balance of a Node whose subtrees differ in height
+    // by at most 2 (recomputing the heights)
+    Node* join_balance(Node* subtree_root);
+    // height of a subtree (0 if empty)
+    static int height(const Node* subtree_root);
+    // to recompute a Node's height from its children
+    static void update_height(Node* subtree_root);
 };
 
-template<typename K, typename V>
-AVLCollection<K,V>::AVLCollection()
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>::AVLCollection()
   : node_count(0)
 {
   root = nullptr;
 }
 
-template<typename K, typename V>
-AVLCollection<K,V>::AVLCollection(const AVLCollection<K,V>& rhs)
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>::AVLCollection(const AVLCollection<K,V,C>& rhs)
   : node_count(0), root(nullptr)
 {
   // defer to the assignment operator
   *this = rhs;
 }
 
-template<typename K, typename V>
-AVLCollection<K,V>::~AVLCollection()
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>::AVLCollection(AVLCollection<K,V,C>&& rhs)
+  : root(rhs.root), node_count(rhs.node_count)
+{
+  // take the rhs tree, leaving rhs empty
+  rhs.root = nullptr;
+  rhs.node_count = 0;
+}
+
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>::~AVLCollection()
 {
   make_empty(root);
   root = nullptr;
 }
 
-template<typename K, typename V>
-AVLCollection<K,V>& AVLCollection<K,V>::operator=(const AVLCollection<K,V>& rhs)
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>& AVLCollection<K,V,C>::operator=(const AVLCollection<K,V,C>& rhs)
 {
   if(this != &rhs){
     make_empty(root); // delete the lhs tree
     root = nullptr;
-    root = new Node;
     if(rhs.root){
       // copy rhs root into lhs root
-      root->key = rhs.root->key;
-      root->value = rhs.root->value;
-      root->left = nullptr;
-      root->right = nullptr;
+      root = new Node(rhs.root->key, rhs.root->value);
+      root->height = rhs.root->height;
       node_count++; // increment node_count variable
       copy(root, rhs.root); // copy the rhs tree into the lhs tree
     }
@@ -105,14 +165,52 @@ AVLCollection<K,V>& AVLCollection<K,V>::operator=(const AVLCollection<K,V>& rhs)
   return *this;
 }
 
+template<typename K, typename V, typename C>
+AVLCollection<K,V,C>& AVLCollection<K,V,C>::operator=(AVLCollection<K,V,C>&& rhs)
+{
+  if(this != &rhs){
+    make_empty(root); // delete the lhs tree
+    // take the rhs tree, leaving rhs empty
+    root = rhs.root;
+    node_count = rhs.node_count;
+    rhs.root = nullptr;
+    rhs.node_count = 0;
+  }
+  return *this;
+}
+
 //  Function: add()
 //  Description: Adds a new key-value pair to the tree in the correct hashed location
 //  Inputs: Key and value to be added to the tree
 //  Outputs: None
-template<typename K, typename V>
-void AVLCollection<K,V>::add(const K& key, const V& val)
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::add(const K& key, const V& val)
+{
+  emplace(key, val);
+}
+
+//  Function: add()
+//  Description: Adds a new key-value pair to the tree, moving the key and
+//  value into the new Node instead of copying them
+//  Inputs: Key and value to be added to the tree
+//  Outputs: None
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::add(K&& key, V&& val)
+{
+  emplace(std::move(key), std::move(val));
+}
+
+//  Function: emplace()
+//  Description: Adds a new key-value pair to the tree, building the key
+//  and value in place inside the new Node
+//  Inputs: Key (or argument for the key) and the arguments for the value
+//  Outputs: None
+template<typename K, typename V, typename C>
+template<typename KK, typename... Args>
+void AVLCollection<K,V,C>::emplace(KK&& key, Args&&... args)
 {
-  root = add(root, key, val);
+  Node* new_node = new Node(std::forward<KK>(key), std::forward<Args>(args)...);
+  root = add(root, new_node);
   ++node_count; // increment node_count
 }
 
@@ -120,43 +218,101 @@ void AVLCollection<K,V>::add(const K& key, const V& val)
 //  Description: Removes the requested key-value pair from the tree
 //  Inputs: The key of the pair to be removed
 //  Outputs: None
-template<typename K, typename V>
-void AVLCollection<K,V>::remove(const K& key)
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::remove(const K& key)
 {
-  root = remove(root, key);
-  --node_count; // decrease node_count
+  bool removed = false;
+  root = remove(root, key, removed);
+  if(removed) --node_count; // decrease node_count
+}
+
+//  Function: remove()
+//  Description: Removes every pair in a range of keys in one pass, joining
+//  the subtrees kept on either side of the range by height
+//  Inputs: Smallest and largest key of the range
+//  Outputs: None
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::remove(const K& k1, const K& k2)
+{
+  if(compare(k2, k1) < 0) return;
+  root = remove_range(root, k1, k2);
 }
 
 //  Function: find()
 //  Description: Finds the value associated with the given key, if it exists in the tree
 //  Inputs: Key to be found
 //  Outputs: Value associated with the key, whether or not the pair exists in the tree
-template<typename K, typename V>
-bool AVLCollection<K,V>::find(const K& search_key, V& return_val) const
+template<typename K, typename V, typename C>
+bool AVLCollection<K,V,C>::find(const K& search_key, V& return_val) const
+{
+  return find<K>(search_key, return_val);
+}
+
+//  Function: find()
+//  Description: Finds the value associated with a key-like search key
+//  (one that can be compared directly with the keys in the tree)
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key, whether or not the pair exists in the tree
+template<typename K, typename V, typename C>
+template<typename Q>
+bool AVLCollection<K,V,C>::find(const Q& search_key, V& return_val) const
 {
-  // special case if the tree is empty
-  if(node_count == 0) return false;
+  Node* cur = find_node(search_key);
+  if(!cur) return false;
+  return_val = cur->value;  // return the value at cur
+  return true;  // return true since you found search_key
+}
 
-  Node* cur = root; // Node pointer to keep track of current location in the tree
-  while(cur){
-    if(search_key == cur->key){ // search_key is found
-      return_val = cur->value;  // return the value at cur
-      return true;  // return true since you found search_key
-    }
-    else if(search_key < cur->key) // key at cur is less than search_key
-      cur = cur->left;  // iterate through cur's left subtree
-    else  // key at cur is greater than search_key
-      cur = cur->right; // iterate through cur's right subtree
-  }
-  return false; // return false since you did not find search_key
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value if it is not in the tree
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename C>
+V& AVLCollection<K,V,C>::find_or_insert(const K& key)
+{
+  bool added;
+  return find_or_add(key, added)->value;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the tree
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename C>
+bool AVLCollection<K,V,C>::insert_or_assign(const K& key, const V& val)
+{
+  bool added;
+  Node* cur = find_or_add(key, added, val);
+  if(!added) cur->value = val;
+  return added;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V, typename C>
+V* AVLCollection<K,V,C>::find_ptr(const K& key)
+{
+  Node* cur = find_node(key);
+  return cur ? &cur->value : nullptr;
+}
+
+template<typename K, typename V, typename C>
+const V* AVLCollection<K,V,C>::find_ptr(const K& key) const
+{
+  Node* cur = find_node(key);
+  return cur ? &cur->value : nullptr;
 }
 
 //  Function: find()
 //  Description: Finds and returns all keys between the given k1 and k2 keys
 //  Inputs: Given key "limits"
 //  Outputs: All keys between the given "limits"
-template<typename K, typename V>
-void AVLCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   find(root, k1, k2, keys);
 }
@@ -165,8 +321,8 @@ void AVLCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) cons
 //  Description: Returns a list of all the keys in the tree (using in-order traversal)
 //  Inputs: None
 //  Outputs: List of all keys in the collection
-template<typename K, typename V>
-void AVLCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::keys(ArrayList<K>& all_keys) const
 {
   keys(root, all_keys);
 }
@@ -175,8 +331,8 @@ void AVLCollection<K,V>::keys(ArrayList<K>& all_keys) const
 //  Description: Returns a list of all the keys in sorted order
 //  Inputs: None
 //  Outputs: A list of the keys in the system in sorted order
-template<typename K, typename V>
-void AVLCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::sort(ArrayList<K>& all_keys_sorted) const
 {
   keys(all_keys_sorted);
 }
@@ -185,26 +341,37 @@ void AVLCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
 //  Description: Returns the number of key-value pairs of the tree
 //  Inputs: None
 //  Outputs: The number of key-value pairs in the tree
-template<typename K, typename V>
-size_t AVLCollection<K,V>::size() const
+template<typename K, typename V, typename C>
+size_t AVLCollection<K,V,C>::size() const
 {
   return node_count;
 }
 
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the tree object, its nodes,
+//  and the keys' and values' dynamic memory
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename C>
+size_t AVLCollection<K,V,C>::memory_usage() const
+{
+  return sizeof(*this) + node_count * sizeof(Node) + dynamic_memory(root);
+}
+
 //  Function: height()
 //  Description: Returns the height of the tree
 //  Inputs: None
 //  Outputs: The height of the tree (counting of nodes)
-template<typename K, typename V>
-size_t AVLCollection<K,V>::height() const
+template<typename K, typename V, typename C>
+size_t AVLCollection<K,V,C>::height() const
 {
   if(size() > 0)  return root->height;
   else return 0;
 }
 
 // helper function for destructor
-template<typename K, typename V>
-void AVLCollection<K,V>::make_empty(Node* subtree_root)
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::make_empty(Node* subtree_root)
 {
   // if the subtree root is null, return (base case)
   if(!subtree_root){
@@ -225,8 +392,8 @@ void AVLCollection<K,V>::make_empty(Node* subtree_root)
 }
 
 // helper function for copy constructor
-template<typename K, typename V>
-void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
 {
   // base case (if the root is nullptr)
   if(!rhs_subtree_root) return;
@@ -236,6 +403,7 @@ void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
     Node* tmp = new Node;
     tmp->key = rhs_subtree_root->left->key;
     tmp->value = rhs_subtree_root->left->value;
+    tmp->height = rhs_subtree_root->left->height;
     tmp->left = nullptr;
     tmp->right = nullptr;
 
@@ -253,6 +421,7 @@ void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
     Node* tmp = new Node;
     tmp->key = rhs_subtree_root->right->key;
     tmp->value = rhs_subtree_root->right->value;
+    tmp->height = rhs_subtree_root->right->height;
     tmp->left = nullptr;
     tmp->right = nullptr;
 
@@ -266,26 +435,20 @@ void AVLCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_ro
 }
 
 // helper function for add
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node*
-AVLCollection<K,V>::add(Node* subtree_root, const K& key, const V& val)
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::add(Node* subtree_root, Node* new_node)
 {
   if(!subtree_root){
-    // if the subtree root is null, add a new node containing key and val
-    Node* new_node = new Node;
-    new_node->key = key;
-    new_node->value = val;
-    new_node->height = 1;
-    new_node->left = nullptr;
-    new_node->right = nullptr;
+    // if the subtree root is null, the new node becomes the subtree
     subtree_root = new_node;
   }
   else{
-    if(key <= subtree_root->key){ // key should be in the left subtree
-      subtree_root->left = add(subtree_root->left, key, val);
+    if(compare(new_node->key, subtree_root->key) <= 0){ // key should be in the left subtree
+      subtree_root->left = add(subtree_root->left, new_node);
     }
     else{ // key should be in the right subtree
-      subtree_root->right = add(subtree_root->right, key, val);
+      subtree_root->right = add(subtree_root->right, new_node);
     }
     // adjust (calculate) heights
     Node* lptr = subtree_root->left;
@@ -309,23 +472,25 @@ AVLCollection<K,V>::add(Node* subtree_root, const K& key, const V& val)
 }
 
 // helper function for remove
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node*
-AVLCollection<K,V>::remove(Node* subtree_root, const K& key)
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::remove(Node* subtree_root, const K& key, bool& removed)
 {
   if(!subtree_root) return nullptr;
+  int c = compare(key, subtree_root->key);
   // traverse the left subtree if the key is less than the key of subtree_root
-  if(subtree_root && key < subtree_root->key){
-    subtree_root->left = remove(subtree_root->left, key);
+  if(c < 0){
+    subtree_root->left = remove(subtree_root->left, key, removed);
   }
  
   // traverse the right subtree if the key is greater than the key of subtree_root
-  else if(subtree_root && key > subtree_root->key){
-    subtree_root->right = remove(subtree_root->right, key);
+  else if(c > 0){
+    subtree_root->right = remove(subtree_root->right, key, removed);
   }
 
   // remove subtree_root (since you have found the Node containing key)
   else if(subtree_root){
+    removed = true;
     // case 1 - 0 or 1 child
     if(!subtree_root->left || !subtree_root->right){
       if(subtree_root->left){
@@ -364,7 +529,7 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& key)
         subtree_root->value = successor->value;
 
         // delete successor
-        subtree_root->right = remove(subtree_root->right, successor->key);
+        subtree_root->right = remove(subtree_root->right, successor->key, removed);
       }
       // special case (if subtree_root's right subtree contains only one Node)
       else{
@@ -375,8 +540,8 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& key)
         subtree_root->key = successor->key;
         subtree_root->value = successor->value;
 
-        // redirect and delete subtree_root
-        subtree_root->right = remove(subtree_root->right, successor->key);
+        // the successor has been unlinked, so delete it directly
+        delete successor;
       }
     }
   }
@@ -400,22 +565,24 @@ AVLCollection<K,V>::remove(Node* subtree_root, const K& key)
   else{
     subtree_root->height = 1;
   }
-  return rebalance(subtree_root);
+  // a remove can leave the taller child with equal-height subtrees,
+  // which rebalance (written for adds) doesn't handle
+  return join_balance(subtree_root);
 }
 
 // helper function for find-range
-template<typename K, typename V>
-void AVLCollection<K,V>::find(const Node* subtree_root, 
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::find(const Node* subtree_root, 
 const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   // check if you have reached the end of a path (base case)
   if(!subtree_root) return;
 
   // traverse through the tree
-  if(subtree_root->key < k1){
+  if(compare(subtree_root->key, k1) < 0){
     find(subtree_root->right, k1, k2, keys);  // traverse right
   }
-  else if(subtree_root->key >= k1 && subtree_root->key <= k2){
+  else if(compare(subtree_root->key, k2) <= 0){
     keys.add(subtree_root->key);  // if the key is within range, add it to the array list
     find(subtree_root->right, k1, k2, keys);  // traverse right
     find(subtree_root->left, k1, k2, keys); // traverse left
@@ -426,8 +593,8 @@ const K& k1, const K& k2, ArrayList<K>& keys) const
 }
 
 // helper function for keys
-template<typename K, typename V>
-void AVLCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
 {
   // check if you have reached the end of a path (base case)
   if(!subtree_root) return;
@@ -439,10 +606,20 @@ void AVLCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys)
   keys(subtree_root->right, all_keys);
 }
 
+// helper function for memory_usage
+template<typename K, typename V, typename C>
+size_t AVLCollection<K,V,C>::dynamic_memory(const Node* subtree_root) const
+{
+  if(!subtree_root) return 0;
+  return DynamicMemory<K>::bytes(subtree_root->key)
+    + DynamicMemory<V>::bytes(subtree_root->value)
+    + dynamic_memory(subtree_root->left) + dynamic_memory(subtree_root->right);
+}
+
 // helper function for right rotations
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node*
-AVLCollection<K,V>::rotate_right(Node* k2)
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::rotate_right(Node* k2)
 {
   Node* k1 = k2->left;  // k1 is k2's left child
   k2->left = k1->right; // point k2's left to k1's right subtree
@@ -451,9 +628,9 @@ AVLCollection<K,V>::rotate_right(Node* k2)
 }
 
 // helper function for left rotations
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node*
-AVLCollection<K,V>::rotate_left(Node* k2)
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::rotate_left(Node* k2)
 {
   Node* k1 = k2->right;  // k1 is k2's right child
   k2->right = k1->left; // point k2's right to k1's left subtree
@@ -462,9 +639,9 @@ AVLCollection<K,V>::rotate_left(Node* k2)
 }
 
 // helper function for rebalancing the tree
-template<typename K, typename V>
-typename AVLCollection<K,V>::Node*
-AVLCollection<K,V>::rebalance(Node* subtree_root)
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::rebalance(Node* subtree_root)
 {
   if(!subtree_root) return subtree_root;  // special case if there is nothing in the tree
 
@@ -553,4 +730,182 @@ AVLCollection<K,V>::rebalance(Node* subtree_root)
   return subtree_root;
 }
 
-#endif
\ No newline at end of file
+// helper function for range remove
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::remove_range(Node* subtree_root, const K& k1, const K& k2)
+{
+  if(!subtree_root) return nullptr;
+  Node* l = subtree_root->left;
+  Node* r = subtree_root->right;
+  // subtree_root and its left subtree are below the range
+  if(compare(subtree_root->key, k1) < 0)
+    return join(l, subtree_root, remove_range(r, k1, k2));
+  // subtree_root and its right subtree are above the range
+  if(compare(subtree_root->key, k2) > 0)
+    return join(remove_range(l, k1, k2), subtree_root, r);
+  // subtree_root is in the range
+  delete subtree_root;
+  --node_count;
+  l = remove_range(l, k1, k2);
+  r = remove_range(r, k1, k2);
+  return join(l, r);
+}
+
+// helper function for range remove: join by height
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::join(Node* l, Node* m, Node* r)
+{
+  // attach m along the inner spine of the taller tree
+  if(height(l) > height(r) + 1){
+    l->right = join(l->right, m, r);
+    return join_balance(l);
+  }
+  if(height(r) > height(l) + 1){
+    r->left = join(l, m, r->left);
+    return join_balance(r);
+  }
+  m->left = l;
+  m->right = r;
+  update_height(m);
+  return m;
+}
+
+// helper function for range remove: join without a middle Node
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::join(Node* l, Node* r)
+{
+  if(!l) return r;
+  if(!r) return l;
+  // use the smallest key of r as the middle Node
+  Node* min = nullptr;
+  r = remove_min(r, min);
+  return join(l, min, r);
+}
+
+// helper function for join: detach the smallest Node
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::remove_min(Node* subtree_root, Node*& min)
+{
+  if(!subtree_root->left){
+    min = subtree_root;
+    return subtree_root->right;
+  }
+  subtree_root->left = remove_min(subtree_root->left, min);
+  return join_balance(subtree_root);
+}
+
+// helper function for join: single or double rotation at subtree_root
+template<typename K, typename V, typename C>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::join_balance(Node* subtree_root)
+{
+  Node* lptr = subtree_root->left;
+  Node* rptr = subtree_root->right;
+  if(height(lptr) > height(rptr) + 1){
+    // "left-right" case - rotate left at lptr first
+    if(height(lptr->right) > height(lptr->left)){
+      subtree_root->left = rotate_left(lptr);
+      update_height(lptr);
+      update_height(subtree_root->left);
+    }
+    subtree_root = rotate_right(subtree_root);
+    update_height(subtree_root->right);
+  }
+  else if(height(rptr) > height(lptr) + 1){
+    // "right-left" case - rotate right at rptr first
+    if(height(rptr->left) > height(rptr->right)){
+      subtree_root->right = rotate_right(rptr);
+      update_height(rptr);
+      update_height(subtree_root->right);
+    }
+    subtree_root = rotate_left(subtree_root);
+    update_height(subtree_root->left);
+  }
+  update_height(subtree_root);
+  return subtree_root;
+}
+
+// helper function for join
+template<typename K, typename V, typename C>
+int AVLCollection<K,V,C>::height(const Node* subtree_root)
+{
+  return subtree_root ? subtree_root->height : 0;
+}
+
+// helper function for join
+template<typename K, typename V, typename C>
+void AVLCollection<K,V,C>::update_height(Node* subtree_root)
+{
+  int lh = height(subtree_root->left);
+  int rh = height(subtree_root->right);
+  subtree_root->height = 1 + (lh > rh ? lh : rh);
+}
+
+// helper function for find and find_ptr
+template<typename K, typename V, typename C>
+template<typename Q>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::find_node(const Q& search_key) const
+{
+  Node* cur = root; // Node pointer to keep track of current location in the tree
+  while(cur){
+    int c = compare(search_key, cur->key);
+    if(c == 0) // search_key is found
+      return cur;
+    else if(c < 0) // key at cur is less than search_key
+      cur = cur->left;  // iterate through cur's left subtree
+    else  // key at cur is greater than search_key
+      cur = cur->right; // iterate through cur's right subtree
+  }
+  return nullptr; // return nullptr since you did not find search_key
+}
+
+// helper function for find_or_insert and insert_or_assign (one descent
+// finds the key or adds its Node)
+template<typename K, typename V, typename C>
+template<typename... Args>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::find_or_add(const K& key, bool& added, Args&&... args)
+{
+  Node* cur = nullptr;
+  added = false;
+  root = add(root, key, added, cur, std::forward<Args>(args)...);
+  if(added) ++node_count; // increment node_count
+  return cur;
+}
+
+// helper function for find_or_add (the path is only rebalanced if a
+// Node was added)
+template<typename K, typename V, typename C>
+template<typename... Args>
+typename AVLCollection<K,V,C>::Node*
+AVLCollection<K,V,C>::add(Node* subtree_root, const K& key, bool& added,
+                          Node*& found, Args&&... args)
+{
+  if(!subtree_root){
+    // the key is not in the tree, so its new Node becomes the subtree
+    found = new Node(key, std::forward<Args>(args)...);
+    added = true;
+    return found;
+  }
+  int c = compare(key, subtree_root->key);
+  if(c == 0){
+    found = subtree_root;
+    return subtree_root;
+  }
+  if(c < 0)
+    subtree_root->left = add(subtree_root->left, key, added, found,
+                             std::forward<Args>(args)...);
+  else
+    subtree_root->right = add(subtree_root->right, key, added, found,
+                              std::forward<Args>(args)...);
+  if(!added) return subtree_root;
+  update_height(subtree_root);
+  return rebalance(subtree_root); // calculate balance factors and rotate (if necessary)
+}
+
+#endif
@@ -9,6 +9,8 @@
 #ifndef BIN_SEARCH_COLLECTION_H
 #define BIN_SEARCH_COLLECTION_H
 
+#include <tuple>
+#include <utility>
 #include "collection.h"
 #include "array_list.h"
 
@@ -17,16 +19,32 @@ class BinSearchCollection : public Collection<K,V>
 {
   public:
   void add(const K& key, const V& val);
+  void add(K&& key, V&& val);
+  template<typename KK, typename... Args>
+  void emplace(KK&& key, Args&&... args);
   void remove(const K& key);
   bool find(const K& search_key, V& return_val) const;
+  V& find_or_insert(const K& key);
+  bool insert_or_assign(const K& key, const V& val);
+  V* find_ptr(const K& key);
+  const V* find_ptr(const K& key) const;
+  template<typename Q>
+  bool find(const Q& search_key, V& return_val) const; // any key-like type
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
   void keys(ArrayList<K>& all_keys) const;
   void sort(ArrayList<K>& all_keys_sorted) const;
   size_t size() const;
+  size_t memory_usage() const;
 
   private:
   ArrayList<std::pair<K,V>> kv_list;
-  bool binsearch(const K& key, size_t& index) const;
+  template<typename Q>
+  bool binsearch(const Q& key, size_t& index) const;
+  // moves a pair into its sorted location
+  void insert(std::pair<K,V>&& pair);
+  // moves a pair next to the index where binsearch stopped, returning
+  // its final index
+  size_t insert(size_t index, std::pair<K,V>&& pair);
 };
 
 //  Function: add()
@@ -36,17 +54,32 @@ class BinSearchCollection : public Collection<K,V>
 template<typename K, typename V>
 void BinSearchCollection<K,V>::add(const K& key, const V& val)
 {
-  size_t index;
-  binsearch(key,index); // find the correct index to add the new pair using binsearch
-  if(size() == 0) kv_list.add(std::pair<K,V>(key,val));
-  else{
-    std::pair<K,V> item;
-    kv_list.get(index,item);
-    if(item.first > key){
-      kv_list.add(index, std::pair<K,V>(key,val));  // add the new pair at the correct index
-    }
-    else kv_list.add(index+1,std::pair<K,V> (key,val));
-  }
+  insert(std::pair<K,V>(key,val));
+}
+
+//  Function: add()
+//  Description: Adds a new key-value pair to the collection in the correct
+//  sorted location, moving the key and value instead of copying them
+//  Inputs: Key and value to be added to the collection
+//  Outputs: None
+template<typename K, typename V>
+void BinSearchCollection<K,V>::add(K&& key, V&& val)
+{
+  insert(std::pair<K,V>(std::move(key),std::move(val)));
+}
+
+//  Function: emplace()
+//  Description: Adds a new key-value pair to the collection in the correct
+//  sorted location, building the key and value from the given arguments
+//  Inputs: Key (or argument for the key) and the arguments for the value
+//  Outputs: None
+template<typename K, typename V>
+template<typename KK, typename... Args>
+void BinSearchCollection<K,V>::emplace(KK&& key, Args&&... args)
+{
+  insert(std::pair<K,V>(std::piecewise_construct,
+                        std::forward_as_tuple(std::forward<KK>(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...)));
 }
 
 //  Function: remove()
@@ -70,17 +103,78 @@ void BinSearchCollection<K,V>::remove(const K& key)
 //  Outputs: Value associated with the key
 template<typename K, typename V>
 bool BinSearchCollection<K,V>::find(const K& search_key, V& return_val) const
+{
+  return find<K>(search_key, return_val);
+}
+
+//  Function: find()
+//  Description: Finds the value associated with a key-like search key (one
+//  that can be compared directly with the keys in the collection)
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key
+template<typename K, typename V>
+template<typename Q>
+bool BinSearchCollection<K,V>::find(const Q& search_key, V& return_val) const
 {
   size_t index;
   if(binsearch(search_key, index)){
-    std::pair<K,V> item;
-    kv_list.get(index, item); // get the item at the index of the desired key
-    return_val = item.second; // set the return value to the value at index
+    return_val = kv_list[index].second; // set the return value to the value at index
     return true;
   }
   return false;
 }
 
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value in its sorted location if it is not found
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V>
+V& BinSearchCollection<K,V>::find_or_insert(const K& key)
+{
+  size_t index;
+  if(!binsearch(key, index))
+    index = insert(index, std::pair<K,V>(key, V()));
+  return kv_list[index].second;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the collection
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V>
+bool BinSearchCollection<K,V>::insert_or_assign(const K& key, const V& val)
+{
+  size_t index;
+  if(binsearch(key, index)){
+    kv_list[index].second = val;
+    return false;
+  }
+  insert(index, std::pair<K,V>(key, val));
+  return true;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V>
+V* BinSearchCollection<K,V>::find_ptr(const K& key)
+{
+  size_t index;
+  if(binsearch(key, index)) return &kv_list[index].second;
+  return nullptr;
+}
+
+template<typename K, typename V>
+const V* BinSearchCollection<K,V>::find_ptr(const K& key) const
+{
+  size_t index;
+  if(binsearch(key, index)) return &kv_list[index].second;
+  return nullptr;
+}
+
 //  Function: find()
 //  Description: Finds and returns all keys between the given k1 and k2 keys
 //  Inputs: Given key "limits"
@@ -133,13 +227,25 @@ size_t BinSearchCollection<K,V>::size() const
   return kv_list.size();
 }
 
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection, including
+//  the unused capacity of the list
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V>
+size_t BinSearchCollection<K,V>::memory_usage() const
+{
+  return sizeof(*this) + kv_list.dynamic_memory();
+}
+
 //  Function: binsearch()
 //  Description: Binary searches the list for a specific key, returns true if it is present/
 //  false if not present
 //  Inputs: The key to search for
 //  Outputs: The index of the key to search for
 template<typename K, typename V>
-bool BinSearchCollection<K,V>::binsearch(const K& key, size_t& index) const
+template<typename Q>
+bool BinSearchCollection<K,V>::binsearch(const Q& key, size_t& index) const
 {
   if(size() > 0){
     size_t start = 0; // variable for the start of the section to be sorted
@@ -147,8 +253,7 @@ bool BinSearchCollection<K,V>::binsearch(const K& key, size_t& index) const
     size_t mid; // variable for the midpoint of the section to be sorted
     while(start <= end){
       mid = (end+start)/2; // calculate the midpoint for binary search 
-      std::pair<K,V> mid_pair;
-      kv_list.get(mid, mid_pair); // get the pair at the midpoint
+      const std::pair<K,V>& mid_pair = kv_list[mid]; // the pair at the midpoint
       if(key == mid_pair.first){  // if the key is equal to the key of the middle pair
         index = mid;  // you have found the index of the key
         return true;  // return true
@@ -174,4 +279,23 @@ bool BinSearchCollection<K,V>::binsearch(const K& key, size_t& index) const
   return false;
 }
 
+// helper function for add and emplace
+template<typename K, typename V>
+void BinSearchCollection<K,V>::insert(std::pair<K,V>&& pair)
+{
+  size_t index;
+  binsearch(pair.first,index); // find the correct index to add the new pair using binsearch
+  insert(index, std::move(pair));
+}
+
+// helper function for insert, find_or_insert, and insert_or_assign
+template<typename K, typename V>
+size_t BinSearchCollection<K,V>::insert(size_t index, std::pair<K,V>&& pair)
+{
+  if(size() == 0) index = 0;
+  else if(!(kv_list[index].first > pair.first)) ++index;
+  kv_list.add(index, std::move(pair));  // add the new pair at the correct index
+  return index;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,693 @@
+//----------------------------------------------------------------------
+// FILE: bplus_tree_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Implements a version of the collection class that implements a
+// B+ tree. Each node holds up to FANOUT - 1 keys in an array (so a
+// search touches a few cache lines per level instead of one node per
+// comparison), all pairs are stored in the leaves, and the leaves are
+// linked in key order so range finds and sort are sequential scans.
+//----------------------------------------------------------------------
+
+#ifndef BPLUS_TREE_COLLECTION_H
+#define BPLUS_TREE_COLLECTION_H
+
+#include <string>
+#include <iostream>
+#include <utility>
+#include "collection.h"
+#include "key_compare.h"
+#include "array_list.h"
+
+template<typename K, typename V, size_t FANOUT = 16,
+         typename Compare = ThreeWayCompare<K>>
+class BPlusTreeCollection : public Collection<K,V>
+{
+  static_assert(FANOUT >= 4, "B+ tree fanout must be at least 4");
+
+  public:
+    BPlusTreeCollection();
+    BPlusTreeCollection(const BPlusTreeCollection<K,V,FANOUT,Compare>& rhs);
+    ~BPlusTreeCollection();
+    BPlusTreeCollection& operator=(const BPlusTreeCollection<K,V,FANOUT,Compare>& rhs);
+
+    void add(const K& key, const V& val);
+    void remove(const K& key);
+    bool find(const K& search_key, V& return_val) const;
+    V& find_or_insert(const K& key);
+    bool insert_or_assign(const K& key, const V& val);
+    V* find_ptr(const K& key);
+    const V* find_ptr(const K& key) const;
+    void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+    void keys(ArrayList<K>& all_keys) const;
+    void sort(ArrayList<K>& all_keys_sorted) const;
+    size_t size() const;
+    size_t height() const;
+    size_t memory_usage() const;
+
+    // for testing: check the node sizes, key order, leaf depths and
+    // leaf links
+    bool valid_tree() const;
+    void print() const;
+
+  private:
+    static const size_t MAX_KEYS = FANOUT - 1;    // keys per node
+    static const size_t MIN_KEYS = MAX_KEYS / 2;  // keys per non-root node
+
+    // common node part (each array has one extra slot, so a node can
+    // overflow by one key before it is split)
+    struct Node {
+      bool leaf;
+      size_t count;  // number of keys
+      K keys[MAX_KEYS + 1];
+    };
+
+    // inner node: children[i] holds the keys >= keys[i-1] and < keys[i]
+    struct Inner : Node {
+      Node* children[MAX_KEYS + 2];
+    };
+
+    // leaf node: values[i] is the value of keys[i]
+    struct Leaf : Node {
+      V values[MAX_KEYS + 1];
+      Leaf* prev;
+      Leaf* next;
+    };
+
+    Node* root;
+    size_t length; // number of pairs in the collection
+
+    // three-way compare of two keys using the comparison policy
+    static int compare(const K& a, const K& b) {return Compare()(a, b);}
+
+    // search helpers: index of the child to follow, and of the first
+    // leaf key >= key
+    static size_t child_index(const Node* x, const K& key);
+    static size_t key_index(const Node* x, const K& key);
+
+    // find the leaf that does (or would) hold the key
+    const Leaf* find_leaf(const K& key) const;
+
+    // leftmost leaf (nullptr if empty)
+    const Leaf* first_leaf() const;
+
+    // helper for add and find_or_insert: stores val with the key (a
+    // key that is already there keeps its value if val is nullptr, and
+    // a new one gets a default value), growing the tree if the root
+    // splits; returns the key's value slot
+    V* find_or_add(const K& key, const V* val);
+
+    // add helper, sets split_node (and split_key) if x had to split;
+    // returns the key's value slot (in split_node if it moved there)
+    V* add(Node* x, const K& key, const V* val, K& split_key,
+           Node*& split_node);
+
+    // remove helper, returns true if a pair was removed
+    bool remove(Node* x, const K& key);
+
+    // refill p's i-th child after it dropped below MIN_KEYS
+    void rebalance(Inner* p, size_t i);
+
+    void make_empty(Node* x);  // deletes a subtree
+    size_t memory_usage(const Node* x) const;  // bytes of a subtree
+    Node* copy(const Node* x, Leaf*& prev_leaf);
+    bool valid_tree(const Node* x, size_t depth, size_t& leaf_depth,
+                    const K* lo, const K* hi) const;
+    void print_tree(std::string indent, const Node* x) const;
+};
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+BPlusTreeCollection<K,V,FANOUT,Compare>::BPlusTreeCollection()
+  : root(nullptr), length(0)
+{
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+BPlusTreeCollection<K,V,FANOUT,Compare>::BPlusTreeCollection(const BPlusTreeCollection<K,V,FANOUT,Compare>& rhs)
+  : root(nullptr), length(0)
+{
+  *this = rhs;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+BPlusTreeCollection<K,V,FANOUT,Compare>::~BPlusTreeCollection()
+{
+  make_empty(root);
+  root = nullptr;
+  length = 0;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+BPlusTreeCollection<K,V,FANOUT,Compare>&
+BPlusTreeCollection<K,V,FANOUT,Compare>::operator=(const BPlusTreeCollection<K,V,FANOUT,Compare>& rhs)
+{
+  if(this != &rhs){
+    make_empty(root);
+    Leaf* prev_leaf = nullptr;
+    root = rhs.root ? copy(rhs.root, prev_leaf) : nullptr;
+    length = rhs.length;
+  }
+  return *this;
+}
+
+// add the pair to its leaf, splitting full nodes on the way back up
+// (a key that is already there gets the new value)
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::add(const K& key, const V& val)
+{
+  find_or_add(key, &val);
+}
+
+// remove the pair from its leaf, borrowing from or merging with a
+// sibling whenever a node drops below half full
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::remove(const K& key)
+{
+  if(!root || !remove(root, key)) return;
+  // shrink the tree when the root runs out of keys
+  if(!root->leaf && root->count == 0){
+    Node* old_root = root;
+    root = static_cast<Inner*>(root)->children[0];
+    delete static_cast<Inner*>(old_root);
+  }
+  else if(root->leaf && root->count == 0){
+    delete static_cast<Leaf*>(root);
+    root = nullptr;
+  }
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+bool BPlusTreeCollection<K,V,FANOUT,Compare>::find(const K& search_key, V& return_val) const
+{
+  const Leaf* leaf = find_leaf(search_key);
+  if(!leaf) return false;
+  size_t i = key_index(leaf, search_key);
+  if(i == leaf->count || compare(search_key, leaf->keys[i]) < 0) return false;
+  return_val = leaf->values[i];
+  return true;
+}
+
+// one descent finds or adds the key (the reference is valid until the
+// next add or remove, since either may move pairs between leaves)
+template<typename K, typename V, size_t FANOUT, typename Compare>
+V& BPlusTreeCollection<K,V,FANOUT,Compare>::find_or_insert(const K& key)
+{
+  return *find_or_add(key, nullptr);
+}
+
+// add already replaces the value of an existing key
+template<typename K, typename V, size_t FANOUT, typename Compare>
+bool BPlusTreeCollection<K,V,FANOUT,Compare>::insert_or_assign(const K& key, const V& val)
+{
+  size_t old_length = length;
+  add(key, val);
+  return length != old_length;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+V* BPlusTreeCollection<K,V,FANOUT,Compare>::find_ptr(const K& key)
+{
+  const BPlusTreeCollection<K,V,FANOUT,Compare>* self = this;
+  return const_cast<V*>(self->find_ptr(key));
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+const V* BPlusTreeCollection<K,V,FANOUT,Compare>::find_ptr(const K& key) const
+{
+  const Leaf* leaf = find_leaf(key);
+  if(!leaf) return nullptr;
+  size_t i = key_index(leaf, key);
+  if(i == leaf->count || compare(key, leaf->keys[i]) < 0) return nullptr;
+  return &leaf->values[i];
+}
+
+// find the first leaf of the range, then follow the leaf links
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  const Leaf* leaf = find_leaf(k1);
+  if(!leaf) return;
+  size_t i = key_index(leaf, k1);
+  while(leaf){
+    for(; i < leaf->count; ++i){
+      if(compare(k2, leaf->keys[i]) < 0) return;
+      keys.add(leaf->keys[i]);
+    }
+    leaf = leaf->next;
+    i = 0;
+  }
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::keys(ArrayList<K>& all_keys) const
+{
+  for(const Leaf* leaf = first_leaf(); leaf; leaf = leaf->next)
+    for(size_t i = 0; i < leaf->count; ++i)
+      all_keys.add(leaf->keys[i]);
+}
+
+// the leaves are already in key order
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  keys(all_keys_sorted);
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::size() const
+{
+  return length;
+}
+
+// number of levels (every leaf is at the same depth)
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::height() const
+{
+  size_t h = 0;
+  for(const Node* x = root; x; ++h)
+    x = x->leaf ? nullptr : static_cast<const Inner*>(x)->children[0];
+  return h;
+}
+
+// bytes of the tree object and every node (nodes are allocated with
+// all of their key and value slots, used or not)
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::memory_usage() const
+{
+  return sizeof(*this) + memory_usage(root);
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+bool BPlusTreeCollection<K,V,FANOUT,Compare>::valid_tree() const
+{
+  if(!root) return length == 0;
+  size_t leaf_depth = 0;
+  if(!valid_tree(root, 1, leaf_depth, nullptr, nullptr)) return false;
+  // the leaf links visit every pair in ascending order
+  size_t n = 0;
+  const Leaf* prev = nullptr;
+  for(const Leaf* leaf = first_leaf(); leaf; leaf = leaf->next){
+    if(leaf->prev != prev) return false;
+    if(prev && compare(prev->keys[prev->count - 1], leaf->keys[0]) >= 0) return false;
+    n += leaf->count;
+    prev = leaf;
+  }
+  return n == length;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::print() const
+{
+  print_tree("", root);
+}
+
+// binary search for the number of keys <= key
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::child_index(const Node* x, const K& key)
+{
+  size_t lo = 0, hi = x->count;
+  while(lo < hi){
+    size_t mid = (lo + hi) / 2;
+    if(compare(key, x->keys[mid]) < 0) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
+}
+
+// binary search for the number of keys < key
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::key_index(const Node* x, const K& key)
+{
+  size_t lo = 0, hi = x->count;
+  while(lo < hi){
+    size_t mid = (lo + hi) / 2;
+    if(compare(x->keys[mid], key) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+const typename BPlusTreeCollection<K,V,FANOUT,Compare>::Leaf*
+BPlusTreeCollection<K,V,FANOUT,Compare>::find_leaf(const K& key) const
+{
+  const Node* x = root;
+  if(!x) return nullptr;
+  while(!x->leaf){
+    const Inner* inner = static_cast<const Inner*>(x);
+    x = inner->children[child_index(inner, key)];
+  }
+  return static_cast<const Leaf*>(x);
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+const typename BPlusTreeCollection<K,V,FANOUT,Compare>::Leaf*
+BPlusTreeCollection<K,V,FANOUT,Compare>::first_leaf() const
+{
+  const Node* x = root;
+  if(!x) return nullptr;
+  while(!x->leaf)
+    x = static_cast<const Inner*>(x)->children[0];
+  return static_cast<const Leaf*>(x);
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+V* BPlusTreeCollection<K,V,FANOUT,Compare>::find_or_add(const K& key, const V* val)
+{
+  if(!root){
+    Leaf* leaf = new Leaf;
+    leaf->leaf = true;
+    leaf->count = 0;
+    leaf->prev = nullptr;
+    leaf->next = nullptr;
+    root = leaf;
+  }
+  K split_key;
+  Node* split_node = nullptr;
+  V* slot = add(root, key, val, split_key, split_node);
+  // the root split, so the tree grows a level
+  if(split_node){
+    Inner* new_root = new Inner;
+    new_root->leaf = false;
+    new_root->count = 1;
+    new_root->keys[0] = split_key;
+    new_root->children[0] = root;
+    new_root->children[1] = split_node;
+    root = new_root;
+  }
+  return slot;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+V* BPlusTreeCollection<K,V,FANOUT,Compare>::add(Node* x, const K& key, const V* val,
+                                                K& split_key, Node*& split_node)
+{
+  split_node = nullptr;
+  if(x->leaf){
+    Leaf* leaf = static_cast<Leaf*>(x);
+    size_t i = key_index(leaf, key);
+    if(i < leaf->count && compare(key, leaf->keys[i]) == 0){
+      if(val) leaf->values[i] = *val;
+      return &leaf->values[i];
+    }
+    // shift the larger pairs over to make room
+    for(size_t j = leaf->count; j > i; --j){
+      leaf->keys[j] = std::move(leaf->keys[j-1]);
+      leaf->values[j] = std::move(leaf->values[j-1]);
+    }
+    leaf->keys[i] = key;
+    leaf->values[i] = val ? *val : V();
+    leaf->count++;
+    length++;
+    if(leaf->count <= MAX_KEYS) return &leaf->values[i];
+    // split the upper half into a new leaf (its first key separates them)
+    Leaf* right = new Leaf;
+    right->leaf = true;
+    size_t mid = leaf->count / 2;
+    right->count = leaf->count - mid;
+    for(size_t j = 0; j < right->count; ++j){
+      right->keys[j] = std::move(leaf->keys[mid + j]);
+      right->values[j] = std::move(leaf->values[mid + j]);
+    }
+    leaf->count = mid;
+    right->next = leaf->next;
+    right->prev = leaf;
+    if(leaf->next) leaf->next->prev = right;
+    leaf->next = right;
+    split_key = right->keys[0];
+    split_node = right;
+    return i < mid ? &leaf->values[i] : &right->values[i - mid];
+  }
+  Inner* inner = static_cast<Inner*>(x);
+  size_t i = child_index(inner, key);
+  K child_key;
+  Node* child_split = nullptr;
+  V* slot = add(inner->children[i], key, val, child_key, child_split);
+  if(!child_split) return slot;
+  // add the new child (and its separator) after child i
+  for(size_t j = inner->count; j > i; --j){
+    inner->keys[j] = std::move(inner->keys[j-1]);
+    inner->children[j+1] = inner->children[j];
+  }
+  inner->keys[i] = child_key;
+  inner->children[i+1] = child_split;
+  inner->count++;
+  if(inner->count <= MAX_KEYS) return slot;
+  // split, moving the middle key up to the parent
+  Inner* right = new Inner;
+  right->leaf = false;
+  size_t mid = inner->count / 2;
+  right->count = inner->count - mid - 1;
+  for(size_t j = 0; j < right->count; ++j)
+    right->keys[j] = std::move(inner->keys[mid + 1 + j]);
+  for(size_t j = 0; j <= right->count; ++j)
+    right->children[j] = inner->children[mid + 1 + j];
+  split_key = std::move(inner->keys[mid]);
+  inner->count = mid;
+  split_node = right;
+  return slot;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+bool BPlusTreeCollection<K,V,FANOUT,Compare>::remove(Node* x, const K& key)
+{
+  if(x->leaf){
+    Leaf* leaf = static_cast<Leaf*>(x);
+    size_t i = key_index(leaf, key);
+    if(i == leaf->count || compare(key, leaf->keys[i]) < 0) return false;
+    for(size_t j = i; j + 1 < leaf->count; ++j){
+      leaf->keys[j] = std::move(leaf->keys[j+1]);
+      leaf->values[j] = std::move(leaf->values[j+1]);
+    }
+    leaf->count--;
+    // release whatever the vacated slot still holds
+    leaf->keys[leaf->count] = K();
+    leaf->values[leaf->count] = V();
+    length--;
+    return true;
+  }
+  Inner* inner = static_cast<Inner*>(x);
+  size_t i = child_index(inner, key);
+  if(!remove(inner->children[i], key)) return false;
+  if(inner->children[i]->count < MIN_KEYS) rebalance(inner, i);
+  return true;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::rebalance(Inner* p, size_t i)
+{
+  Node* x = p->children[i];
+  Node* left = i > 0 ? p->children[i-1] : nullptr;
+  Node* right = i < p->count ? p->children[i+1] : nullptr;
+
+  if(x->leaf){
+    Leaf* leaf = static_cast<Leaf*>(x);
+    Leaf* l = static_cast<Leaf*>(left);
+    Leaf* r = static_cast<Leaf*>(right);
+    // borrow the largest pair of the left sibling
+    if(l && l->count > MIN_KEYS){
+      for(size_t j = leaf->count; j > 0; --j){
+        leaf->keys[j] = std::move(leaf->keys[j-1]);
+        leaf->values[j] = std::move(leaf->values[j-1]);
+      }
+      leaf->keys[0] = std::move(l->keys[l->count - 1]);
+      leaf->values[0] = std::move(l->values[l->count - 1]);
+      leaf->count++;
+      l->count--;
+      l->keys[l->count] = K();
+      l->values[l->count] = V();
+      p->keys[i-1] = leaf->keys[0];
+      return;
+    }
+    // borrow the smallest pair of the right sibling
+    if(r && r->count > MIN_KEYS){
+      leaf->keys[leaf->count] = std::move(r->keys[0]);
+      leaf->values[leaf->count] = std::move(r->values[0]);
+      leaf->count++;
+      for(size_t j = 0; j + 1 < r->count; ++j){
+        r->keys[j] = std::move(r->keys[j+1]);
+        r->values[j] = std::move(r->values[j+1]);
+      }
+      r->count--;
+      r->keys[r->count] = K();
+      r->values[r->count] = V();
+      p->keys[i] = r->keys[0];
+      return;
+    }
+    // merge with a sibling (the right one of the two is dropped)
+    if(l){
+      leaf = l;
+      r = static_cast<Leaf*>(x);
+      --i;
+    }
+    for(size_t j = 0; j < r->count; ++j){
+      leaf->keys[leaf->count + j] = std::move(r->keys[j]);
+      leaf->values[leaf->count + j] = std::move(r->values[j]);
+    }
+    leaf->count += r->count;
+    leaf->next = r->next;
+    if(r->next) r->next->prev = leaf;
+    delete r;
+  }
+  else{
+    Inner* inner = static_cast<Inner*>(x);
+    Inner* l = static_cast<Inner*>(left);
+    Inner* r = static_cast<Inner*>(right);
+    // rotate a key down from the parent and one up from the left sibling
+    if(l && l->count > MIN_KEYS){
+      for(size_t j = inner->count; j > 0; --j)
+        inner->keys[j] = std::move(inner->keys[j-1]);
+      for(size_t j = inner->count + 1; j > 0; --j)
+        inner->children[j] = inner->children[j-1];
+      inner->keys[0] = std::move(p->keys[i-1]);
+      inner->children[0] = l->children[l->count];
+      inner->count++;
+      p->keys[i-1] = std::move(l->keys[l->count - 1]);
+      l->count--;
+      l->keys[l->count] = K();
+      return;
+    }
+    // same, from the right sibling
+    if(r && r->count > MIN_KEYS){
+      inner->keys[inner->count] = std::move(p->keys[i]);
+      inner->children[inner->count + 1] = r->children[0];
+      inner->count++;
+      p->keys[i] = std::move(r->keys[0]);
+      for(size_t j = 0; j + 1 < r->count; ++j)
+        r->keys[j] = std::move(r->keys[j+1]);
+      for(size_t j = 0; j < r->count; ++j)
+        r->children[j] = r->children[j+1];
+      r->count--;
+      r->keys[r->count] = K();
+      return;
+    }
+    // merge with a sibling, pulling the separator down between them
+    if(l){
+      inner = l;
+      r = static_cast<Inner*>(x);
+      --i;
+    }
+    inner->keys[inner->count] = std::move(p->keys[i]);
+    for(size_t j = 0; j < r->count; ++j)
+      inner->keys[inner->count + 1 + j] = std::move(r->keys[j]);
+    for(size_t j = 0; j <= r->count; ++j)
+      inner->children[inner->count + 1 + j] = r->children[j];
+    inner->count += r->count + 1;
+    delete r;
+  }
+  // drop the separator and pointer of the merged-away child (i + 1)
+  for(size_t j = i; j + 1 < p->count; ++j){
+    p->keys[j] = std::move(p->keys[j+1]);
+    p->children[j+1] = p->children[j+2];
+  }
+  p->count--;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::make_empty(Node* x)
+{
+  if(!x) return;
+  if(x->leaf){
+    delete static_cast<Leaf*>(x);
+  }
+  else{
+    Inner* inner = static_cast<Inner*>(x);
+    for(size_t i = 0; i <= inner->count; ++i)
+      make_empty(inner->children[i]);
+    delete inner;
+  }
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+size_t BPlusTreeCollection<K,V,FANOUT,Compare>::memory_usage(const Node* x) const
+{
+  if(!x) return 0;
+  size_t bytes = 0;
+  for(size_t i = 0; i <= MAX_KEYS; ++i)
+    bytes += DynamicMemory<K>::bytes(x->keys[i]);
+  if(x->leaf){
+    const Leaf* leaf = static_cast<const Leaf*>(x);
+    for(size_t i = 0; i <= MAX_KEYS; ++i)
+      bytes += DynamicMemory<V>::bytes(leaf->values[i]);
+    return bytes + sizeof(Leaf);
+  }
+  const Inner* inner = static_cast<const Inner*>(x);
+  for(size_t i = 0; i <= inner->count; ++i)
+    bytes += memory_usage(inner->children[i]);
+  return bytes + sizeof(Inner);
+}
+
+// copy a subtree, linking each copied leaf after prev_leaf
+template<typename K, typename V, size_t FANOUT, typename Compare>
+typename BPlusTreeCollection<K,V,FANOUT,Compare>::Node*
+BPlusTreeCollection<K,V,FANOUT,Compare>::copy(const Node* x, Leaf*& prev_leaf)
+{
+  if(x->leaf){
+    const Leaf* rhs = static_cast<const Leaf*>(x);
+    Leaf* leaf = new Leaf;
+    leaf->leaf = true;
+    leaf->count = rhs->count;
+    for(size_t i = 0; i < rhs->count; ++i){
+      leaf->keys[i] = rhs->keys[i];
+      leaf->values[i] = rhs->values[i];
+    }
+    leaf->prev = prev_leaf;
+    leaf->next = nullptr;
+    if(prev_leaf) prev_leaf->next = leaf;
+    prev_leaf = leaf;
+    return leaf;
+  }
+  const Inner* rhs = static_cast<const Inner*>(x);
+  Inner* inner = new Inner;
+  inner->leaf = false;
+  inner->count = rhs->count;
+  for(size_t i = 0; i < rhs->count; ++i)
+    inner->keys[i] = rhs->keys[i];
+  for(size_t i = 0; i <= rhs->count; ++i)
+    inner->children[i] = copy(rhs->children[i], prev_leaf);
+  return inner;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+bool BPlusTreeCollection<K,V,FANOUT,Compare>::valid_tree(const Node* x, size_t depth,
+                                                         size_t& leaf_depth,
+                                                         const K* lo, const K* hi) const
+{
+  // every node but the root is at least half full
+  if(x->count > MAX_KEYS || (x != root && x->count < MIN_KEYS)) return false;
+  // keys are ascending and within the parent's separators
+  for(size_t i = 0; i < x->count; ++i){
+    if(i > 0 && compare(x->keys[i-1], x->keys[i]) >= 0) return false;
+    if(lo && compare(x->keys[i], *lo) < 0) return false;
+    if(hi && compare(x->keys[i], *hi) >= 0) return false;
+  }
+  if(x->leaf){
+    if(leaf_depth == 0) leaf_depth = depth;
+    return depth == leaf_depth;
+  }
+  const Inner* inner = static_cast<const Inner*>(x);
+  for(size_t i = 0; i <= inner->count; ++i){
+    const K* child_lo = i > 0 ? &inner->keys[i-1] : lo;
+    const K* child_hi = i < inner->count ? &inner->keys[i] : hi;
+    if(!valid_tree(inner->children[i], depth + 1, leaf_depth, child_lo, child_hi))
+      return false;
+  }
+  return true;
+}
+
+template<typename K, typename V, size_t FANOUT, typename Compare>
+void BPlusTreeCollection<K,V,FANOUT,Compare>::print_tree(std::string indent, const Node* x) const
+{
+  if(!x) return;
+  std::cout << indent << "[";
+  for(size_t i = 0; i < x->count; ++i)
+    std::cout << (i ? " " : "") << x->keys[i];
+  std::cout << "]" << std::endl;
+  if(!x->leaf){
+    const Inner* inner = static_cast<const Inner*>(x);
+    for(size_t i = 0; i <= inner->count; ++i)
+      print_tree(indent + "  ", inner->children[i]);
+  }
+}
+
+#endif
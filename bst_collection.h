@@ -9,26 +9,38 @@
 #ifndef BST_COLLECTION_H
 #define BST_COLLECTION_H
 
+#include <utility>
 #include "collection.h"
+#include "key_compare.h"
 #include "array_list.h"
 
-template<typename K, typename V>
+template<typename K, typename V, typename Compare = ThreeWayCompare<K>>
 class BSTCollection : public Collection<K,V>
 {
   public:
     BSTCollection();
-    BSTCollection(const BSTCollection<K,V>& rhs);
+    BSTCollection(const BSTCollection<K,V,Compare>& rhs);
+    BSTCollection(BSTCollection<K,V,Compare>&& rhs);
     ~BSTCollection();
-    BSTCollection& operator=(const BSTCollection<K,V>& rhs);
+    BSTCollection& operator=(const BSTCollection<K,V,Compare>& rhs);
+    BSTCollection& operator=(BSTCollection<K,V,Compare>&& rhs);
 
     void add(const K& key, const V& val);
+    void add(K&& key, V&& val);
+    template<typename KK, typename... Args>
+    void emplace(KK&& key, Args&&... args);
     void remove(const K& key);
     bool find(const K& search_key, V& return_val) const;
+    V& find_or_insert(const K& key);
+    bool insert_or_assign(const K& key, const V& val);
+    V* find_ptr(const K& key);
+    const V* find_ptr(const K& key) const;
     void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
     void keys(ArrayList<K>& all_keys) const;
     void sort(ArrayList<K>& all_keys_sorted) const;
     size_t size() const;
     size_t height() const;
+    size_t memory_usage() const;
 
   private:
     struct Node{
@@ -36,12 +48,29 @@ class BSTCollection : public Collection<K,V>
       V value;
       Node* left;
       Node* right;
+
+      Node() {}
+      // builds the key and value in place for a new leaf
+      template<typename KK, typename... Args>
+      Node(KK&& k, Args&&... args)
+        : key(std::forward<KK>(k)), value(std::forward<Args>(args)...),
+          left(nullptr), right(nullptr) {}
     };
 
     Node* root; // root of the tree
     size_t node_count;  // number of Nodes in the tree
 
-    // helper functions
+    // three-way compare of two keys using the comparison policy
+    template<typename A, typename B>
+    static int compare(const A& a, const B& b) {return Compare()(a, b);}
+
+    // helper functions (all iterative, so a degenerate tree, e.g. from
+    // adding keys in sorted order, can't overflow the call stack)
+    // for find and find_ptr
+    Node* find_node(const K& search_key) const;
+    // for find_or_insert and insert_or_assign
+    template<typename... Args>
+    Node* find_or_add(const K& key, bool& added, Args&&... args);
     // for destructor
     void make_empty(Node* subtree_root);
     // for copy constructor
@@ -52,45 +81,56 @@ class BSTCollection : public Collection<K,V>
     void find(const Node* subtree_root, const K& k1, const K& k2, ArrayList<K>& keys) const;
     // for keys
     void keys(const Node* subtree_root, ArrayList<K>& keys) const;
+    // for memory_usage
+    size_t dynamic_memory(const Node* subtree_root) const;
     // for height
     size_t height(const Node* subtree_root) const;
+    // for keys and memory_usage: calls visit(node) for each Node in
+    // order, using a heap-allocated stack of the pending ancestors
+    template<typename F>
+    void in_order(const Node* subtree_root, F visit) const;
 };
 
-template<typename K, typename V>
-BSTCollection<K,V>::BSTCollection()
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>::BSTCollection()
   : node_count(0)
 {
   root = nullptr;
 }
 
-template<typename K, typename V>
-BSTCollection<K,V>::BSTCollection(const BSTCollection<K,V>& rhs)
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>::BSTCollection(const BSTCollection<K,V,C>& rhs)
   : node_count(0), root(nullptr)
 {
   // defer to the assignment operator
   *this = rhs;
 }
 
-template<typename K, typename V>
-BSTCollection<K,V>::~BSTCollection()
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>::BSTCollection(BSTCollection<K,V,C>&& rhs)
+  : root(rhs.root), node_count(rhs.node_count)
+{
+  // take the rhs tree, leaving rhs empty
+  rhs.root = nullptr;
+  rhs.node_count = 0;
+}
+
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>::~BSTCollection()
 {
   make_empty(root);
   root = nullptr;
 }
 
-template<typename K, typename V>
-BSTCollection<K,V>& BSTCollection<K,V>::operator=(const BSTCollection<K,V>& rhs)
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>& BSTCollection<K,V,C>::operator=(const BSTCollection<K,V,C>& rhs)
 {
   if(this != &rhs){
     make_empty(root); // delete the lhs tree
     root = nullptr;
-    root = new Node;
     if(rhs.root){
       // copy rhs root into lhs root
-      root->key = rhs.root->key;
-      root->value = rhs.root->value;
-      root->left = nullptr;
-      root->right = nullptr;
+      root = new Node(rhs.root->key, rhs.root->value);
       node_count++; // increment node_count variable
       copy(root, rhs.root); // copy the rhs tree into the lhs tree
     }
@@ -98,19 +138,52 @@ BSTCollection<K,V>& BSTCollection<K,V>::operator=(const BSTCollection<K,V>& rhs)
   return *this;
 }
 
+template<typename K, typename V, typename C>
+BSTCollection<K,V,C>& BSTCollection<K,V,C>::operator=(BSTCollection<K,V,C>&& rhs)
+{
+  if(this != &rhs){
+    make_empty(root); // delete the lhs tree
+    // take the rhs tree, leaving rhs empty
+    root = rhs.root;
+    node_count = rhs.node_count;
+    rhs.root = nullptr;
+    rhs.node_count = 0;
+  }
+  return *this;
+}
+
 //  Function: add()
 //  Description: Adds a new key-value pair to the tree in the correct hashed location
 //  Inputs: Key and value to be added to the tree
 //  Outputs: None
-template<typename K, typename V>
-void BSTCollection<K,V>::add(const K& key, const V& val)
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::add(const K& key, const V& val)
+{
+  emplace(key, val);
+}
+
+//  Function: add()
+//  Description: Adds a new key-value pair to the tree, moving the key and
+//  value into the new Node instead of copying them
+//  Inputs: Key and value to be added to the tree
+//  Outputs: None
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::add(K&& key, V&& val)
+{
+  emplace(std::move(key), std::move(val));
+}
+
+//  Function: emplace()
+//  Description: Adds a new key-value pair to the tree, building the key
+//  and value in place inside the new Node
+//  Inputs: Key (or argument for the key) and the arguments for the value
+//  Outputs: None
+template<typename K, typename V, typename C>
+template<typename KK, typename... Args>
+void BSTCollection<K,V,C>::emplace(KK&& key, Args&&... args)
 {
   // create a new Node to hold key and val
-  Node* tmp = new Node;
-  tmp->left = nullptr;
-  tmp->right = nullptr;
-  tmp->key = key;
-  tmp->value = val;
+  Node* tmp = new Node(std::forward<KK>(key), std::forward<Args>(args)...);
 
   // special case if there is nothing in the tree
   if(node_count == 0){
@@ -121,7 +194,7 @@ void BSTCollection<K,V>::add(const K& key, const V& val)
     Node* cur = root; // Node pointer to keep track of current location in the tree
     Node* prev; // Node pointer to keep track of Node before cur
     while(cur){
-      if(key <= cur->key){ // key at cur is less than the key to be added
+      if(compare(tmp->key, cur->key) <= 0){ // key at cur is less than the key to be added
         prev = cur; // set the previous Node pointer to cur
         cur = cur->left;  // iterate through cur's left subtree
       }
@@ -132,7 +205,7 @@ void BSTCollection<K,V>::add(const K& key, const V& val)
     }
 
     //insert key and val
-    if(tmp->key <= prev->key)  // key is less than or equal to the key at cur
+    if(compare(tmp->key, prev->key) <= 0)  // key is less than or equal to the key at cur
       prev->left = tmp;  // add the new Node to the left of cur
     else  // key is greater than the key at cur
       prev->right = tmp; // add the new Node to the right of cur
@@ -144,8 +217,8 @@ void BSTCollection<K,V>::add(const K& key, const V& val)
 //  Description: Removes the requested key-value pair from the tree
 //  Inputs: The key of the pair to be removed
 //  Outputs: None
-template<typename K, typename V>
-void BSTCollection<K,V>::remove(const K& key)
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::remove(const K& key)
 {
   if(size() > 0)
   root = remove(root, key);
@@ -155,32 +228,65 @@ void BSTCollection<K,V>::remove(const K& key)
 //  Description: Finds the value associated with the given key, if it exists in the tree
 //  Inputs: Key to be found
 //  Outputs: Value associated with the key, whether or not the pair exists in the tree
-template<typename K, typename V>
-bool BSTCollection<K,V>::find(const K& search_key, V& return_val) const
+template<typename K, typename V, typename C>
+bool BSTCollection<K,V,C>::find(const K& search_key, V& return_val) const
 {
-  // special case if the tree is empty
-  if(node_count == 0) return false;
+  Node* cur = find_node(search_key);
+  if(!cur) return false;
+  return_val = cur->value;  // return the value at cur
+  return true;  // return true since you found search_key
+}
 
-  Node* cur = root; // Node pointer to keep track of current location in the tree
-  while(cur){
-    if(search_key == cur->key){ // search_key is found
-      return_val = cur->value;  // return the value at cur
-      return true;  // return true since you found search_key
-    }
-    else if(search_key < cur->key) // key at cur is less than search_key
-      cur = cur->left;  // iterate through cur's left subtree
-    else  // key at cur is greater than search_key
-      cur = cur->right; // iterate through cur's right subtree
-  }
-  return false; // return false since you did not find search_key
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value if it is not in the tree
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename C>
+V& BSTCollection<K,V,C>::find_or_insert(const K& key)
+{
+  bool added;
+  return find_or_add(key, added)->value;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the tree
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename C>
+bool BSTCollection<K,V,C>::insert_or_assign(const K& key, const V& val)
+{
+  bool added;
+  Node* cur = find_or_add(key, added, val);
+  if(!added) cur->value = val;
+  return added;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V, typename C>
+V* BSTCollection<K,V,C>::find_ptr(const K& key)
+{
+  Node* cur = find_node(key);
+  return cur ? &cur->value : nullptr;
+}
+
+template<typename K, typename V, typename C>
+const V* BSTCollection<K,V,C>::find_ptr(const K& key) const
+{
+  Node* cur = find_node(key);
+  return cur ? &cur->value : nullptr;
 }
 
 //  Function: find()
 //  Description: Finds and returns all keys between the given k1 and k2 keys
 //  Inputs: Given key "limits"
 //  Outputs: All keys between the given "limits"
-template<typename K, typename V>
-void BSTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
 {
   find(root, k1, k2, keys);
 }
@@ -189,8 +295,8 @@ void BSTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) cons
 //  Description: Returns a list of all the keys in the tree (using in-order traversal)
 //  Inputs: None
 //  Outputs: List of all keys in the collection
-template<typename K, typename V>
-void BSTCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::keys(ArrayList<K>& all_keys) const
 {
   keys(root, all_keys);
 }
@@ -199,8 +305,8 @@ void BSTCollection<K,V>::keys(ArrayList<K>& all_keys) const
 //  Description: Returns a list of all the keys in sorted order
 //  Inputs: None
 //  Outputs: A list of the keys in the system in sorted order
-template<typename K, typename V>
-void BSTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::sort(ArrayList<K>& all_keys_sorted) const
 {
   keys(all_keys_sorted);
 }
@@ -209,211 +315,265 @@ void BSTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
 //  Description: Returns the number of key-value pairs of the tree
 //  Inputs: None
 //  Outputs: The number of key-value pairs in the tree
-template<typename K, typename V>
-size_t BSTCollection<K,V>::size() const
+template<typename K, typename V, typename C>
+size_t BSTCollection<K,V,C>::size() const
 {
   return node_count;
 }
 
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the tree object, its nodes,
+//  and the keys' and values' dynamic memory
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename C>
+size_t BSTCollection<K,V,C>::memory_usage() const
+{
+  return sizeof(*this) + node_count * sizeof(Node) + dynamic_memory(root);
+}
+
 //  Function: height()
 //  Description: Returns the height of the tree
 //  Inputs: None
 //  Outputs: The height of the tree (counting of nodes)
-template<typename K, typename V>
-size_t BSTCollection<K,V>::height() const
+template<typename K, typename V, typename C>
+size_t BSTCollection<K,V,C>::height() const
 {
   return height(root);
 }
 
 // helper function for destructor
-template<typename K, typename V>
-void BSTCollection<K,V>::make_empty(Node* subtree_root)
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::make_empty(Node* subtree_root)
 {
-  // if the subtree root is null, return (base case)
-  if(!subtree_root){
-    return;
-  }
-  // delete the left and right subtrees of the current node
-  if(subtree_root->left){
-    make_empty(subtree_root->left);
-    subtree_root->left = nullptr;
-  }
-  if(subtree_root->right){
-    make_empty(subtree_root->right);
-    subtree_root->right = nullptr;
+  while(subtree_root){
+    if(subtree_root->left){
+      // rotate right, so the left child moves up (the tree ends up as a
+      // right-going list without any extra storage)
+      Node* tmp = subtree_root->left;
+      subtree_root->left = tmp->right;
+      tmp->right = subtree_root;
+      subtree_root = tmp;
+    }
+    else{
+      // no left subtree, so delete the current node and move right
+      Node* tmp = subtree_root->right;
+      delete subtree_root;
+      node_count--;
+      subtree_root = tmp;
+    }
   }
-  // delete the current node
-  delete subtree_root;
-  node_count--;
 }
 
 // helper function for copy constructor
-template<typename K, typename V>
-void BSTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
 {
   // base case (if the root is nullptr)
   if(!rhs_subtree_root) return;
-  // copy left subtree over if it exists
-  if(rhs_subtree_root->left){
-    // new Node to copy to left subtree of lhs_subtree_root
-    Node* tmp = new Node;
-    tmp->key = rhs_subtree_root->left->key;
-    tmp->value = rhs_subtree_root->left->value;
-    tmp->left = nullptr;
-    tmp->right = nullptr;
-
-    // add new Node to the left subtree of lhs_subtree_root
-    lhs_subtree_root->left = tmp;
-    node_count++; // increment node_count variable
-
-    // copy the rest of the left subtree of rhs_subtree_root
-    copy(lhs_subtree_root->left, rhs_subtree_root->left);
-  }
-
-  // copy right subtree over if it exists
-  if(rhs_subtree_root->right){
-    // new Node to copy to right subtree of lhs_subtree_root
-    Node* tmp = new Node;
-    tmp->key = rhs_subtree_root->right->key;
-    tmp->value = rhs_subtree_root->right->value;
-    tmp->left = nullptr;
-    tmp->right = nullptr;
-
-    // add new Node to the right subtree of lhs_subtree_root
-    lhs_subtree_root->right = tmp;
-    node_count++; // increment node_count variable
-
-    // copy the rest of the right subtree of rhs_subtree_root
-    copy(lhs_subtree_root->right, rhs_subtree_root->right);
+  // pairs of lhs Nodes whose children still need copying and the rhs
+  // Nodes they copy
+  ArrayList<std::pair<Node*,const Node*>> pending;
+  pending.add(std::pair<Node*,const Node*>(lhs_subtree_root, rhs_subtree_root));
+  while(pending.size() > 0){
+    std::pair<Node*,const Node*> cur = pending[pending.size() - 1];
+    pending.remove(pending.size() - 1);
+    // copy left subtree over if it exists
+    if(cur.second->left){
+      cur.first->left = new Node(cur.second->left->key, cur.second->left->value);
+      node_count++; // increment node_count variable
+      pending.add(std::pair<Node*,const Node*>(cur.first->left, cur.second->left));
+    }
+    // copy right subtree over if it exists
+    if(cur.second->right){
+      cur.first->right = new Node(cur.second->right->key, cur.second->right->value);
+      node_count++; // increment node_count variable
+      pending.add(std::pair<Node*,const Node*>(cur.first->right, cur.second->right));
+    }
   }
 }
 
 // helper function for remove
-template<typename K, typename V>
-typename BSTCollection<K,V>::Node*
-BSTCollection<K,V>::remove(Node* subtree_root, const K& key)
-{
-  // traverse the left subtree if the key is less than the key of subtree_root
-  if(subtree_root && key < subtree_root->key)
-    subtree_root->left = remove(subtree_root->left, key);
- 
-  // traverse the right subtree if the key is greater than the key of subtree_root
-  else if(subtree_root && key > subtree_root->key)
-    subtree_root->right = remove(subtree_root->right, key);
-  
-  // remove subtree_root (since you have found the Node containing key)
-  else if(subtree_root){
-    // case 1 - 0 or 1 child
-    if(!subtree_root->left || !subtree_root->right){
-      if(subtree_root->left){
-        Node* tmp = subtree_root->left;
-        delete subtree_root;
-        // replace subtree_root with subtree_root's left subtree
-        subtree_root = tmp;
-      }
-      else{
-        Node* tmp = subtree_root->right;
-        delete subtree_root;
-        // replace subtree_root with subtree_root's right subtree
-        subtree_root = tmp;
-      }
-    }
-
-    // case 2 - 2 children
-    else{
-      // finding in order successor
-      Node* successor = subtree_root;
-      Node* prev = successor;
-      successor = subtree_root->right;
-      // normal case
-      if(successor->left){
-        while(successor->left){
-          prev = successor;
-          successor = successor->left;
-        }
-
-        // copying successor's key and value into subtree_root
-        subtree_root->key = successor->key;
-        subtree_root->value = successor->value;
-
-        // delete successor
-        prev->left = successor->right; // point prev to successor's right subtree
-        delete successor;
-      }
-      // special case (if subtree_root's right subtree contains only one Node)
-      else{
-        // in order successor is the only Node in the right subtree
-        subtree_root->right = successor->right;
+template<typename K, typename V, typename C>
+typename BSTCollection<K,V,C>::Node*
+BSTCollection<K,V,C>::remove(Node* subtree_root, const K& key)
+{
+  // find the link (the parent's child pointer) to the Node with key
+  Node** link = &subtree_root;
+  while(*link){
+    int c = compare(key, (*link)->key);
+    if(c < 0)
+      link = &(*link)->left;  // traverse the left subtree
+    else if(c > 0)
+      link = &(*link)->right; // traverse the right subtree
+    else
+      break;
+  }
+  Node* x = *link;
+  if(!x) return subtree_root;  // key not found
 
-        // copying successor's key and value into subtree_root
-        subtree_root->key = successor->key;
-        subtree_root->value = successor->value;
+  // case 1 - 0 or 1 child: replace x with its only subtree
+  if(!x->left || !x->right){
+    *link = x->left ? x->left : x->right;
+    delete x;
+  }
 
-        // redirect and delete subtree_root
-        delete successor;
-      }
+  // case 2 - 2 children
+  else{
+    // finding in order successor
+    Node* prev = x;
+    Node* successor = x->right;
+    while(successor->left){
+      prev = successor;
+      successor = successor->left;
     }
-    --node_count; // decrease node count variable
+
+    // copying successor's key and value into x
+    x->key = successor->key;
+    x->value = successor->value;
+
+    // unlink and delete successor
+    if(prev == x)
+      prev->right = successor->right; // successor was x's right child
+    else
+      prev->left = successor->right;  // point prev to successor's right subtree
+    delete successor;
   }
+  --node_count; // decrease node count variable
   return subtree_root;
 }
 
 // helper function for find-range
-template<typename K, typename V>
-void BSTCollection<K,V>::find(const Node* subtree_root, 
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::find(const Node* subtree_root, 
 const K& k1, const K& k2, ArrayList<K>& keys) const
 {
-  // check if you have reached the end of a path (base case)
-  if(!subtree_root) return;
-
-  // traverse through the tree
-  if(subtree_root->key < k1){
-    find(subtree_root->right, k1, k2, keys);  // traverse right
-  }
-  else if(subtree_root->key >= k1 && subtree_root->key <= k2){
-    keys.add(subtree_root->key);  // if the key is within range, add it to the array list
-    find(subtree_root->right, k1, k2, keys);  // traverse right
-    find(subtree_root->left, k1, k2, keys); // traverse left
-  }
-  else{
-    find(subtree_root->left, k1, k2, keys); // traverse left
+  // in-order walk that skips the subtrees left of k1 and stops after k2
+  ArrayList<const Node*> path;  // Nodes whose left subtree is being walked
+  const Node* cur = subtree_root;
+  while(cur || path.size() > 0){
+    if(cur){
+      if(compare(cur->key, k1) < 0){
+        cur = cur->right;  // cur and its left subtree are before the range
+      }
+      else{
+        path.add(cur);
+        cur = cur->left;  // traverse left
+      }
+    }
+    else{
+      cur = path[path.size() - 1];
+      path.remove(path.size() - 1);
+      if(compare(cur->key, k2) > 0) return; // the rest are after the range
+      keys.add(cur->key);  // the key is within range, add it to the array list
+      cur = cur->right;  // traverse right
+    }
   }
 }
 
 // helper function for keys
-template<typename K, typename V>
-void BSTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
-{
-  // check if you have reached the end of a path (base case)
-  if(!subtree_root) return;
-  // traverse left subtree
-  keys(subtree_root->left, all_keys);
-  // visit subtree_root
-  all_keys.add(subtree_root->key);
-  // traverse right subtree
-  keys(subtree_root->right, all_keys);
+template<typename K, typename V, typename C>
+void BSTCollection<K,V,C>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+{
+  in_order(subtree_root, [&](const Node* x){all_keys.add(x->key);});
+}
+
+// helper function for memory_usage
+template<typename K, typename V, typename C>
+size_t BSTCollection<K,V,C>::dynamic_memory(const Node* subtree_root) const
+{
+  size_t bytes = 0;
+  in_order(subtree_root, [&](const Node* x){
+    bytes += DynamicMemory<K>::bytes(x->key) + DynamicMemory<V>::bytes(x->value);
+  });
+  return bytes;
 }
 
 // helper function for height
-template<typename K, typename V>
-size_t BSTCollection<K,V>::height(const Node* subtree_root) const
-{
-  if(!subtree_root) return 0; // return if the subtree_root is nullptr (base case)
-  size_t left_height = 0;  // variable to keep track of the height of the left subtree
-  size_t right_height = 0; // variable to keep track of the height of the right subtree
-  // get the height of the left subtree if it exists
-  if(subtree_root->left){
-    left_height = height(subtree_root->left);
+template<typename K, typename V, typename C>
+size_t BSTCollection<K,V,C>::height(const Node* subtree_root) const
+{
+  // count the levels, keeping one level of Nodes at a time
+  size_t levels = 0;
+  ArrayList<const Node*> level;
+  if(subtree_root) level.add(subtree_root);
+  while(level.size() > 0){
+    ++levels;
+    ArrayList<const Node*> next_level;
+    for(size_t i = 0; i < level.size(); ++i){
+      if(level[i]->left) next_level.add(level[i]->left);
+      if(level[i]->right) next_level.add(level[i]->right);
+    }
+    level = std::move(next_level);
   }
-  if(subtree_root->right){
-    right_height = height(subtree_root->right);
+  return levels;
+}
+
+// helper function for keys and memory_usage
+template<typename K, typename V, typename C>
+template<typename F>
+void BSTCollection<K,V,C>::in_order(const Node* subtree_root, F visit) const
+{
+  ArrayList<const Node*> path;  // Nodes whose left subtree is being walked
+  const Node* cur = subtree_root;
+  while(cur || path.size() > 0){
+    if(cur){
+      path.add(cur);
+      cur = cur->left;  // traverse left subtree
+    }
+    else{
+      cur = path[path.size() - 1];
+      path.remove(path.size() - 1);
+      visit(cur);  // visit cur
+      cur = cur->right; // traverse right subtree
+    }
   }
-  // check which height is larger and return that height +1
-  if(left_height > right_height){
-    return left_height+1;
+}
+
+// helper function for find and find_ptr
+template<typename K, typename V, typename C>
+typename BSTCollection<K,V,C>::Node*
+BSTCollection<K,V,C>::find_node(const K& search_key) const
+{
+  Node* cur = root; // Node pointer to keep track of current location in the tree
+  while(cur){
+    int c = compare(search_key, cur->key);
+    if(c == 0) // search_key is found
+      return cur;
+    else if(c < 0) // key at cur is less than search_key
+      cur = cur->left;  // iterate through cur's left subtree
+    else  // key at cur is greater than search_key
+      cur = cur->right; // iterate through cur's right subtree
   }
-  else return right_height +1;
-  
+  return nullptr; // return nullptr since you did not find search_key
+}
+
+// helper function for find_or_insert and insert_or_assign (finds the
+// key or its insertion point in one pass down the tree)
+template<typename K, typename V, typename C>
+template<typename... Args>
+typename BSTCollection<K,V,C>::Node*
+BSTCollection<K,V,C>::find_or_add(const K& key, bool& added, Args&&... args)
+{
+  Node* cur = root; // Node pointer to keep track of current location in the tree
+  Node* prev = nullptr; // Node pointer to keep track of Node before cur
+  int c = 0;
+  while(cur){
+    c = compare(key, cur->key);
+    if(c == 0){ // key is already in the tree
+      added = false;
+      return cur;
+    }
+    prev = cur;
+    cur = (c < 0) ? cur->left : cur->right;
+  }
+  Node* tmp = new Node(key, std::forward<Args>(args)...);
+  if(!prev) root = tmp; // special case if there is nothing in the tree
+  else if(c < 0) prev->left = tmp;
+  else prev->right = tmp;
+  ++node_count; // increment node_count
+  added = true;
+  return tmp;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -26,7 +26,9 @@
 #ifndef COLLECTION_H
 #define COLLECTION_H
 
+#include <utility>
 #include "array_list.h"
+#include "dynamic_memory.h"
 
 
 template<typename K, typename V>
@@ -40,6 +42,10 @@ public:
   // add a new key-value pair into the collection 
   virtual void add(const K& a_key, const V& a_val) = 0;
 
+  // add a new key-value pair, moving the key and value into the
+  // collection (copies them by default)
+  virtual void add(K&& a_key, V&& a_val) {add(a_key, a_val);}
+
   // remove a key-value pair from the collection
   virtual void remove(const K& a_key) = 0;
 
@@ -47,6 +53,20 @@ public:
   // if key isn't found, returns false, otherwise true
   virtual bool find(const K& search_key, V& the_val) const = 0;
 
+  // return the value associated with the key for in-place updates,
+  // adding the key with a default value if it isn't found (the
+  // reference is valid until the collection is next modified)
+  virtual V& find_or_insert(const K& a_key) = 0;
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  virtual bool insert_or_assign(const K& a_key, const V& a_val) = 0;
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found (valid until the collection is next modified)
+  virtual V* find_ptr(const K& a_key) = 0;
+  virtual const V* find_ptr(const K& a_key) const = 0;
+
   // find and return each key >= k1 and <= k2 
   virtual void find(const K& k1, const K& k2, ArrayList<K>& keys) const = 0;
   
@@ -59,6 +79,11 @@ public:
   // return the number of key-value pairs in the collection
   virtual size_t size() const = 0;
 
+  // return the number of bytes used by the collection: the collection
+  // object, its nodes or arrays (including unused capacity), and the
+  // dynamic memory of its keys and values (see dynamic_memory.h)
+  virtual size_t memory_usage() const = 0;
+
 };
 
 
@@ -0,0 +1,841 @@
+//----------------------------------------------------------------------
+// FILE: compact_rbt_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: A Key-Value Collection implementation using a red-black tree
+// whose nodes live in one contiguous pool. Nodes refer to each other
+// by 32-bit pool indices instead of pointers, and the node color is
+// packed into the top bit of the parent index, so each node only adds
+// 12 bytes to its key and value. Index 0 is the (BLACK) nil sentinel.
+// The 31-bit indices limit the pool to 2^31 - 1 nodes; an add that
+// needs more throws std::length_error.
+//----------------------------------------------------------------------
+
+#ifndef COMPACT_RBT_COLLECTION_H
+#define COMPACT_RBT_COLLECTION_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <iostream>
+#include <utility>
+#include "collection.h"
+#include "key_compare.h"
+#include "array_list.h"
+
+
+template<typename K, typename V, typename Compare = ThreeWayCompare<K>>
+class CompactRBTCollection : public Collection<K,V>
+{
+public:
+
+  // create an empty collection
+  CompactRBTCollection();
+
+  // copy constructor
+  CompactRBTCollection(const CompactRBTCollection<K,V,Compare>& rhs);
+
+  // assignment operator
+  CompactRBTCollection<K,V,Compare>& operator=(const CompactRBTCollection<K,V,Compare>& rhs);
+
+  // delete collection
+  ~CompactRBTCollection();
+
+  // add a new key-value pair into the collection
+  void add(const K& a_key, const V& a_val);
+
+  // remove a key-value pair from the collection
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // return the value associated with the key for in-place updates,
+  // adding the key with a default value if it isn't found (the
+  // reference is valid until the next add, since the pool may move)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // find and return each key >= k1 and <= k2 (in ascending order)
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return the height of the tree
+  size_t height() const;
+
+  // return the number of bytes used by the collection (including
+  // unused pool nodes and the keys' and values' dynamic memory)
+  size_t memory_usage() const;
+
+  // for testing:
+
+  // check if tree satisfies the red-black tree constraints
+  bool valid_rbt() const;
+
+  // pretty-print the red-black tree (with heights)
+  void print() const;
+
+
+private:
+
+  // node structure (the color is the top bit of parent_color)
+  struct Node {
+    K key;
+    V value;
+    uint32_t left;
+    uint32_t right;
+    uint32_t parent_color;
+  };
+
+  static const uint32_t NIL = 0;                  // sentinel index
+  static const uint32_t RED_BIT = 0x80000000u;    // set for RED nodes
+  static const uint32_t INDEX_MASK = 0x7fffffffu; // parent index bits
+
+  // node pool (pool[0] is the sentinel)
+  Node* pool;
+
+  // number of nodes the pool can hold
+  uint32_t capacity;
+
+  // number of pool nodes handed out so far (including the sentinel)
+  uint32_t used;
+
+  // first removed node available for reuse (linked through left)
+  uint32_t free_list;
+
+  // root node index
+  uint32_t root;
+
+  // number of k-v pairs stored in the collection
+  size_t node_count;
+
+  // parent and color helpers
+  uint32_t parent(uint32_t x) const;
+  void set_parent(uint32_t x, uint32_t p);
+  bool is_red(uint32_t x) const;
+  void set_red(uint32_t x);
+  void set_black(uint32_t x);
+
+  // helper to get an unused node (may move the pool)
+  uint32_t allocate_node();
+
+  // helper to give a node back to the pool
+  void deallocate_node(uint32_t x);
+
+  // helper to double the size of the pool (throws std::length_error
+  // if the pool already holds as many nodes as indices can address)
+  void resize();
+
+  // helper to copy the pool of another collection
+  void copy(const CompactRBTCollection<K,V,Compare>& rhs);
+
+  // three-way compare of two keys using the comparison policy
+  static int compare(const K& a, const K& b) {return Compare()(a, b);}
+
+  // helper to find the node with a key (NIL if none)
+  uint32_t find_node(const K& search_key) const;
+
+  // helper to find the node with a key, adding a node for it (with a
+  // default value) if there is none
+  uint32_t find_or_add(const K& a_key, bool& added);
+
+  // rotate helpers
+  void rotate_left(uint32_t x);
+  void rotate_right(uint32_t x);
+
+  // restore red-black constraints after add
+  void add_rebalance(uint32_t z);
+
+  // restore red-black constraints after remove
+  void remove_rebalance(uint32_t x);
+
+  // helper to replace the subtree at u with the subtree at v
+  void transplant(uint32_t u, uint32_t v);
+
+  // helper to recursively collect a range of keys
+  void find(uint32_t subtree_root, const K& k1, const K& k2,
+            ArrayList<K>& keys) const;
+
+  // helper to build sorted list of keys (used by keys and sort)
+  void keys(uint32_t subtree_root, ArrayList<K>& all_keys) const;
+
+  // height helper
+  size_t height(uint32_t subtree_root) const;
+
+  // validate helper (returns the black height, or -1 if invalid)
+  int valid_rbt(uint32_t subtree_root) const;
+
+  // recursive pretty-print helper
+  void print_tree(std::string indent, uint32_t subtree_root) const;
+};
+
+
+template<typename K, typename V, typename Compare>
+CompactRBTCollection<K,V,Compare>::CompactRBTCollection()
+  : capacity(16), used(1), free_list(NIL), root(NIL), node_count(0)
+{
+  pool = new Node[capacity];
+  pool[NIL].left = NIL;
+  pool[NIL].right = NIL;
+  pool[NIL].parent_color = NIL;  // BLACK
+}
+
+template<typename K, typename V, typename Compare>
+CompactRBTCollection<K,V,Compare>::CompactRBTCollection(const CompactRBTCollection<K,V,Compare>& rhs)
+  : pool(nullptr)
+{
+  copy(rhs);
+}
+
+template<typename K, typename V, typename Compare>
+CompactRBTCollection<K,V,Compare>&
+CompactRBTCollection<K,V,Compare>::operator=(const CompactRBTCollection<K,V,Compare>& rhs)
+{
+  if(this != &rhs){
+    delete [] pool;
+    copy(rhs);
+  }
+  return *this;
+}
+
+template<typename K, typename V, typename Compare>
+CompactRBTCollection<K,V,Compare>::~CompactRBTCollection()
+{
+  delete [] pool;
+}
+
+//  Function: add()
+//  Description: Adds a key-value pair at the bottom of the tree, then
+//  recolors and rotates back up toward the root
+//  Inputs: Key and value to be added to the tree
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::add(const K& a_key, const V& a_val)
+{
+  // allocate first, since growing the pool moves the nodes
+  uint32_t z = allocate_node();
+  pool[z].key = a_key;
+  pool[z].value = a_val;
+  pool[z].left = NIL;
+  pool[z].right = NIL;
+  // find the parent of the new node
+  uint32_t y = NIL;
+  uint32_t x = root;
+  while(x != NIL){
+    y = x;
+    x = (compare(a_key, pool[x].key) < 0) ? pool[x].left : pool[x].right;
+  }
+  pool[z].parent_color = y;
+  if(y == NIL)
+    root = z;
+  else if(compare(a_key, pool[y].key) < 0)
+    pool[y].left = z;
+  else
+    pool[y].right = z;
+  set_red(z);
+  add_rebalance(z);
+  node_count++;
+}
+
+//  Function: remove()
+//  Description: Removes the pair with the given key (if any), splicing
+//  out the node or its successor and then fixing the black heights
+//  Inputs: The key of the pair to be removed
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::remove(const K& a_key)
+{
+  uint32_t z = find_node(a_key);
+  if(z == NIL) return;
+  uint32_t y = z;
+  bool y_was_red = is_red(y);
+  uint32_t x;
+  if(pool[z].left == NIL){
+    x = pool[z].right;
+    transplant(z, x);
+  }
+  else if(pool[z].right == NIL){
+    x = pool[z].left;
+    transplant(z, x);
+  }
+  else{
+    // splice out the successor and move it into z's place
+    y = pool[z].right;
+    while(pool[y].left != NIL) y = pool[y].left;
+    y_was_red = is_red(y);
+    x = pool[y].right;
+    if(parent(y) == z)
+      set_parent(x, y);  // (x may be the sentinel)
+    else{
+      transplant(y, x);
+      pool[y].right = pool[z].right;
+      set_parent(pool[y].right, y);
+    }
+    transplant(z, y);
+    pool[y].left = pool[z].left;
+    set_parent(pool[y].left, y);
+    if(is_red(z)) set_red(y);
+    else set_black(y);
+  }
+  if(!y_was_red) remove_rebalance(x);
+  deallocate_node(z);
+  node_count--;
+}
+
+//  Function: find()
+//  Description: Finds the value of the given key
+//  Inputs: Key to search for, variable for the value
+//  Outputs: True if the key was found
+template<typename K, typename V, typename Compare>
+bool CompactRBTCollection<K,V,Compare>::find(const K& search_key, V& the_val) const
+{
+  uint32_t x = find_node(search_key);
+  if(x == NIL) return false;
+  the_val = pool[x].value;
+  return true;
+}
+
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value if it is not in the tree
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename Compare>
+V& CompactRBTCollection<K,V,Compare>::find_or_insert(const K& a_key)
+{
+  bool added;
+  uint32_t x = find_or_add(a_key, added); // may move the pool
+  return pool[x].value;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the tree
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename Compare>
+bool CompactRBTCollection<K,V,Compare>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  bool added;
+  uint32_t x = find_or_add(a_key, added); // may move the pool
+  pool[x].value = a_val;
+  return added;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V, typename Compare>
+V* CompactRBTCollection<K,V,Compare>::find_ptr(const K& a_key)
+{
+  uint32_t x = find_node(a_key);
+  return x == NIL ? nullptr : &pool[x].value;
+}
+
+template<typename K, typename V, typename Compare>
+const V* CompactRBTCollection<K,V,Compare>::find_ptr(const K& a_key) const
+{
+  uint32_t x = find_node(a_key);
+  return x == NIL ? nullptr : &pool[x].value;
+}
+
+//  Function: find()
+//  Description: Finds each key >= k1 and <= k2, in ascending order
+//  Inputs: Smallest and largest key of the range, list for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::find(const K& k1, const K& k2,
+                                             ArrayList<K>& keys) const
+{
+  find(root, k1, k2, keys);
+}
+
+//  Function: keys()
+//  Description: Returns all keys in the collection
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::keys(ArrayList<K>& all_keys) const
+{
+  keys(root, all_keys);
+}
+
+//  Function: sort()
+//  Description: Returns all keys in ascending order
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  keys(all_keys_sorted);
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs in the collection
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename Compare>
+size_t CompactRBTCollection<K,V,Compare>::size() const
+{
+  return node_count;
+}
+
+//  Function: height()
+//  Description: Returns the height of the tree
+//  Inputs: None
+//  Outputs: Height of the tree
+template<typename K, typename V, typename Compare>
+size_t CompactRBTCollection<K,V,Compare>::height() const
+{
+  return height(root);
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection object, its
+//  whole node pool, and the dynamic memory of the keys and values in
+//  the nodes handed out so far (removed nodes hold default ones)
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename Compare>
+size_t CompactRBTCollection<K,V,Compare>::memory_usage() const
+{
+  size_t bytes = sizeof(*this) + capacity * sizeof(Node);
+  for(uint32_t i = 1; i < used; ++i)
+    bytes += DynamicMemory<K>::bytes(pool[i].key) + DynamicMemory<V>::bytes(pool[i].value);
+  return bytes;
+}
+
+//  Function: valid_rbt()
+//  Description: Checks the key order, parent links, colors and black
+//  heights of the tree
+//  Inputs: None
+//  Outputs: True if the tree is valid
+template<typename K, typename V, typename Compare>
+bool CompactRBTCollection<K,V,Compare>::valid_rbt() const
+{
+  if(is_red(root)) return false;
+  if(root != NIL && parent(root) != NIL) return false;
+  return valid_rbt(root) >= 0;
+}
+
+//  Function: print()
+//  Description: Pretty-prints the tree
+//  Inputs: None
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::print() const
+{
+  print_tree("", root);
+}
+
+//----------------------------------------------------------------------
+// Helper Functions
+//----------------------------------------------------------------------
+
+// helper function to get a node's parent
+template<typename K, typename V, typename Compare>
+uint32_t CompactRBTCollection<K,V,Compare>::parent(uint32_t x) const
+{
+  return pool[x].parent_color & INDEX_MASK;
+}
+
+// helper function to set a node's parent (keeping its color)
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::set_parent(uint32_t x, uint32_t p)
+{
+  pool[x].parent_color = (pool[x].parent_color & RED_BIT) | p;
+}
+
+// helper function to check a node's color
+template<typename K, typename V, typename Compare>
+bool CompactRBTCollection<K,V,Compare>::is_red(uint32_t x) const
+{
+  return pool[x].parent_color & RED_BIT;
+}
+
+// helper function to color a node RED
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::set_red(uint32_t x)
+{
+  pool[x].parent_color |= RED_BIT;
+}
+
+// helper function to color a node BLACK
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::set_black(uint32_t x)
+{
+  pool[x].parent_color &= INDEX_MASK;
+}
+
+// helper function to get an unused node
+template<typename K, typename V, typename Compare>
+uint32_t CompactRBTCollection<K,V,Compare>::allocate_node()
+{
+  // reuse a removed node first
+  if(free_list != NIL){
+    uint32_t x = free_list;
+    free_list = pool[x].left;
+    return x;
+  }
+  if(used == capacity) resize();
+  return used++;
+}
+
+// helper function to put a removed node on the free list
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::deallocate_node(uint32_t x)
+{
+  // drop the key and value (so they release any memory they hold)
+  pool[x].key = K();
+  pool[x].value = V();
+  pool[x].left = free_list;
+  free_list = x;
+}
+
+// helper function to double the size of the pool
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::resize()
+{
+  if(capacity >= INDEX_MASK)
+    throw std::length_error("CompactRBTCollection: node pool is full");
+  uint32_t new_capacity = capacity * 2;
+  if(new_capacity > INDEX_MASK) new_capacity = INDEX_MASK;
+  Node* new_pool = new Node[new_capacity];
+  for(uint32_t i = 0; i < used; ++i){
+    new_pool[i].key = std::move(pool[i].key);
+    new_pool[i].value = std::move(pool[i].value);
+    new_pool[i].left = pool[i].left;
+    new_pool[i].right = pool[i].right;
+    new_pool[i].parent_color = pool[i].parent_color;
+  }
+  delete [] pool;
+  pool = new_pool;
+  capacity = new_capacity;
+}
+
+// helper function for the copy constructor and assignment operator
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::copy(const CompactRBTCollection<K,V,Compare>& rhs)
+{
+  capacity = rhs.capacity;
+  used = rhs.used;
+  free_list = rhs.free_list;
+  root = rhs.root;
+  node_count = rhs.node_count;
+  pool = new Node[capacity];
+  // indices stay valid, so the pool is copied as is
+  for(uint32_t i = 0; i < used; ++i)
+    pool[i] = rhs.pool[i];
+}
+
+// helper function to find a key's node
+template<typename K, typename V, typename Compare>
+uint32_t CompactRBTCollection<K,V,Compare>::find_node(const K& search_key) const
+{
+  uint32_t x = root;
+  while(x != NIL){
+    int c = compare(search_key, pool[x].key);
+    if(c < 0)
+      x = pool[x].left;
+    else if(c > 0)
+      x = pool[x].right;
+    else
+      return x;
+  }
+  return NIL;
+}
+
+// helper function for find_or_insert and insert_or_assign (one pass to
+// find the key or the parent of its new node)
+template<typename K, typename V, typename Compare>
+uint32_t CompactRBTCollection<K,V,Compare>::find_or_add(const K& a_key, bool& added)
+{
+  uint32_t y = NIL;
+  uint32_t x = root;
+  bool go_left = false;
+  while(x != NIL){
+    y = x;
+    int c = compare(a_key, pool[x].key);
+    go_left = c < 0;
+    if(go_left)
+      x = pool[x].left;
+    else if(c > 0)
+      x = pool[x].right;
+    else{
+      added = false;
+      return x;
+    }
+  }
+  // indices (unlike pointers) stay valid if the pool moves here
+  uint32_t z = allocate_node();
+  pool[z].key = a_key;
+  pool[z].value = V();
+  pool[z].left = NIL;
+  pool[z].right = NIL;
+  pool[z].parent_color = y;
+  if(y == NIL)
+    root = z;
+  else if(go_left)
+    pool[y].left = z;
+  else
+    pool[y].right = z;
+  set_red(z);
+  add_rebalance(z);
+  node_count++;
+  added = true;
+  return z;
+}
+
+// helper function for left rotations
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::rotate_left(uint32_t x)
+{
+  uint32_t y = pool[x].right;
+  pool[x].right = pool[y].left;
+  if(pool[y].left != NIL) set_parent(pool[y].left, x);
+  uint32_t p = parent(x);
+  set_parent(y, p);
+  if(p == NIL) root = y;
+  else if(x == pool[p].left) pool[p].left = y;
+  else pool[p].right = y;
+  pool[y].left = x;
+  set_parent(x, y);
+}
+
+// helper function for right rotations
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::rotate_right(uint32_t x)
+{
+  uint32_t y = pool[x].left;
+  pool[x].left = pool[y].right;
+  if(pool[y].right != NIL) set_parent(pool[y].right, x);
+  uint32_t p = parent(x);
+  set_parent(y, p);
+  if(p == NIL) root = y;
+  else if(x == pool[p].right) pool[p].right = y;
+  else pool[p].left = y;
+  pool[y].right = x;
+  set_parent(x, y);
+}
+
+// helper function for rebalancing after add
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::add_rebalance(uint32_t z)
+{
+  while(is_red(parent(z))){
+    uint32_t p = parent(z);
+    uint32_t g = parent(p);
+    if(p == pool[g].left){
+      uint32_t u = pool[g].right;
+      // case 1 - RED uncle, color flip
+      if(is_red(u)){
+        set_black(p);
+        set_black(u);
+        set_red(g);
+        z = g;
+        continue;
+      }
+      // case 3 - inside node, rotate it to the outside
+      if(z == pool[p].right){
+        z = p;
+        rotate_left(z);
+        p = parent(z);
+      }
+      // case 2 - outside node, rotate at the grandparent
+      set_black(p);
+      set_red(g);
+      rotate_right(g);
+    }
+    else{
+      uint32_t u = pool[g].left;
+      if(is_red(u)){
+        set_black(p);
+        set_black(u);
+        set_red(g);
+        z = g;
+        continue;
+      }
+      if(z == pool[p].left){
+        z = p;
+        rotate_right(z);
+        p = parent(z);
+      }
+      set_black(p);
+      set_red(g);
+      rotate_left(g);
+    }
+  }
+  set_black(root);
+}
+
+// helper function for rebalancing after remove (x carries an extra
+// BLACK, and may be the sentinel with its parent set)
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::remove_rebalance(uint32_t x)
+{
+  while(x != root && !is_red(x)){
+    uint32_t p = parent(x);
+    if(x == pool[p].left){
+      uint32_t w = pool[p].right;
+      // case 1 - RED sibling, rotate it above p
+      if(is_red(w)){
+        set_black(w);
+        set_red(p);
+        rotate_left(p);
+        w = pool[p].right;
+      }
+      // case 2 - sibling with BLACK children, push the BLACK up
+      if(!is_red(pool[w].left) && !is_red(pool[w].right)){
+        set_red(w);
+        x = p;
+      }
+      else{
+        // case 3 - only the inside nephew is RED, rotate it outside
+        if(!is_red(pool[w].right)){
+          set_black(pool[w].left);
+          set_red(w);
+          rotate_right(w);
+          w = pool[p].right;
+        }
+        // case 4 - outside nephew is RED, rotate at p and finish
+        if(is_red(p)) set_red(w);
+        else set_black(w);
+        set_black(p);
+        set_black(pool[w].right);
+        rotate_left(p);
+        x = root;
+      }
+    }
+    else{
+      uint32_t w = pool[p].left;
+      if(is_red(w)){
+        set_black(w);
+        set_red(p);
+        rotate_right(p);
+        w = pool[p].left;
+      }
+      if(!is_red(pool[w].right) && !is_red(pool[w].left)){
+        set_red(w);
+        x = p;
+      }
+      else{
+        if(!is_red(pool[w].left)){
+          set_black(pool[w].right);
+          set_red(w);
+          rotate_left(w);
+          w = pool[p].left;
+        }
+        if(is_red(p)) set_red(w);
+        else set_black(w);
+        set_black(p);
+        set_black(pool[w].left);
+        rotate_right(p);
+        x = root;
+      }
+    }
+  }
+  set_black(x);
+}
+
+// helper function for remove
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::transplant(uint32_t u, uint32_t v)
+{
+  uint32_t p = parent(u);
+  if(p == NIL) root = v;
+  else if(u == pool[p].left) pool[p].left = v;
+  else pool[p].right = v;
+  set_parent(v, p);  // (v may be the sentinel)
+}
+
+// helper function for find (range)
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::find(uint32_t subtree_root, const K& k1,
+                                             const K& k2, ArrayList<K>& keys) const
+{
+  if(subtree_root == NIL) return;
+  const Node& x = pool[subtree_root];
+  // traverse left only if smaller keys can still be in range
+  int c1 = compare(x.key, k1);
+  int c2 = compare(x.key, k2);
+  if(c1 > 0) find(x.left, k1, k2, keys);
+  if(c1 >= 0 && c2 <= 0) keys.add(x.key);
+  // traverse right only if larger keys can still be in range
+  if(c2 < 0) find(x.right, k1, k2, keys);
+}
+
+// helper function for keys
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::keys(uint32_t subtree_root,
+                                             ArrayList<K>& all_keys) const
+{
+  if(subtree_root == NIL) return;
+  keys(pool[subtree_root].left, all_keys);
+  all_keys.add(pool[subtree_root].key);
+  keys(pool[subtree_root].right, all_keys);
+}
+
+// helper function for height
+template<typename K, typename V, typename Compare>
+size_t CompactRBTCollection<K,V,Compare>::height(uint32_t subtree_root) const
+{
+  if(subtree_root == NIL) return 0;
+  size_t lh = height(pool[subtree_root].left);
+  size_t rh = height(pool[subtree_root].right);
+  return 1 + (lh > rh ? lh : rh);
+}
+
+// helper function for valid_rbt
+template<typename K, typename V, typename Compare>
+int CompactRBTCollection<K,V,Compare>::valid_rbt(uint32_t subtree_root) const
+{
+  if(subtree_root == NIL) return 0;
+  const Node& x = pool[subtree_root];
+  // children must point back and be in key order
+  if(x.left != NIL &&
+     (parent(x.left) != subtree_root || compare(x.key, pool[x.left].key) < 0))
+    return -1;
+  if(x.right != NIL &&
+     (parent(x.right) != subtree_root || compare(pool[x.right].key, x.key) < 0))
+    return -1;
+  // a RED node has BLACK children
+  if(is_red(subtree_root) && (is_red(x.left) || is_red(x.right)))
+    return -1;
+  int lh = valid_rbt(x.left);
+  int rh = valid_rbt(x.right);
+  if(lh < 0 || rh < 0 || lh != rh) return -1;
+  return lh + (is_red(subtree_root) ? 0 : 1);
+}
+
+// helper function for print
+template<typename K, typename V, typename Compare>
+void CompactRBTCollection<K,V,Compare>::print_tree(std::string indent,
+                                                   uint32_t subtree_root) const
+{
+  if(subtree_root == NIL) return;
+  std::string color = is_red(subtree_root) ? "[RED]" : "[BLACK]";
+  std::cout << indent << pool[subtree_root].key << " "
+            << color << " (h=" << height(subtree_root) << ")" << std::endl;
+  print_tree(indent + "  ", pool[subtree_root].left);
+  print_tree(indent + "  ", pool[subtree_root].right);
+}
+
+
+#endif
@@ -0,0 +1,267 @@
+//----------------------------------------------------------------------
+// FILE: concurrent_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Thread-safe wrapper around a collection (an RBTCollection by
+// default). Any number of readers (find, range find, keys, sort, size)
+// run at the same time, while add and remove get exclusive access and
+// run the wrapped collection's usual single-pass top-down rebalancing.
+// find_or_insert and find_ptr hand out a reference into the collection
+// after the lock is released, so they are not safe while other threads
+// write; update() changes a value in place under the lock.
+//----------------------------------------------------------------------
+
+#ifndef CONCURRENT_COLLECTION_H
+#define CONCURRENT_COLLECTION_H
+
+#include <mutex>
+#include "collection.h"
+#include "array_list.h"
+#include "rbt_collection.h"
+#include "rw_lock.h"
+
+
+template<typename K, typename V, typename Impl = RBTCollection<K,V>,
+         typename Lock = RWLock>
+class ConcurrentCollection : public Collection<K,V>
+{
+public:
+
+  // add a new key-value pair into the collection
+  void add(const K& a_key, const V& a_val);
+
+  // remove a key-value pair from the collection
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // return the value associated with the key, adding the key with a
+  // default value if it isn't found (not thread safe: the lock is
+  // released on return, so the reference may only be used while no
+  // other thread writes; use update() to change a value in place)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found (not thread safe, as for find_or_insert)
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // call update(value) with exclusive access on the value associated
+  // with the key, adding the key with a default value if it isn't
+  // found (e.g., to bump a counter)
+  template<typename Update>
+  void update(const K& a_key, Update update);
+
+  // find and return each key >= k1 and <= k2
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return the number of bytes used by the collection
+  size_t memory_usage() const;
+
+  // call read(collection) with shared access to the wrapped collection
+  template<typename Read>
+  void read(Read read) const;
+
+  // call write(collection) with exclusive access to the wrapped
+  // collection
+  template<typename Write>
+  void write(Write write);
+
+private:
+
+  // the wrapped collection
+  Impl collection;
+
+  // guards the collection (locked by const readers too)
+  mutable Lock lock;
+};
+
+
+//  Function: add()
+//  Description: Adds a key-value pair while holding exclusive access
+//  Inputs: Key and value to be added
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+void ConcurrentCollection<K,V,Impl,Lock>::add(const K& a_key, const V& a_val)
+{
+  std::lock_guard<Lock> guard(lock);
+  collection.add(a_key, a_val);
+}
+
+//  Function: remove()
+//  Description: Removes a key-value pair while holding exclusive access
+//  Inputs: The key of the pair to be removed
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+void ConcurrentCollection<K,V,Impl,Lock>::remove(const K& a_key)
+{
+  std::lock_guard<Lock> guard(lock);
+  collection.remove(a_key);
+}
+
+//  Function: find()
+//  Description: Finds the value of a key while holding shared access
+//  Inputs: Key to search for, variable for the value
+//  Outputs: True if the key was found
+template<typename K, typename V, typename Impl, typename Lock>
+bool ConcurrentCollection<K,V,Impl,Lock>::find(const K& search_key, V& the_val) const
+{
+  SharedGuard<Lock> guard(lock);
+  return collection.find(search_key, the_val);
+}
+
+//  Function: find_or_insert()
+//  Description: Finds or adds a key while holding exclusive access
+//  Inputs: Key to search for
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename Impl, typename Lock>
+V& ConcurrentCollection<K,V,Impl,Lock>::find_or_insert(const K& a_key)
+{
+  std::lock_guard<Lock> guard(lock);
+  return collection.find_or_insert(a_key);
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds or replaces a key-value pair while holding
+//  exclusive access
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename Impl, typename Lock>
+bool ConcurrentCollection<K,V,Impl,Lock>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  std::lock_guard<Lock> guard(lock);
+  return collection.insert_or_assign(a_key, a_val);
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value of a key in place while holding
+//  exclusive (or, for the const version, shared) access
+//  Inputs: Key to search for
+//  Outputs: Pointer to the value (nullptr if not found)
+template<typename K, typename V, typename Impl, typename Lock>
+V* ConcurrentCollection<K,V,Impl,Lock>::find_ptr(const K& a_key)
+{
+  std::lock_guard<Lock> guard(lock);
+  return collection.find_ptr(a_key);
+}
+
+template<typename K, typename V, typename Impl, typename Lock>
+const V* ConcurrentCollection<K,V,Impl,Lock>::find_ptr(const K& a_key) const
+{
+  SharedGuard<Lock> guard(lock);
+  return collection.find_ptr(a_key);
+}
+
+//  Function: update()
+//  Description: Finds or adds a key and runs an operation on its value
+//  while holding exclusive access
+//  Inputs: Key to search for, function called with a reference to the
+//  value
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+template<typename Update>
+void ConcurrentCollection<K,V,Impl,Lock>::update(const K& a_key, Update update)
+{
+  std::lock_guard<Lock> guard(lock);
+  update(collection.find_or_insert(a_key));
+}
+
+//  Function: find()
+//  Description: Finds the keys in a range while holding shared access
+//  Inputs: Smallest and largest key of the range, list for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+void ConcurrentCollection<K,V,Impl,Lock>::find(const K& k1, const K& k2,
+                                               ArrayList<K>& keys) const
+{
+  SharedGuard<Lock> guard(lock);
+  collection.find(k1, k2, keys);
+}
+
+//  Function: keys()
+//  Description: Returns all keys while holding shared access
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+void ConcurrentCollection<K,V,Impl,Lock>::keys(ArrayList<K>& all_keys) const
+{
+  SharedGuard<Lock> guard(lock);
+  collection.keys(all_keys);
+}
+
+//  Function: sort()
+//  Description: Returns all keys in order while holding shared access
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+void ConcurrentCollection<K,V,Impl,Lock>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  SharedGuard<Lock> guard(lock);
+  collection.sort(all_keys_sorted);
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs while holding shared access
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename Impl, typename Lock>
+size_t ConcurrentCollection<K,V,Impl,Lock>::size() const
+{
+  SharedGuard<Lock> guard(lock);
+  return collection.size();
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the wrapper and the wrapped
+//  collection while holding shared access
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename Impl, typename Lock>
+size_t ConcurrentCollection<K,V,Impl,Lock>::memory_usage() const
+{
+  SharedGuard<Lock> guard(lock);
+  return sizeof(*this) - sizeof(collection) + collection.memory_usage();
+}
+
+//  Function: read()
+//  Description: Runs a read-only operation (e.g., an RBTCollection
+//  scan or rank) on the wrapped collection while holding shared access
+//  Inputs: Function called with a const reference to the collection
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+template<typename Read>
+void ConcurrentCollection<K,V,Impl,Lock>::read(Read read) const
+{
+  SharedGuard<Lock> guard(lock);
+  read(static_cast<const Impl&>(collection));
+}
+
+//  Function: write()
+//  Description: Runs an operation that may modify the wrapped
+//  collection while holding exclusive access
+//  Inputs: Function called with a reference to the collection
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Lock>
+template<typename Write>
+void ConcurrentCollection<K,V,Impl,Lock>::write(Write write)
+{
+  std::lock_guard<Lock> guard(lock);
+  write(collection);
+}
+
+
+#endif
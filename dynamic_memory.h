@@ -0,0 +1,62 @@
+//----------------------------------------------------------------------
+// FILE: dynamic_memory.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Counts the heap memory owned by keys and values, for the
+// collection memory_usage functions. DynamicMemory<T>::bytes(item)
+// returns the bytes the item has allocated outside of itself (its
+// sizeof is counted by whatever holds it):
+//
+//   plain types     0
+//   std::string     the character buffer, unless the characters fit
+//                   inside the string object (the short string case)
+//   std::pair       the dynamic memory of both members
+//   ArrayList<T>    the item array (including unused capacity) and
+//                   the items' own dynamic memory (array_list.h)
+//
+// Other types that own memory can be counted by specializing
+// DynamicMemory, like Serializer in serialize.h.
+//----------------------------------------------------------------------
+
+#ifndef DYNAMIC_MEMORY_H
+#define DYNAMIC_MEMORY_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+
+template<typename T>
+struct DynamicMemory
+{
+  static size_t bytes(const T&)
+  {
+    return 0;
+  }
+};
+
+
+template<>
+struct DynamicMemory<std::string>
+{
+  static size_t bytes(const std::string& item)
+  {
+    const char* start = reinterpret_cast<const char*>(&item);
+    if(item.data() >= start && item.data() < start + sizeof(item))
+      return 0;
+    return item.capacity() + 1;  // plus the terminating null
+  }
+};
+
+
+template<typename A, typename B>
+struct DynamicMemory<std::pair<A,B>>
+{
+  static size_t bytes(const std::pair<A,B>& item)
+  {
+    return DynamicMemory<A>::bytes(item.first) + DynamicMemory<B>::bytes(item.second);
+  }
+};
+
+
+#endif
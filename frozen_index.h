@@ -0,0 +1,508 @@
+//----------------------------------------------------------------------
+// FILE: frozen_index.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Read-only index over a frozen copy of a collection. freeze()
+// writes the pairs of any Collection to a file in Eytzinger (BFS)
+// order: slot i holds the root of a complete binary search tree whose
+// children are slots 2i and 2i+1, so the top levels of every search
+// share the same few cache lines. open() maps the file with mmap and
+// searches the mapped image in place, so opening takes O(1) time no
+// matter the size of the index, and processes opening the same file
+// share its pages through the page cache.
+//
+// Fixed-size (trivially copyable) keys and values are stored as is.
+// std::string keys and values are stored as an (offset, length) pair
+// into a string area at the end of the file and compared and returned
+// as std::string_view without copying. The file uses the machine's
+// byte order and type sizes, so it is only meant to be opened on the
+// same kind of machine.
+//----------------------------------------------------------------------
+
+#ifndef FROZEN_INDEX_H
+#define FROZEN_INDEX_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "collection.h"
+#include "array_list.h"
+#include "key_compare.h"
+
+
+// How a key or value type is laid out in a frozen index file:
+//
+//   stored             the type written into the file
+//   view_type          what a lookup hands back (without copying)
+//   store(item, area)  the stored form of item, appending any
+//                      variable-length bytes to the string area
+//   view(s, area)      the item for a stored form
+template<typename T>
+struct FrozenField
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "specialize FrozenField<T> to freeze this type");
+
+  typedef T stored;
+  typedef const T& view_type;
+
+  static stored store(const T& item, std::string&) {return item;}
+  static view_type view(const stored& s, const char*) {return s;}
+};
+
+
+template<>
+struct FrozenField<std::string>
+{
+  struct stored {
+    uint64_t offset;  // start in the string area
+    uint64_t length;  // number of characters
+  };
+  typedef std::string_view view_type;
+
+  static stored store(const std::string& item, std::string& area)
+  {
+    stored s = {area.size(), item.size()};
+    area += item;
+    return s;
+  }
+
+  static view_type view(const stored& s, const char* area)
+  {
+    return std::string_view(area + s.offset, s.length);
+  }
+};
+
+
+template<typename K, typename V, typename Compare = ThreeWayCompare<K>>
+class FrozenIndex
+{
+public:
+
+  // create an index with nothing mapped (size 0)
+  FrozenIndex();
+
+  // move constructor and assignment (an index owns its mapping, so it
+  // can't be copied)
+  FrozenIndex(FrozenIndex<K,V,Compare>&& rhs);
+  FrozenIndex<K,V,Compare>& operator=(FrozenIndex<K,V,Compare>&& rhs);
+  FrozenIndex(const FrozenIndex<K,V,Compare>& rhs) = delete;
+  FrozenIndex<K,V,Compare>& operator=(const FrozenIndex<K,V,Compare>& rhs) = delete;
+
+  // unmap the file
+  ~FrozenIndex();
+
+  // write the pairs of the collection to an index file (the keys from
+  // its sort must be in ascending order under Compare); returns false
+  // if they aren't or the file can't be written
+  static bool freeze(const Collection<K,V>& collection, const std::string& path);
+
+  // map an index file written by freeze, replacing any mapped index;
+  // returns false (leaving nothing mapped) if the file can't be mapped
+  // or isn't a valid index for these key and value types
+  bool open(const std::string& path);
+
+  // unmap the index
+  void close();
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // find using any key-like type that compares against K (e.g., a
+  // std::string_view for string keys)
+  template<typename Q>
+  bool find(const Q& search_key, V& the_val) const;
+
+  // find and return each key >= k1 and <= k2 (in ascending order)
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // call visit(key, value) on each pair with k1 <= key <= k2 in
+  // ascending key order, stopping early if visit returns false (keys
+  // and values are views into the mapped file)
+  template<typename Visit>
+  void scan(const K& k1, const K& k2, Visit visit) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the index
+  size_t size() const;
+
+private:
+
+  typedef FrozenField<K> KeyField;
+  typedef FrozenField<V> ValueField;
+  typedef typename KeyField::stored StoredKey;
+  typedef typename ValueField::stored StoredValue;
+
+  // file header (each section starts on a cache line)
+  struct Header {
+    char magic[8];
+    uint64_t count;        // number of pairs
+    uint64_t key_size;     // sizeof(StoredKey), to catch type mismatches
+    uint64_t value_size;   // sizeof(StoredValue)
+    uint64_t keys_offset;  // count+1 keys in Eytzinger order (slot 0 unused)
+    uint64_t values_offset;  // count+1 values in the same order
+    uint64_t area_offset;  // string area
+    uint64_t file_size;
+  };
+
+  static constexpr char MAGIC[8] = {'F', 'R', 'Z', 'I', 'D', 'X', '1', '\0'};
+  static const uint64_t LINE = 64;  // section alignment
+
+  // mapped file (nullptr if none)
+  const char* image;
+  size_t image_size;
+
+  // sections of the mapped file
+  const StoredKey* key_slots;
+  const StoredValue* value_slots;
+  const char* area;
+  size_t count;
+
+  // three-way compare of two keys using the comparison policy
+  template<typename A, typename B>
+  static int compare(const A& a, const B& b) {return Compare()(a, b);}
+
+  // helper for the key and value in a slot
+  typename KeyField::view_type key_at(size_t i) const;
+  typename ValueField::view_type value_at(size_t i) const;
+
+  // helper to find the slot of the first key >= search_key (0 if none)
+  template<typename Q>
+  size_t lower_bound(const Q& search_key) const;
+
+  // helper to find the slot after slot i in key order (0 after the last)
+  size_t next(size_t i) const;
+
+  // helper to find the slot of the smallest key (0 if empty)
+  size_t first() const;
+
+  // helper to place the sorted pairs into Eytzinger order
+  static void layout(size_t i, size_t n, const ArrayList<K>& sorted,
+                     const Collection<K,V>& collection, size_t& pos,
+                     std::vector<StoredKey>& keys,
+                     std::vector<StoredValue>& values, std::string& area);
+
+  // helper to round an offset up to the next cache line
+  static uint64_t align(uint64_t offset);
+};
+
+
+template<typename K, typename V, typename C>
+FrozenIndex<K,V,C>::FrozenIndex()
+  : image(nullptr), image_size(0), key_slots(nullptr), value_slots(nullptr),
+    area(nullptr), count(0)
+{
+}
+
+template<typename K, typename V, typename C>
+FrozenIndex<K,V,C>::FrozenIndex(FrozenIndex<K,V,C>&& rhs)
+  : image(nullptr), image_size(0), key_slots(nullptr), value_slots(nullptr),
+    area(nullptr), count(0)
+{
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V, typename C>
+FrozenIndex<K,V,C>& FrozenIndex<K,V,C>::operator=(FrozenIndex<K,V,C>&& rhs)
+{
+  if(this != &rhs){
+    close();
+    // take the rhs mapping, leaving rhs with nothing mapped
+    image = rhs.image;
+    image_size = rhs.image_size;
+    key_slots = rhs.key_slots;
+    value_slots = rhs.value_slots;
+    area = rhs.area;
+    count = rhs.count;
+    rhs.image = nullptr;
+    rhs.close();
+  }
+  return *this;
+}
+
+template<typename K, typename V, typename C>
+FrozenIndex<K,V,C>::~FrozenIndex()
+{
+  close();
+}
+
+//  Function: freeze()
+//  Description: Writes the pairs of a collection to an index file: a
+//  header, then the keys and the values in Eytzinger order, then the
+//  string area. The keys come from the collection's sort and the
+//  values from its find.
+//  Inputs: Collection to freeze, path of the file to write
+//  Outputs: True if the whole file was written
+template<typename K, typename V, typename C>
+bool FrozenIndex<K,V,C>::freeze(const Collection<K,V>& collection,
+                                const std::string& path)
+{
+  ArrayList<K> sorted;
+  collection.sort(sorted);
+  size_t n = sorted.size();
+  for(size_t i = 1; i < n; ++i)
+    if(compare(sorted[i - 1], sorted[i]) >= 0) return false;
+
+  // slot 0 is unused, so the children of slot i are 2i and 2i+1
+  std::vector<StoredKey> keys(n + 1);
+  std::vector<StoredValue> vals(n + 1);
+  std::string strings;
+  size_t pos = 0;
+  layout(1, n, sorted, collection, pos, keys, vals, strings);
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.count = n;
+  header.key_size = sizeof(StoredKey);
+  header.value_size = sizeof(StoredValue);
+  header.keys_offset = align(sizeof(Header));
+  header.values_offset = align(header.keys_offset + (n + 1) * sizeof(StoredKey));
+  header.area_offset = align(header.values_offset + (n + 1) * sizeof(StoredValue));
+  header.file_size = header.area_offset + strings.size();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if(!out) return false;
+  const char zeros[LINE] = {};
+  uint64_t written = 0;
+  // helper to write bytes, padding up to the given offset first
+  auto put = [&](uint64_t offset, const void* data, uint64_t bytes){
+    out.write(zeros, offset - written);
+    out.write(static_cast<const char*>(data), bytes);
+    written = offset + bytes;
+  };
+  put(0, &header, sizeof(header));
+  put(header.keys_offset, &keys[0], (n + 1) * sizeof(StoredKey));
+  put(header.values_offset, &vals[0], (n + 1) * sizeof(StoredValue));
+  put(header.area_offset, strings.data(), strings.size());
+  out.flush();
+  return bool(out);
+}
+
+//  Function: open()
+//  Description: Maps an index file read-only and checks its header. No
+//  pairs are read or copied, so this takes O(1) time.
+//  Inputs: Path of the index file
+//  Outputs: True if the file was mapped
+template<typename K, typename V, typename C>
+bool FrozenIndex<K,V,C>::open(const std::string& path)
+{
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+  struct stat info;
+  if(fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(Header)){
+    ::close(fd);
+    return false;
+  }
+  size_t bytes = info.st_size;
+  void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);  // the mapping keeps the file open
+  if(mapped == MAP_FAILED) return false;
+  image = static_cast<const char*>(mapped);
+  image_size = bytes;
+
+  // check that the header matches these types and the sections fit
+  const Header* header = reinterpret_cast<const Header*>(image);
+  uint64_t n = header->count;
+  bool ok = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+    && header->key_size == sizeof(StoredKey)
+    && header->value_size == sizeof(StoredValue)
+    && header->file_size == bytes
+    && n < bytes
+    && header->keys_offset % LINE == 0 && header->values_offset % LINE == 0
+    && header->keys_offset + (n + 1) * sizeof(StoredKey) <= header->values_offset
+    && header->values_offset + (n + 1) * sizeof(StoredValue) <= header->area_offset
+    && header->area_offset <= bytes;
+  if(!ok){
+    close();
+    return false;
+  }
+  key_slots = reinterpret_cast<const StoredKey*>(image + header->keys_offset);
+  value_slots = reinterpret_cast<const StoredValue*>(image + header->values_offset);
+  area = image + header->area_offset;
+  count = n;
+  return true;
+}
+
+//  Function: close()
+//  Description: Unmaps the index file
+//  Inputs: None
+//  Outputs: None
+template<typename K, typename V, typename C>
+void FrozenIndex<K,V,C>::close()
+{
+  if(image) munmap(const_cast<char*>(image), image_size);
+  image = nullptr;
+  image_size = 0;
+  key_slots = nullptr;
+  value_slots = nullptr;
+  area = nullptr;
+  count = 0;
+}
+
+//  Function: find()
+//  Description: Finds the value associated with the given key
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key, whether or not the key was found
+template<typename K, typename V, typename C>
+bool FrozenIndex<K,V,C>::find(const K& search_key, V& the_val) const
+{
+  return find<K>(search_key, the_val);
+}
+
+//  Function: find()
+//  Description: Finds the value associated with a key-like search key
+//  by an Eytzinger search of the mapped keys
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key, whether or not the key was found
+template<typename K, typename V, typename C>
+template<typename Q>
+bool FrozenIndex<K,V,C>::find(const Q& search_key, V& the_val) const
+{
+  size_t i = lower_bound(search_key);
+  if(!i || compare(key_at(i), search_key) != 0) return false;
+  the_val = V(value_at(i));
+  return true;
+}
+
+//  Function: find()
+//  Description: Finds and returns all keys between the given k1 and k2 keys
+//  Inputs: Given key "limits"
+//  Outputs: All keys between the given "limits"
+template<typename K, typename V, typename C>
+void FrozenIndex<K,V,C>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  scan(k1, k2, [&](typename KeyField::view_type k, typename ValueField::view_type){
+    keys.add(K(k));
+    return true;
+  });
+}
+
+//  Function: scan()
+//  Description: Visits the pairs in a range of keys in ascending order,
+//  starting at the first key >= k1 and stepping through the slots in
+//  key order
+//  Inputs: Smallest and largest key of the range, visitor function
+//  Outputs: None
+template<typename K, typename V, typename C>
+template<typename Visit>
+void FrozenIndex<K,V,C>::scan(const K& k1, const K& k2, Visit visit) const
+{
+  for(size_t i = lower_bound(k1); i && compare(key_at(i), k2) <= 0; i = next(i))
+    if(!visit(key_at(i), value_at(i))) return;
+}
+
+//  Function: sort()
+//  Description: Returns all keys in ascending order
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename C>
+void FrozenIndex<K,V,C>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  for(size_t i = first(); i; i = next(i))
+    all_keys_sorted.add(K(key_at(i)));
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs in the index
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename C>
+size_t FrozenIndex<K,V,C>::size() const
+{
+  return count;
+}
+
+// helper function for the key in a slot
+template<typename K, typename V, typename C>
+typename FrozenField<K>::view_type FrozenIndex<K,V,C>::key_at(size_t i) const
+{
+  return KeyField::view(key_slots[i], area);
+}
+
+// helper function for the value in a slot
+template<typename K, typename V, typename C>
+typename FrozenField<V>::view_type FrozenIndex<K,V,C>::value_at(size_t i) const
+{
+  return ValueField::view(value_slots[i], area);
+}
+
+// helper function for find and scan
+template<typename K, typename V, typename C>
+template<typename Q>
+size_t FrozenIndex<K,V,C>::lower_bound(const Q& search_key) const
+{
+  // go right past smaller keys and left otherwise, to a slot past the
+  // bottom of the tree
+  size_t i = 1;
+  while(i <= count)
+    i = 2 * i + (compare(key_at(i), search_key) < 0);
+  // the answer is where the path last went left: drop the trailing
+  // right steps (1 bits) and then that left step
+  while(i & 1) i >>= 1;
+  return i >> 1;
+}
+
+// helper function for scan and sort
+template<typename K, typename V, typename C>
+size_t FrozenIndex<K,V,C>::next(size_t i) const
+{
+  // smallest key of the right subtree
+  if(2 * i + 1 <= count){
+    i = 2 * i + 1;
+    while(2 * i <= count) i = 2 * i;
+    return i;
+  }
+  // otherwise the first ancestor reached from its left subtree
+  while(i & 1) i >>= 1;
+  return i >> 1;
+}
+
+// helper function for sort
+template<typename K, typename V, typename C>
+size_t FrozenIndex<K,V,C>::first() const
+{
+  if(count == 0) return 0;
+  size_t i = 1;
+  while(2 * i <= count) i = 2 * i;
+  return i;
+}
+
+// helper function for freeze (an in-order walk of the slots hands out
+// the sorted keys in order)
+template<typename K, typename V, typename C>
+void FrozenIndex<K,V,C>::layout(size_t i, size_t n, const ArrayList<K>& sorted,
+                                const Collection<K,V>& collection, size_t& pos,
+                                std::vector<StoredKey>& keys,
+                                std::vector<StoredValue>& values, std::string& area)
+{
+  if(i > n) return;
+  layout(2 * i, n, sorted, collection, pos, keys, values, area);
+  V val = V();
+  collection.find(sorted[pos], val);
+  keys[i] = KeyField::store(sorted[pos], area);
+  values[i] = ValueField::store(val, area);
+  ++pos;
+  layout(2 * i + 1, n, sorted, collection, pos, keys, values, area);
+}
+
+// helper function for freeze
+template<typename K, typename V, typename C>
+uint64_t FrozenIndex<K,V,C>::align(uint64_t offset)
+{
+  return (offset + LINE - 1) / LINE * LINE;
+}
+
+
+#endif
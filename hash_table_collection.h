@@ -12,6 +12,23 @@
 #include "collection.h"
 #include "array_list.h"
 #include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// hash function for the keys of a hash table, specialized for strings
+// so that string_view and const char* lookup keys hash the same as the
+// equal std::string without being copied into one
+template<typename K>
+struct KeyHash {
+  size_t operator()(const K& key) const {return std::hash<K>()(key);}
+};
+
+template<>
+struct KeyHash<std::string> {
+  size_t operator()(std::string_view key) const
+  {return std::hash<std::string_view>()(key);}
+};
 
 template<typename K, typename V>
 class HashTableCollection : public Collection<K,V>
@@ -19,16 +36,28 @@ class HashTableCollection : public Collection<K,V>
   public:
     HashTableCollection();
     HashTableCollection(const HashTableCollection<K,V>& rhs);
+    HashTableCollection(HashTableCollection<K,V>&& rhs);
     ~HashTableCollection();
     HashTableCollection& operator=(const HashTableCollection<K,V>& rhs);
+    HashTableCollection& operator=(HashTableCollection<K,V>&& rhs);
 
     void add(const K& key, const V& val);
+    void add(K&& key, V&& val);
+    template<typename KK, typename... Args>
+    void emplace(KK&& key, Args&&... args);
     void remove(const K& key);
     bool find(const K& search_key, V& return_val) const;
+    V& find_or_insert(const K& key);
+    bool insert_or_assign(const K& key, const V& val);
+    V* find_ptr(const K& key);
+    const V* find_ptr(const K& key) const;
+    template<typename Q>
+    bool find(const Q& search_key, V& return_val) const; // any key-like type
     void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
     void keys(ArrayList<K>& all_keys) const;
     void sort(ArrayList<K>& all_keys_sorted) const;
     size_t size() const;
+    size_t memory_usage() const;
 
     size_t min_chain_length();
     size_t max_chain_length();
@@ -39,9 +68,16 @@ class HashTableCollection : public Collection<K,V>
       K key;
       V value;
       Node* next;
+
+      Node() {}
+      // builds the key and value in place for a new chain entry
+      template<typename KK, typename... Args>
+      Node(KK&& k, Args&&... args)
+        : key(std::forward<KK>(k)), value(std::forward<Args>(args)...),
+          next(nullptr) {}
     };
 
-    std::hash<K> hash_fcn;  // declare hash function for the hash table
+    KeyHash<K> hash_fcn;  // declare hash function for the hash table
 
     Node** hash_table;
     size_t length; // number of pairs in the collection
@@ -50,6 +86,12 @@ class HashTableCollection : public Collection<K,V>
 
     void resize_and_rehash();
     void make_empty();
+    // finds the Node holding key in the chain at index (nullptr if none)
+    Node* find_node(const K& key, size_t index) const;
+    // adds a new Node to the front of the chain at index
+    void link(Node* tmp, size_t index);
+    // gives a moved-from table a fresh set of empty buckets
+    void reset_buckets();
 };
 
 template<typename K, typename V>
@@ -70,10 +112,19 @@ HashTableCollection<K,V>::HashTableCollection(const HashTableCollection<K,V>& rh
   *this = rhs;
 }
 
+template<typename K, typename V>
+HashTableCollection<K,V>::HashTableCollection(HashTableCollection<K,V>&& rhs)
+  : hash_table(rhs.hash_table), length(rhs.length), capacity(rhs.capacity)
+{
+  // take the rhs buckets, leaving rhs empty
+  rhs.reset_buckets();
+}
+
 template<typename K, typename V>
 HashTableCollection<K,V>::~HashTableCollection()
 {
   make_empty();
+  delete[] hash_table;
 }
 
 template<typename K, typename V>
@@ -82,6 +133,7 @@ operator=(const HashTableCollection<K,V>& rhs)
 {
   if(this != &rhs){
     make_empty();
+    delete[] hash_table;
     capacity = rhs.capacity;  // copy the rhs capacity to the lhs
     length = rhs.length;  // copy the rhs length to the lhs
     hash_table = new Node*[capacity]; // create a new hash table for the lhs
@@ -103,28 +155,110 @@ operator=(const HashTableCollection<K,V>& rhs)
   return *this;
 }
 
+template<typename K, typename V>
+HashTableCollection<K,V>& HashTableCollection<K,V>::
+operator=(HashTableCollection<K,V>&& rhs)
+{
+  if(this != &rhs){
+    make_empty();
+    delete[] hash_table;
+    // take the rhs buckets, leaving rhs empty
+    hash_table = rhs.hash_table;
+    length = rhs.length;
+    capacity = rhs.capacity;
+    rhs.reset_buckets();
+  }
+  return *this;
+}
+
 //  Function: add()
 //  Description: Adds a new key-value pair to the collection in the correct hashed location
 //  Inputs: Key and value to be added to the collection
 //  Outputs: None
 template<typename K, typename V>
 void HashTableCollection<K,V>::add(const K& key, const V& val)
+{
+  emplace(key, val);
+}
+
+//  Function: add()
+//  Description: Adds a new key-value pair to the collection, moving the key
+//  and value into the new Node instead of copying them
+//  Inputs: Key and value to be added to the collection
+//  Outputs: None
+template<typename K, typename V>
+void HashTableCollection<K,V>::add(K&& key, V&& val)
+{
+  emplace(std::move(key), std::move(val));
+}
+
+//  Function: emplace()
+//  Description: Adds a new key-value pair to the collection, building the
+//  key and value in place inside the new Node
+//  Inputs: Key (or argument for the key) and the arguments for the value
+//  Outputs: None
+template<typename K, typename V>
+template<typename KK, typename... Args>
+void HashTableCollection<K,V>::emplace(KK&& key, Args&&... args)
 {
   // creating Node to be added at index
-  Node* tmp = new Node;
-  tmp->key = key;
-  tmp->value = val;
-  tmp->next = nullptr;
+  Node* tmp = new Node(std::forward<KK>(key), std::forward<Args>(args)...);
   // find the index to add the new Node in the hash table
-  size_t code = hash_fcn(key);
-  size_t index = code % capacity;
-  // add the Node to the end of the chain at the found index
-  tmp->next = hash_table[index];
-  hash_table[index] = tmp;
-  length++; // increment the length variable
-  // check load factor and resize and rehash (if necessary)
-  double load_factor = (length*1.0) / capacity;
-  if(load_factor >= load_factor_threshold) resize_and_rehash();
+  size_t code = hash_fcn(tmp->key);
+  link(tmp, code % capacity);
+}
+
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value if it is not found (one hash and one
+//  chain walk either way)
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V>
+V& HashTableCollection<K,V>::find_or_insert(const K& key)
+{
+  size_t index = hash_fcn(key) % capacity;
+  Node* cur = find_node(key, index);
+  if(cur) return cur->value;
+  Node* tmp = new Node(key);
+  link(tmp, index);
+  return tmp->value; // the Node itself does not move when rehashed
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the collection
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V>
+bool HashTableCollection<K,V>::insert_or_assign(const K& key, const V& val)
+{
+  size_t index = hash_fcn(key) % capacity;
+  Node* cur = find_node(key, index);
+  if(cur){
+    cur->value = val;
+    return false;
+  }
+  link(new Node(key, val), index);
+  return true;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V>
+V* HashTableCollection<K,V>::find_ptr(const K& key)
+{
+  Node* cur = find_node(key, hash_fcn(key) % capacity);
+  return cur ? &cur->value : nullptr;
+}
+
+template<typename K, typename V>
+const V* HashTableCollection<K,V>::find_ptr(const K& key) const
+{
+  Node* cur = find_node(key, hash_fcn(key) % capacity);
+  return cur ? &cur->value : nullptr;
 }
 
 //  Function: remove()
@@ -154,7 +288,8 @@ void HashTableCollection<K,V>::remove(const K& key)
           prev->next = cur->next;
           delete cur;
           --length;
-       }
+          return; // keys are unique (and cur is gone)
+        }
         prev = prev->next;
         cur = cur->next;
       }
@@ -169,6 +304,18 @@ void HashTableCollection<K,V>::remove(const K& key)
 //  Outputs: Value associated with the key
 template<typename K, typename V>
 bool HashTableCollection<K,V>::find(const K& search_key, V& return_val) const
+{
+  return find<K>(search_key, return_val);
+}
+
+//  Function: find()
+//  Description: Finds the value associated with a key-like search key (one
+//  that hashes like and compares equal to the matching key)
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key
+template<typename K, typename V>
+template<typename Q>
+bool HashTableCollection<K,V>::find(const Q& search_key, V& return_val) const
 {
   if(length <= 0) return false; // cannot find a value in an empty table
   // find the index of the search key according to the hash function
@@ -243,6 +390,22 @@ size_t HashTableCollection<K,V>::size() const
   return length;
 }
 
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection: the bucket
+//  array, one chain node per pair, and the keys' and values' dynamic
+//  memory
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V>
+size_t HashTableCollection<K,V>::memory_usage() const
+{
+  size_t bytes = sizeof(*this) + capacity * sizeof(Node*) + length * sizeof(Node);
+  for(size_t i = 0; i < capacity; ++i)
+    for(const Node* ptr = hash_table[i]; ptr; ptr = ptr->next)
+      bytes += DynamicMemory<K>::bytes(ptr->key) + DynamicMemory<V>::bytes(ptr->value);
+  return bytes;
+}
+
 //  Function: min_chain_length()
 //  Description: Returns the length of the smallest chain in the hash table
 //  Inputs: None
@@ -304,33 +467,27 @@ template<typename K, typename V>
 void HashTableCollection<K,V>::resize_and_rehash()
 {
   size_t new_capacity = 2*capacity;  // double the capacity
-  size_t new_length = length;
   Node** new_table = new Node*[new_capacity]; // new list for the items to be rehashed into
   for(int i = 0; i < new_capacity; ++i) new_table[i] = nullptr;
-  std::hash<K> hash_fcn;  // creating a new hash function
   for(int i = 0; i < capacity; ++i){
     Node* cur = hash_table[i];  // temp Node for itreating through each chain
     while(cur){
-      size_t code = hash_fcn(hash_table[i]->key); // creating hash code
+      Node* next = cur->next;
+      size_t code = hash_fcn(cur->key); // creating hash code
       size_t index = code % new_capacity; // finding the index for the new table
 
-      // creating new Node to put into the new table
-      Node* tmp = new Node;
-      tmp->key = cur->key;
-      tmp->value = cur->value;
-
-      // inserting the new node into the front of the chain at index
-      tmp->next = new_table[index];
-      new_table[index] = tmp;
+      // relinking the node into the front of the chain at index (the
+      // key and value stay where they are)
+      cur->next = new_table[index];
+      new_table[index] = cur;
 
       // advance cur
-      cur = cur->next;
+      cur = next;
     }
   }
-  make_empty();
+  delete[] hash_table;
   hash_table = new_table; // point hash_table to new_table
   capacity = new_capacity;  // update capacity
-  length = new_length;
 }
 
 //  Function: make_empty()
@@ -353,4 +510,40 @@ void HashTableCollection<K,V>::make_empty()
   }
   length = 0;
 }
-#endif
\ No newline at end of file
+
+// helper function for the move constructor and move assignment
+template<typename K, typename V>
+void HashTableCollection<K,V>::reset_buckets()
+{
+  capacity = 16;
+  length = 0;
+  hash_table = new Node*[capacity];
+  for(size_t i = 0; i < capacity; ++i){
+    hash_table[i] = nullptr;
+  }
+}
+
+// helper function for find_or_insert, insert_or_assign, and find_ptr
+template<typename K, typename V>
+typename HashTableCollection<K,V>::Node*
+HashTableCollection<K,V>::find_node(const K& key, size_t index) const
+{
+  Node* cur = hash_table[index];
+  while(cur && !(cur->key == key)) cur = cur->next;
+  return cur;
+}
+
+// helper function for emplace, find_or_insert, and insert_or_assign
+template<typename K, typename V>
+void HashTableCollection<K,V>::link(Node* tmp, size_t index)
+{
+  // add the Node to the front of the chain at the given index
+  tmp->next = hash_table[index];
+  hash_table[index] = tmp;
+  length++; // increment the length variable
+  // check load factor and resize and rehash (if necessary)
+  double load_factor = (length*1.0) / capacity;
+  if(load_factor >= load_factor_threshold) resize_and_rehash();
+}
+
+#endif
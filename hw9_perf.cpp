@@ -8,10 +8,30 @@
 // specified by an input test number:
 //     1 = add 
 //     2 = remove
-//     3 = find value
+//     3 = find value (and RBT with ==/< vs three-way compares)
 //     4 = find range
 //     5 = sort
-//     6 = statistics
+//     6 = statistics (tree heights and RBT rebalancing counts)
+//     7 = add/remove churn (RBT node allocators)
+//     8 = bulk load from sorted input (RBT)
+//     9 = merge by repeated add vs set union (RBT, 1-8 threads)
+//    10 = concurrent find-heavy throughput (RBT, 1-N reader threads)
+//    11 = snapshots (RBT deep copy vs persistent RBT)
+//    12 = node layout (RBT vs compact RBT, bytes per pair and find)
+//    13 = monotonic append (RBT add vs add_near with the previous add
+//         as the hint)
+//    14 = batched find (RBT find loop vs find_many, by batch size)
+//    15 = binary save/load (RBT save, load, and reading the file back
+//         with add)
+//    16 = frozen index (startup and find vs a loaded RBT)
+//    17 = durability (RBT add vs logged add by group commit size, and
+//         recovery from the log)
+//    18 = memory footprint (bytes per pair for every implementation)
+//    19 = tree shape (RBT profile pass: shape and time per node)
+//    20 = sorted input (BST degenerated into a list: add, traversals,
+//         copy and delete at full depth)
+//    21 = sharded writes (RBT shards by hash and by range, mixed
+//         workload throughput by shard count)
 // Output consists of average operation times for different sized
 // input lists for both implementations, except for test 6, which
 // prints statistics information.
@@ -25,6 +45,9 @@
 #include <chrono>
 #include <string>
 #include <cassert>
+#include <algorithm>
+#include <thread>
+#include <vector>
 #include "collection.h"
 #include "array_list_collection.h"
 #include "bin_search_collection.h"
@@ -32,6 +55,13 @@
 #include "bst_collection.h"
 #include "avl_collection.h"
 #include "rbt_collection.h"
+#include "bplus_tree_collection.h"
+#include "concurrent_collection.h"
+#include "persistent_rbt_collection.h"
+#include "compact_rbt_collection.h"
+#include "frozen_index.h"
+#include "wal_collection.h"
+#include "sharded_collection.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -39,6 +69,13 @@ using namespace std::chrono;
 // Test generation params
 const int ITERATIONS = 3;       // runs to average
 const int SHUFFLINGS = 3;       // amount of "randomness"
+const int CHURN_OPS = 1000;     // remove/add pairs per churn run
+const int THREAD_OPS = 20000;   // operations per thread (test 10)
+const int WRITE_EVERY = 20;     // every 20th operation writes (test 10)
+const size_t SHARED_SIZE = 100000;  // shared collection size (test 10)
+const size_t LOGGED_OPS = 10000;    // adds per logged run (test 17)
+const int SHARDED_WRITE_EVERY = 2;  // every 2nd operation writes (test 21)
+const size_t MAX_SHARDS = 64;       // largest shard count (test 21)
   
 // Implementation types
 const int ARRAYLIST = 0;
@@ -47,6 +84,21 @@ const int HASHTABLE = 2;
 const int BINSEARCHTREE = 3;
 const int AVLSEARCHTREE = 4;
 const int RBTSEARCHTREE = 5;
+const int BPLUSTREE = 6;
+const int RBTTWOWAY = 7;    // RBT comparing keys with == and then <
+const int COMPACTRBT = 8;
+const int PERSISTENTRBT = 9;
+
+// compare policy doing an == test and then a < test per node (how the
+// tree collections compared keys before three-way compares)
+struct TwoWayCompare {
+  int operator()(const string& a, const string& b) const
+  {
+    if (a == b)
+      return 0;
+    return (a < b) ? -1 : 1;
+  }
+};
 
 // Helper functions: 
 unsigned long sum(unsigned long array[], size_t n);
@@ -59,8 +111,36 @@ double add(pair<string,int> array[], size_t size, int type);
 double remove(pair<string,int> array[], size_t size, int type);
 double find_value(pair<string,int> array[], size_t size, int type);
 double find_range(pair<string,int> array[], size_t size, int type);
+double count_range(pair<string,int> array[], size_t size);
 double sort(pair<string,int> array[], size_t size, int type);
 size_t stats(pair<string,int> array[], size_t size, int type);
+void rebalance_stats(pair<string,int> array[], size_t size,
+                     RBTStats& add_stats, RBTStats& remove_stats);
+template<template<typename> class Alloc>
+double churn(pair<string,int> array[], size_t size, double& allocs_per_op);
+double load(pair<string,int> array[], size_t size, bool bulk);
+double merge(pair<string,int> array[], size_t size, size_t threads);
+template<typename Lock>
+double throughput(pair<string,int> array[], size_t threads);
+double snapshot(pair<string,int> array[], size_t size, bool persistent);
+double snapshot_write(pair<string,int> array[], size_t size, double& allocs_per_op);
+template<typename Coll>
+double layout(pair<string,int> array[], size_t size, double& bytes_per_pair);
+double append(pair<string,int> array[], size_t size, bool hinted);
+double batch_find(const RBTCollection<string,int>& collection,
+                  pair<string,int> array[], size_t size, size_t batch,
+                  bool batched);
+double save_load(pair<string,int> array[], size_t size, int mode);
+double frozen(pair<string,int> array[], size_t size, bool mapped,
+              double& find_time);
+double durable(pair<string,int> array[], size_t group_size,
+               double& recover_time);
+double footprint(pair<string,int> array[], size_t size, int type);
+double profile(pair<string,int> array[], size_t size, RBTShape& shape);
+void sorted_input(pair<string,int> array[], size_t size, double times[]);
+template<typename Partition>
+double sharded(pair<string,int> array[], const Partition& partition,
+               size_t threads);
 
 
 // Test driver:
@@ -69,7 +149,7 @@ int main(int argc, char* argv[])
 
   // check command line args
   if (argc != 2) {
-    cerr << "usage: " << argv[0] << " test-number (1-6)" << endl;
+    cerr << "usage: " << argv[0] << " test-number (1-21)" << endl;
     exit(1);
   }
   string test_number = argv[1];
@@ -92,16 +172,19 @@ int main(int argc, char* argv[])
          << "# Column 2 = Avg time for HashTableCollection add function\n"
          << "# Column 3 = Avg time for AVLCollection add function\n"
          << "# Column 4 = Avg time for RBTCollection add function\n"
+         << "# Column 5 = Avg time for BPlusTreeCollection add function\n"
          << "# All times are measured in milliseconds" << endl;
     int i = 0;
     for (size_t size = START; size <= STOP; size += STEP) {
       double avg1 = add(array, size, HASHTABLE);
       double avg2 = add(array, size, AVLSEARCHTREE);
       double avg3 = add(array, size, RBTSEARCHTREE);
+      double avg4 = add(array, size, BPLUSTREE);
       cout << size << " "
            << (avg1/1000.0) << " "
            << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << endl;
     }
   }
   // test 2: remove operation
@@ -110,15 +193,18 @@ int main(int argc, char* argv[])
          << "# Column 2 = Avg time for HashTableCollection remove function\n"
          << "# Column 3 = Avg time for AVLCollection remove function\n"
          << "# Column 4 = Avg time for RBTCollection remove function\n"
+         << "# Column 5 = Avg time for BPlusTreeCollection remove function\n"
          << "# All times are measured in microseconds" << endl;
     for (size_t size = START; size <= STOP; size += STEP) {
       double avg1 = remove(array, size, HASHTABLE);
       double avg2 = remove(array, size, AVLSEARCHTREE);
       double avg3 = remove(array, size, RBTSEARCHTREE);      
+      double avg4 = remove(array, size, BPLUSTREE);
       cout << size << " "
            << (avg1/1000.0) << " "
            << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << endl;
     }
   }
   // test 3: find-value operation
@@ -130,15 +216,21 @@ int main(int argc, char* argv[])
          << "# Column 2 = Avg time for HashTableCollection find-value function\n"
          << "# Column 3 = Avg time for AVLCollection find-value function\n"
          << "# Column 4 = Avg time for RBTCollection find-value function\n"
+         << "# Column 5 = Avg time for BPlusTreeCollection find-value function\n"
+         << "# Column 6 = Avg time for RBTCollection find-value function (== and < compares)\n"
          << "# All times are measured in microseconds" << endl;
     for (size_t size = START; size <= STOP; size += STEP) {
       double avg1 = find_value(array, size, HASHTABLE);
       double avg2 = find_value(array, size, AVLSEARCHTREE);
       double avg3 = find_value(array, size, RBTSEARCHTREE);
+      double avg4 = find_value(array, size, BPLUSTREE);
+      double avg5 = find_value(array, size, RBTTWOWAY);
       cout << size << " "
            << (avg1/1000.0) << " "
            << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;        
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << " "
+           << (avg5/1000.0) << endl;        
     }
   }
   // test 4: find-range operation
@@ -147,15 +239,21 @@ int main(int argc, char* argv[])
          << "# Column 2 = Avg time for HashTableCollection find-range function\n"
          << "# Column 3 = Avg time for AVLCollection find-range function\n"
          << "# Column 4 = Avg time for RBTCollection find-range function\n"
+         << "# Column 5 = Avg time for BPlusTreeCollection find-range function\n"
+         << "# Column 6 = Avg time for RBTCollection count (range) function\n"
          << "# All times are measured in microseconds" << endl;
     for (size_t size = START; size <= STOP; size += STEP) {
       double avg1 = find_range(array, size, HASHTABLE);
       double avg2 = find_range(array, size, AVLSEARCHTREE);
       double avg3 = find_range(array, size, RBTSEARCHTREE);
+      double avg4 = find_range(array, size, BPLUSTREE);
+      double avg5 = count_range(array, size);
       cout << size << " "
            << (avg1/1000.0) << " "
            << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << " "
+           << (avg5/1000.0) << endl;
     }
   }
   // test 5: sort operation
@@ -164,28 +262,345 @@ int main(int argc, char* argv[])
          << "# Column 2 = Avg time for HashTableCollection sort function\n"
          << "# Column 3 = Avg time for AVLCollection sort function\n"
          << "# Column 4 = Avg time for RBTCollection sort function\n"
+         << "# Column 5 = Avg time for BPlusTreeCollection sort function\n"
          << "# All times are measured in microseconds" << endl;
     for (size_t size = START; size <= STOP; size += STEP) {
       double avg1 = sort(array, size, HASHTABLE);
       double avg2 = sort(array, size, AVLSEARCHTREE);
       double avg3 = sort(array, size, RBTSEARCHTREE);
+      double avg4 = sort(array, size, BPLUSTREE);
       cout << size << " "
            << (avg1/1000.0) << " "
            << (avg2/1000.0) << " "
-           << (avg3/1000.0) << endl;
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << endl;
     }
   }
   // test 6: statistics information
   else if (test_number.compare("6") == 0) {
     cout << "# Column 1 = Input data size\n" 
          << "# Column 2 = Height for AVLCollection\n"
-         << "# Column 3 = Height for RBTCollection" << endl;
+         << "# Column 3 = Height for RBTCollection\n"
+         << "# Column 4 = Height for BPlusTreeCollection\n"
+         << "# Column 5 = RBTCollection nodes visited per add\n"
+         << "# Column 6 = RBTCollection color flips per add\n"
+         << "# Column 7 = RBTCollection single rotations per add\n"
+         << "# Column 8 = RBTCollection double rotations per add\n"
+         << "# Column 9 = RBTCollection nodes visited per remove\n"
+         << "# Column 10 = RBTCollection color flips per remove\n"
+         << "# Column 11 = RBTCollection single rotations per remove\n"
+         << "# Column 12 = RBTCollection double rotations per remove\n"
+         << "# Column 13 = RBTCollection successor steps per remove" << endl;
     for (size_t size = START; size <= STOP; size += STEP) {
       size_t height1 = stats(array, size, AVLSEARCHTREE);
       size_t height2 = stats(array, size, RBTSEARCHTREE);
+      size_t height3 = stats(array, size, BPLUSTREE);
+      RBTStats adds, removes;
+      rebalance_stats(array, size, adds, removes);
+      // per-operation averages (0 for the empty tree)
+      double n_adds = max<size_t>(adds.adds, 1);
+      double n_removes = max<size_t>(removes.removes, 1);
       cout << size << " "
            << height1 << " " 
-           << height2 << endl;
+           << height2 << " "
+           << height3 << " "
+           << adds.nodes_visited / n_adds << " "
+           << adds.color_flips / n_adds << " "
+           << adds.single_rotations / n_adds << " "
+           << adds.double_rotations / n_adds << " "
+           << removes.nodes_visited / n_removes << " "
+           << removes.color_flips / n_removes << " "
+           << removes.single_rotations / n_removes << " "
+           << removes.double_rotations / n_removes << " "
+           << removes.successor_steps / n_removes << endl;
+    }
+  }
+  // test 7: add/remove churn with each RBT node allocator
+  else if (test_number.compare("7") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time for RBTCollection (HeapAllocator) remove+add\n"
+         << "# Column 3 = Avg time for RBTCollection (SlabAllocator) remove+add\n"
+         << "# Column 4 = Allocations per remove+add (HeapAllocator)\n"
+         << "# Column 5 = Allocations per remove+add (SlabAllocator)\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double allocs1 = 0, allocs2 = 0;
+      double avg1 = churn<HeapAllocator>(array, size, allocs1);
+      double avg2 = churn<SlabAllocator>(array, size, allocs2);
+      cout << size << " "
+           << (avg1/1000.0) << " "
+           << (avg2/1000.0) << " "
+           << allocs1 << " "
+           << allocs2 << endl;
+    }
+  }
+  // test 8: load a tree from sorted input
+  else if (test_number.compare("8") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Time to load RBTCollection by repeated add\n"
+         << "# Column 3 = Time to load RBTCollection by bulk build\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double avg1 = load(array, size, false);
+      double avg2 = load(array, size, true);
+      cout << size << " "
+           << (avg1/1000.0) << " "
+           << (avg2/1000.0) << endl;
+    }
+  }
+  // test 9: merge two trees
+  else if (test_number.compare("9") == 0) {
+    cout << "# Column 1 = Input data size (total of both trees)\n"
+         << "# Column 2 = Time to merge RBTCollections by repeated add\n"
+         << "# Column 3 = Time to merge RBTCollections by set_union (1 thread)\n"
+         << "# Column 4 = Time to merge RBTCollections by set_union (2 threads)\n"
+         << "# Column 5 = Time to merge RBTCollections by set_union (4 threads)\n"
+         << "# Column 6 = Time to merge RBTCollections by set_union (8 threads)\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double avg1 = merge(array, size, 0);
+      double avg2 = merge(array, size, 1);
+      double avg3 = merge(array, size, 2);
+      double avg4 = merge(array, size, 4);
+      double avg5 = merge(array, size, 8);
+      cout << size << " "
+           << (avg1/1000.0) << " "
+           << (avg2/1000.0) << " "
+           << (avg3/1000.0) << " "
+           << (avg4/1000.0) << " "
+           << (avg5/1000.0) << endl;
+    }
+  }
+  // test 10: concurrent readers with occasional writers
+  else if (test_number.compare("10") == 0) {
+    size_t cores = thread::hardware_concurrency();
+    if (cores == 0)
+      cores = 1;
+    cout << "# Column 1 = Number of threads (1 in " << WRITE_EVERY
+         << " operations is a remove+add)\n"
+         << "# Column 2 = Throughput for ConcurrentCollection (ExclusiveLock)\n"
+         << "# Column 3 = Throughput for ConcurrentCollection (RWLock)\n"
+         << "# Throughput is measured in operations per millisecond" << endl;
+    // double the threads up to the number of cores
+    for (size_t threads = 1; ; threads = min(threads * 2, cores)) {
+      double ops1 = throughput<ExclusiveLock>(array, threads);
+      double ops2 = throughput<RWLock>(array, threads);
+      cout << threads << " " << ops1 << " " << ops2 << endl;
+      if (threads == cores)
+        break;
+    }
+  }
+  // test 11: taking snapshots
+  else if (test_number.compare("11") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time to copy an RBTCollection\n"
+         << "# Column 3 = Avg time to snapshot a PersistentRBTCollection\n"
+         << "# Column 4 = Avg time for PersistentRBTCollection add after a snapshot\n"
+         << "# Column 5 = Nodes allocated per add after a snapshot\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double avg1 = snapshot(array, size, false);
+      double avg2 = snapshot(array, size, true);
+      double allocs = 0;
+      double avg3 = snapshot_write(array, size, allocs);
+      cout << size << " "
+           << avg1 << " "
+           << avg2 << " "
+           << (avg3/1000.0) << " "
+           << allocs << endl;
+    }
+  }
+  // test 12: node layout with small (int) keys and values
+  else if (test_number.compare("12") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Bytes per pair for RBTCollection<int,int>\n"
+         << "# Column 3 = Bytes per pair for CompactRBTCollection<int,int>\n"
+         << "# Column 4 = Avg time for RBTCollection<int,int> find-value function\n"
+         << "# Column 5 = Avg time for CompactRBTCollection<int,int> find-value function\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double bytes1 = 0, bytes2 = 0;
+      double avg1 = layout<RBTCollection<int,int>>(array, size, bytes1);
+      double avg2 = layout<CompactRBTCollection<int,int>>(array, size, bytes2);
+      cout << size << " "
+           << bytes1 << " "
+           << bytes2 << " "
+           << (avg1/1000.0) << " "
+           << (avg2/1000.0) << endl;
+    }
+  }
+  // test 13: adding keys in ascending order
+  else if (test_number.compare("13") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Time to append to RBTCollection by add\n"
+         << "# Column 3 = Time to append to RBTCollection by add_near\n"
+         << "# All times are measured in milliseconds" << endl;
+    for (size_t size = START; size <= STOP; size += STEP) {
+      double avg1 = append(array, size, false);
+      double avg2 = append(array, size, true);
+      cout << size << " "
+           << (avg1/1000.0) << " "
+           << (avg2/1000.0) << endl;
+    }
+  }
+  // test 14: batched multi-key find
+  else if (test_number.compare("14") == 0) {
+    cout << "# Column 1 = Batch size (keys per request, " << STOP
+         << " pairs in the tree)\n"
+         << "# Column 2 = Avg time per key for RBTCollection find loop\n"
+         << "# Column 3 = Avg time per key for RBTCollection find_many\n"
+         << "# All times are measured in nanoseconds" << endl;
+    RBTCollection<string,int> collection;
+    for (size_t i = 0; i < STOP; ++i)
+      collection.add(array[i].first, array[i].second);
+    for (size_t batch = 1; batch <= 1024; batch *= 2) {
+      double avg1 = batch_find(collection, array, STOP, batch, false);
+      double avg2 = batch_find(collection, array, STOP, batch, true);
+      cout << batch << " " << avg1 << " " << avg2 << endl;
+    }
+  }
+  // test 15: saving and loading a tree
+  else if (test_number.compare("15") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Throughput for RBTCollection save\n"
+         << "# Column 3 = Throughput for RBTCollection load\n"
+         << "# Column 4 = Throughput for reading a save and adding each pair\n"
+         << "# Throughput is measured in MB (of file) per second" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double rate1 = save_load(array, size, 0);
+      double rate2 = save_load(array, size, 1);
+      double rate3 = save_load(array, size, 2);
+      cout << size << " "
+           << rate1 << " "
+           << rate2 << " "
+           << rate3 << endl;
+    }
+  }
+  // test 16: opening a frozen index
+  else if (test_number.compare("16") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Avg time to load an RBTCollection save\n"
+         << "# Column 3 = Avg time to open a FrozenIndex\n"
+         << "# Column 4 = Avg time for RBTCollection find-value function\n"
+         << "# Column 5 = Avg time for FrozenIndex find-value function\n"
+         << "# Startup times are in microseconds, find times in nanoseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      double find1 = 0, find2 = 0;
+      double avg1 = frozen(array, size, false, find1);
+      double avg2 = frozen(array, size, true, find2);
+      cout << size << " "
+           << avg1 << " "
+           << avg2 << " "
+           << find1 << " "
+           << find2 << endl;
+    }
+  }
+  // test 17: write-ahead logging
+  else if (test_number.compare("17") == 0) {
+    cout << "# Column 1 = Records per fsync (group commit size)\n"
+         << "# Column 2 = Avg time for RBTCollection add function\n"
+         << "# Column 3 = Avg time for WALCollection add function\n"
+         << "# Column 4 = Avg time per record to recover from the log\n"
+         << "# All times are measured in microseconds, over "
+         << LOGGED_OPS << " adds" << endl;
+    for (size_t group = 1; group <= 1024; group *= 4) {
+      double recover1 = 0, recover2 = 0;
+      double avg1 = durable(array, 0, recover1);
+      double avg2 = durable(array, group, recover2);
+      cout << group << " "
+           << avg1 << " "
+           << avg2 << " "
+           << recover2 << endl;
+    }
+  }
+  // test 18: memory footprint
+  else if (test_number.compare("18") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Bytes per pair for ArrayListCollection\n"
+         << "# Column 3 = Bytes per pair for BinSearchCollection\n"
+         << "# Column 4 = Bytes per pair for HashTableCollection\n"
+         << "# Column 5 = Bytes per pair for BSTCollection\n"
+         << "# Column 6 = Bytes per pair for AVLCollection\n"
+         << "# Column 7 = Bytes per pair for RBTCollection\n"
+         << "# Column 8 = Bytes per pair for BPlusTreeCollection\n"
+         << "# Column 9 = Bytes per pair for CompactRBTCollection\n"
+         << "# Column 10 = Bytes per pair for PersistentRBTCollection\n"
+         << "# Bytes are as reported by memory_usage" << endl;
+    const int types[] = {ARRAYLIST, BINSEARCH, HASHTABLE, BINSEARCHTREE,
+                         AVLSEARCHTREE, RBTSEARCHTREE, BPLUSTREE,
+                         COMPACTRBT, PERSISTENTRBT};
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      cout << size;
+      for (int type : types)
+        cout << " " << footprint(array, size, type);
+      cout << endl;
+    }
+  }
+  // test 19: checking and profiling an RBT in one pass
+  else if (test_number.compare("19") == 0) {
+    cout << "# Column 1 = Input data size\n"
+         << "# Column 2 = Height of the RBTCollection\n"
+         << "# Column 3 = Black height\n"
+         << "# Column 4 = Average node depth\n"
+         << "# Column 5 = Fraction of RED nodes\n"
+         << "# Column 6 = Avg time per node for RBTCollection profile function\n"
+         << "# Times are measured in nanoseconds" << endl;
+    for (size_t size = START + STEP; size <= STOP; size += STEP) {
+      RBTShape shape;
+      double avg = profile(array, size, shape);
+      cout << size << " "
+           << shape.height << " "
+           << shape.black_height << " "
+           << shape.avg_depth << " "
+           << shape.red_ratio << " "
+           << avg << endl;
+    }
+  }
+  // test 20: BST built from sorted input
+  else if (test_number.compare("20") == 0) {
+    // adds to a list-shaped tree are linear, so building is quadratic
+    const size_t SORTED_STOP = 50000;
+    const size_t SORTED_STEP = 5000;
+    cout << "# Column 1 = Input data size (and tree height)\n"
+         << "# Column 2 = Avg time for BSTCollection add function\n"
+         << "# Column 3 = Avg time for BSTCollection add function (unsorted input)\n"
+         << "# Column 4 = Avg time for BSTCollection sort function\n"
+         << "# Column 5 = Avg time for BSTCollection height function\n"
+         << "# Column 6 = Avg time for BSTCollection copy constructor\n"
+         << "# Column 7 = Avg time for BSTCollection destructor\n"
+         << "# All times are measured in microseconds" << endl;
+    for (size_t size = SORTED_STEP; size <= SORTED_STOP; size += SORTED_STEP) {
+      double times[6];
+      sorted_input(array, size, times);
+      cout << size;
+      for (size_t i = 0; i < 6; ++i)
+        cout << " " << times[i];
+      cout << endl;
+    }
+  }
+  // test 21: sharded collection under a write-heavy mix
+  else if (test_number.compare("21") == 0) {
+    size_t cores = thread::hardware_concurrency();
+    if (cores == 0)
+      cores = 1;
+    ArrayList<string> sample;
+    for (size_t i = 0; i < SHARED_SIZE; ++i)
+      sample.add(array[i].first);
+    cout << "# Column 1 = Number of shards (1 in " << SHARDED_WRITE_EVERY
+         << " operations is a remove+add)\n"
+         << "# Column 2 = Throughput for ShardedCollection by hash (1 thread)\n"
+         << "# Column 3 = Throughput for ShardedCollection by hash ("
+         << cores << " threads)\n"
+         << "# Column 4 = Throughput for ShardedCollection by range ("
+         << cores << " threads)\n"
+         << "# Throughput is measured in operations per millisecond" << endl;
+    for (size_t shards = 1; shards <= MAX_SHARDS; shards *= 2) {
+      HashPartition<string> by_hash(shards);
+      RangePartition<string> by_range = RangePartition<string>::from_sample(sample, shards);
+      double ops1 = sharded(array, by_hash, 1);
+      double ops2 = sharded(array, by_hash, cores);
+      double ops3 = sharded(array, by_range, cores);
+      cout << shards << " " << ops1 << " " << ops2 << " " << ops3 << endl;
     }
   }
   else {
@@ -313,10 +728,14 @@ double add(pair<string,int> array[], size_t size, int type)
     collection = new AVLCollection<string,int>;
   else if (type == RBTSEARCHTREE)
     collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+  if (type == BPLUSTREE)
+    assert(((BPlusTreeCollection<string,int>*)collection)->valid_tree());
   assert(collection->size() == size);
   for (size_t i = 0; i < ITERATIONS; ++i) {
     auto start = high_resolution_clock::now();
@@ -345,10 +764,14 @@ double remove(pair<string,int> array[], size_t size, int type)
     collection = new AVLCollection<string,int>;    
   else if (type == RBTSEARCHTREE)
     collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+  if (type == BPLUSTREE)
+    assert(((BPlusTreeCollection<string,int>*)collection)->valid_tree());
   assert(collection->size() == size);
   for (size_t i = 0; i < ITERATIONS; ++i) {
     auto start = high_resolution_clock::now();
@@ -380,10 +803,16 @@ double find_value(pair<string,int> array[], size_t size, int type)
     collection = new AVLCollection<string,int>;    
   else if (type == RBTSEARCHTREE)
     collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
+  else if (type == RBTTWOWAY)
+    collection = new RBTCollection<string,int,SlabAllocator,TwoWayCompare>;
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+  if (type == BPLUSTREE)
+    assert(((BPlusTreeCollection<string,int>*)collection)->valid_tree());
   assert(collection->size() == size);
   for (size_t i = 0; i < ITERATIONS; ++i) {
     auto start = high_resolution_clock::now();
@@ -412,10 +841,14 @@ double find_range(pair<string,int> array[], size_t size, int type)
     collection = new AVLCollection<string,int>;    
   else if (type == RBTSEARCHTREE)
     collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+  if (type == BPLUSTREE)
+    assert(((BPlusTreeCollection<string,int>*)collection)->valid_tree());
   assert(collection->size() == size);
   for (size_t i = 0; i < ITERATIONS; ++i) {
     size_t k1 = (size/2) - (size/10);
@@ -431,6 +864,33 @@ double find_range(pair<string,int> array[], size_t size, int type)
   return sum(times, ITERATIONS) / (ITERATIONS*1.0);
 }
 
+// Same range as find_range, but only counting the keys (via the
+// order-statistic ranks) instead of returning them. Measured in
+// nanoseconds (the count is too fast for microseconds) and returned
+// in microseconds like the other tests.
+double count_range(pair<string,int> array[], size_t size)
+{
+  unsigned long times[ITERATIONS];
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  assert(collection.valid_rbt());
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    size_t k1 = (size/2) - (size/10);
+    size_t k2 = (size/2) + (size/10);
+    string key1 = get_ith_key(k1, size);
+    string key2 = get_ith_key(k2, size);
+    auto start = high_resolution_clock::now();
+    size_t n = collection.count(key1, key2);
+    auto end = high_resolution_clock::now();
+    ArrayList<string> keys;
+    collection.find(key1, key2, keys);
+    assert(n == keys.size());
+    times[i] = duration_cast<nanoseconds>(end - start).count();
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / 1000.0;
+}
+
 
 double sort(pair<string,int> array[], size_t size, int type)
 {
@@ -448,10 +908,14 @@ double sort(pair<string,int> array[], size_t size, int type)
     collection = new AVLCollection<string,int>;    
   else if (type == RBTSEARCHTREE)
     collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
   for (size_t i = 0; i < size; ++i)
     collection->add(array[i].first, array[i].second);
   if (type == RBTSEARCHTREE)
     assert(((RBTCollection<string,int>*)collection)->valid_rbt());
+  if (type == BPLUSTREE)
+    assert(((BPlusTreeCollection<string,int>*)collection)->valid_tree());
   assert(collection->size() == size);
   for (size_t i = 0; i < ITERATIONS; ++i) {
     ArrayList<string> keys;
@@ -497,8 +961,637 @@ size_t stats(pair<string,int> array[], size_t size, int type)
     height = collection->height();
     delete collection;
   }
+  else if (type == BPLUSTREE) {
+    BPlusTreeCollection<string,int>* collection = new BPlusTreeCollection<string,int>;
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+    assert(collection->valid_tree());
+    height = collection->height();
+    delete collection;
+  }
   return height;
 }
 
 
+// Rebalancing counts for adding the first size pairs to an
+// RBTCollection (add_stats) and then removing every other one of them
+// (remove_stats).
+void rebalance_stats(pair<string,int> array[], size_t size,
+                     RBTStats& add_stats, RBTStats& remove_stats)
+{
+  RBTCollection<string,int,SlabAllocator,ThreeWayCompare<string>,CountRBTStats> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  add_stats = collection.stats();
+  collection.reset_stats();
+  for (size_t i = 0; i < size; i += 2)
+    collection.remove(array[i].first);
+  assert(collection.valid_rbt());
+  assert(collection.size() == size / 2);
+  remove_stats = collection.stats();
+}
+
+
+// Steady-state churn: after one warm-up round, repeatedly remove a key
+// and add it back, returning the average time per remove+add pair (in
+// nanoseconds) and setting allocs_per_op to the number of node
+// allocations made by the allocator per pair.
+template<template<typename> class Alloc>
+double churn(pair<string,int> array[], size_t size, double& allocs_per_op)
+{
+  RBTCollection<string,int,Alloc> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  assert(collection.size() == size);
+  // warm-up round (fills the free list for allocators that have one)
+  for (size_t i = 0; i < CHURN_OPS; ++i) {
+    size_t j = (i * 7919) % size;
+    collection.remove(array[j].first);
+    collection.add(array[j].first, array[j].second);
+  }
+  size_t allocs_before = collection.node_allocations();
+  auto start = high_resolution_clock::now();
+  for (size_t i = 0; i < CHURN_OPS; ++i) {
+    size_t j = (i * 7919) % size;
+    collection.remove(array[j].first);
+    collection.add(array[j].first, array[j].second);
+  }
+  auto end = high_resolution_clock::now();
+  assert(collection.valid_rbt());
+  assert(collection.size() == size);
+  allocs_per_op = (collection.node_allocations() - allocs_before) / (CHURN_OPS*1.0);
+  return duration_cast<nanoseconds>(end - start).count() / (CHURN_OPS*1.0);
+}
+
 
+// Average time (in microseconds) to load the first size pairs, in
+// sorted order, into an RBTCollection either by repeated add or by the
+// linear-time bulk build.
+double load(pair<string,int> array[], size_t size, bool bulk)
+{
+  unsigned long times[ITERATIONS];
+  ArrayList<pair<string,int>> sorted_pairs;
+  pair<string,int>* sorted_array = new pair<string,int>[size + 1];
+  copy(array, array + size, sorted_array);
+  std::sort(sorted_array, sorted_array + size);
+  for (size_t i = 0; i < size; ++i)
+    sorted_pairs.add(sorted_array[i]);
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    RBTCollection<string,int> collection;
+    auto start = high_resolution_clock::now();
+    if (bulk)
+      collection.build(sorted_array, sorted_array + size);
+    else
+      for (size_t j = 0; j < size; ++j)
+        collection.add(sorted_array[j].first, sorted_array[j].second);
+    auto end = high_resolution_clock::now();
+    assert(collection.valid_rbt());
+    assert(collection.size() == size);
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  // the ArrayList constructor builds the same tree
+  RBTCollection<string,int> from_list(sorted_pairs);
+  assert(from_list.valid_rbt());
+  assert(from_list.size() == size);
+  delete [] sorted_array;
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0);
+}
+
+
+// Average time (in microseconds) to merge two trees that split the
+// first size pairs between them at (pseudo) random, either by adding
+// each pair of the second tree to the first (threads = 0) or by
+// set_union with the given number of threads.
+double merge(pair<string,int> array[], size_t size, size_t threads)
+{
+  unsigned long times[ITERATIONS];
+  RBTCollection<string,int> lhs;
+  RBTCollection<string,int> rhs;
+  ArrayList<size_t> rhs_pairs;
+  for (size_t i = 0; i < size; ++i) {
+    // scramble the index so the two key sets interleave unevenly
+    if (((i * 2654435761u) >> 11) % 2 == 0)
+      lhs.add(array[i].first, array[i].second);
+    else {
+      rhs.add(array[i].first, array[i].second);
+      rhs_pairs.add(i);
+    }
+  }
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    RBTCollection<string,int> collection = lhs;
+    RBTCollection<string,int> other = rhs;
+    auto start = high_resolution_clock::now();
+    if (threads == 0)
+      for (size_t j = 0; j < rhs_pairs.size(); ++j) {
+        size_t k = 0;
+        rhs_pairs.get(j, k);
+        collection.add(array[k].first, array[k].second);
+      }
+    else
+      collection.set_union(other, threads);
+    auto end = high_resolution_clock::now();
+    assert(collection.valid_rbt());
+    assert(collection.size() == size);
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0);
+}
+
+
+// Operations per millisecond when the given number of threads share
+// one collection of SHARED_SIZE pairs, each running THREAD_OPS
+// operations that are finds except for every WRITE_EVERY-th, which
+// removes a key and adds it back.
+template<typename Lock>
+double throughput(pair<string,int> array[], size_t threads)
+{
+  unsigned long times[ITERATIONS];
+  ConcurrentCollection<string,int,RBTCollection<string,int>,Lock> collection;
+  for (size_t i = 0; i < SHARED_SIZE; ++i)
+    collection.add(array[i].first, array[i].second);
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    vector<thread> workers;
+    auto start = high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+      workers.push_back(thread([&collection, array, t]() {
+        int val = 0;
+        for (size_t j = 0; j < THREAD_OPS; ++j) {
+          size_t k = (t * THREAD_OPS + j * 7919) % SHARED_SIZE;
+          if (j % WRITE_EVERY == 0) {
+            collection.write([&](RBTCollection<string,int>& c) {
+              c.remove(array[k].first);
+              c.add(array[k].first, array[k].second);
+            });
+          }
+          else
+            collection.find(array[k].first, val);
+        }
+      }));
+    }
+    for (size_t t = 0; t < threads; ++t)
+      workers[t].join();
+    auto end = high_resolution_clock::now();
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  collection.read([](const RBTCollection<string,int>& c) {
+    assert(c.valid_rbt());
+    assert(c.size() == SHARED_SIZE);
+  });
+  double avg = sum(times, ITERATIONS) / (ITERATIONS*1.0);
+  return (threads * THREAD_OPS) / (avg / 1000.0);
+}
+
+
+// Average time (in microseconds) to take a point-in-time copy of a
+// collection of the first size pairs, either a deep copy of an
+// RBTCollection or a snapshot of a PersistentRBTCollection.
+double snapshot(pair<string,int> array[], size_t size, bool persistent)
+{
+  unsigned long times[ITERATIONS];
+  RBTCollection<string,int> rbt;
+  PersistentRBTCollection<string,int> prbt;
+  for (size_t i = 0; i < size; ++i) {
+    if (persistent)
+      prbt.add(array[i].first, array[i].second);
+    else
+      rbt.add(array[i].first, array[i].second);
+  }
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    if (persistent) {
+      auto start = high_resolution_clock::now();
+      PersistentRBTCollection<string,int> copy = prbt.snapshot();
+      auto end = high_resolution_clock::now();
+      assert(copy.size() == size);
+      times[i] = duration_cast<nanoseconds>(end - start).count();
+    }
+    else {
+      auto start = high_resolution_clock::now();
+      RBTCollection<string,int> copy = rbt;
+      auto end = high_resolution_clock::now();
+      assert(copy.size() == size);
+      times[i] = duration_cast<nanoseconds>(end - start).count();
+    }
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1000.0);
+}
+
+
+// Average time (in nanoseconds) of a PersistentRBTCollection add that
+// replaces a value right after a snapshot is taken (so the whole
+// search path is shared), setting allocs_per_op to the number of nodes
+// allocated per add.
+double snapshot_write(pair<string,int> array[], size_t size, double& allocs_per_op)
+{
+  PersistentRBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  size_t allocs_before = collection.node_allocations();
+  unsigned long total = 0;
+  for (size_t i = 0; i < CHURN_OPS; ++i) {
+    size_t j = (i * 7919) % size;
+    PersistentRBTCollection<string,int> copy = collection.snapshot();
+    auto start = high_resolution_clock::now();
+    collection.add(array[j].first, array[j].second + 1);
+    auto end = high_resolution_clock::now();
+    total += duration_cast<nanoseconds>(end - start).count();
+  }
+  assert(collection.valid_rbt());
+  assert(collection.size() == size);
+  allocs_per_op = (collection.node_allocations() - allocs_before) / (CHURN_OPS*1.0);
+  return total / (CHURN_OPS*1.0);
+}
+
+
+// Average time (in nanoseconds) to find a value in a collection of
+// the first size pairs, keyed by their (distinct) int values, setting
+// bytes_per_pair to the memory used by the collection per pair.
+template<typename Coll>
+double layout(pair<string,int> array[], size_t size, double& bytes_per_pair)
+{
+  Coll collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].second, i);
+  assert(collection.size() == size);
+  bytes_per_pair = collection.memory_usage() / (size*1.0);
+  unsigned long times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    int val = 0;
+    auto start = high_resolution_clock::now();
+    for (size_t j = 0; j < size; ++j)
+      collection.find(array[(j * 7919) % size].second, val);
+    auto end = high_resolution_clock::now();
+    times[i] = duration_cast<nanoseconds>(end - start).count();
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / size;
+}
+
+
+// Average time (in microseconds) to add the first size pairs, in
+// ascending key order, to an RBTCollection either by add (searching
+// from the root) or by add_near with the previously added pair as the
+// hint.
+double append(pair<string,int> array[], size_t size, bool hinted)
+{
+  unsigned long times[ITERATIONS];
+  pair<string,int>* sorted_array = new pair<string,int>[size + 1];
+  copy(array, array + size, sorted_array);
+  std::sort(sorted_array, sorted_array + size);
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    RBTCollection<string,int> collection;
+    auto start = high_resolution_clock::now();
+    if (hinted) {
+      auto last = collection.end();
+      for (size_t j = 0; j < size; ++j)
+        last = collection.add_near(last, sorted_array[j].first, sorted_array[j].second);
+    }
+    else
+      for (size_t j = 0; j < size; ++j)
+        collection.add(sorted_array[j].first, sorted_array[j].second);
+    auto end = high_resolution_clock::now();
+    assert(collection.valid_rbt());
+    assert(collection.size() == size);
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  delete [] sorted_array;
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0);
+}
+
+
+// Average time (in nanoseconds) per key to answer requests of batch
+// (pseudo) randomly chosen keys from a collection of the first size
+// pairs, either by calling find for each key or by one find_many call
+// per request.
+double batch_find(const RBTCollection<string,int>& collection,
+                  pair<string,int> array[], size_t size, size_t batch,
+                  bool batched)
+{
+  const size_t KEYS = 65536;  // keys looked up per run
+  size_t count = KEYS / batch;  // requests per run
+  vector<ArrayList<string>> all_requests(count);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < batch; ++j)
+      all_requests[i].add(array[((i * batch + j) * 7919) % size].first);
+  }
+  unsigned long times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    size_t answered = 0;
+    auto start = high_resolution_clock::now();
+    for (size_t r = 0; r < count; ++r) {
+      const ArrayList<string>& keys = all_requests[r];
+      ArrayList<int> values;
+      ArrayList<bool> found;
+      if (batched)
+        collection.find_many(keys, values, found);
+      else {
+        for (size_t j = 0; j < keys.size(); ++j) {
+          int val = 0;
+          found.add(collection.find(keys[j], val));
+          values.add(val);
+        }
+      }
+      answered += found.size();
+    }
+    auto end = high_resolution_clock::now();
+    assert(answered == count * batch);
+    times[i] = duration_cast<nanoseconds>(end - start).count();
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / (count * batch);
+}
+
+
+// Average throughput (in MB of file per second) to save a tree of the
+// first size pairs (mode 0), load it back (mode 1), or read the saved
+// pairs and add them one at a time as a restart without load would
+// (mode 2).
+double save_load(pair<string,int> array[], size_t size, int mode)
+{
+  const string path = "hw9perf_save.bin";
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  bool saved = collection.save(path);
+  assert(saved);
+  ifstream file(path, ios::binary | ios::ate);
+  double megabytes = file.tellg() / 1000000.0;
+  file.close();
+  unsigned long times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    RBTCollection<string,int> loaded;
+    auto start = high_resolution_clock::now();
+    if (mode == 0)
+      collection.save(path);
+    else if (mode == 1)
+      loaded.load(path);
+    else {
+      ifstream in(path, ios::binary);
+      char magic[4];
+      uint64_t n = 0;
+      in.read(magic, sizeof(magic));
+      Serializer<uint64_t>::read(in, n);
+      string key;
+      int val = 0;
+      for (uint64_t j = 0; j < n; ++j) {
+        Serializer<string>::read(in, key);
+        Serializer<int>::read(in, val);
+        loaded.add(key, val);
+      }
+    }
+    auto end = high_resolution_clock::now();
+    if (mode != 0) {
+      assert(loaded.valid_rbt());
+      assert(loaded.size() == size);
+    }
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  remove(path.c_str());
+  return megabytes / (sum(times, ITERATIONS) / (ITERATIONS*1000000.0));
+}
+
+
+// Average startup time (in microseconds) for a read-only copy of the
+// first size pairs, either by loading an RBTCollection save or by
+// opening a FrozenIndex, setting find_time to the average time (in
+// nanoseconds) to find a value in the loaded or opened copy.
+double frozen(pair<string,int> array[], size_t size, bool mapped,
+              double& find_time)
+{
+  const string path = "hw9perf_frozen.bin";
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  bool written = mapped ? FrozenIndex<string,int>::freeze(collection, path)
+                        : collection.save(path);
+  assert(written);
+  unsigned long times[ITERATIONS];
+  unsigned long find_times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    RBTCollection<string,int> loaded;
+    FrozenIndex<string,int> index;
+    auto start = high_resolution_clock::now();
+    bool opened = mapped ? index.open(path) : loaded.load(path);
+    auto end = high_resolution_clock::now();
+    assert(opened);
+    times[i] = duration_cast<microseconds>(end - start).count();
+    int val = 0;
+    start = high_resolution_clock::now();
+    for (size_t j = 0; j < size; ++j) {
+      const string& key = array[(j * 7919) % size].first;
+      if (mapped)
+        index.find(key, val);
+      else
+        loaded.find(key, val);
+    }
+    end = high_resolution_clock::now();
+    find_times[i] = duration_cast<nanoseconds>(end - start).count();
+  }
+  remove(path.c_str());
+  find_time = sum(find_times, ITERATIONS) / (ITERATIONS*1.0) / size;
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0);
+}
+
+
+// group_size 0 times adds to a plain RBTCollection instead
+double durable(pair<string,int> array[], size_t group_size,
+               double& recover_time)
+{
+  const string snap = "hw9perf_wal.snap", wal = "hw9perf_wal.log";
+  unsigned long times[ITERATIONS];
+  unsigned long recover_times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    remove(snap.c_str());
+    remove(wal.c_str());
+    recover_times[i] = 0;
+    if (group_size == 0) {
+      RBTCollection<string,int> collection;
+      auto start = high_resolution_clock::now();
+      for (size_t j = 0; j < LOGGED_OPS; ++j)
+        collection.add(array[j].first, array[j].second);
+      auto end = high_resolution_clock::now();
+      times[i] = duration_cast<microseconds>(end - start).count();
+      continue;
+    }
+    {
+      WALCollection<string,int> collection;
+      bool opened = collection.open(snap, wal, group_size);
+      assert(opened);
+      auto start = high_resolution_clock::now();
+      for (size_t j = 0; j < LOGGED_OPS; ++j)
+        collection.add(array[j].first, array[j].second);
+      collection.sync();
+      auto end = high_resolution_clock::now();
+      times[i] = duration_cast<microseconds>(end - start).count();
+    }
+    WALCollection<string,int> recovered;
+    auto start = high_resolution_clock::now();
+    bool opened = recovered.open(snap, wal);
+    auto end = high_resolution_clock::now();
+    assert(opened && recovered.size() == LOGGED_OPS);
+    recover_times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  remove(snap.c_str());
+  remove(wal.c_str());
+  recover_time = sum(recover_times, ITERATIONS) / (ITERATIONS*1.0) / LOGGED_OPS;
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / LOGGED_OPS;
+}
+
+
+// Bytes per pair reported by memory_usage after adding the first size
+// pairs (the sorted array collection gets them in key order, so each
+// add appends instead of shifting the list, and the BST gets them
+// fully shuffled, since the input is only partly random)
+double footprint(pair<string,int> array[], size_t size, int type)
+{
+  Collection<string,int>* collection;
+  if (type == ARRAYLIST)
+    collection = new ArrayListCollection<string,int>;
+  else if (type == BINSEARCH)
+    collection = new BinSearchCollection<string,int>;
+  else if (type == HASHTABLE)
+    collection = new HashTableCollection<string,int>;
+  else if (type == BINSEARCHTREE)
+    collection = new BSTCollection<string,int>;
+  else if (type == AVLSEARCHTREE)
+    collection = new AVLCollection<string,int>;
+  else if (type == RBTSEARCHTREE)
+    collection = new RBTCollection<string,int>;
+  else if (type == BPLUSTREE)
+    collection = new BPlusTreeCollection<string,int>;
+  else if (type == COMPACTRBT)
+    collection = new CompactRBTCollection<string,int>;
+  else
+    collection = new PersistentRBTCollection<string,int>;
+  if (type == BINSEARCH || type == BINSEARCHTREE) {
+    pair<string,int>* ordered_array = new pair<string,int>[size + 1];
+    copy(array, array + size, ordered_array);
+    if (type == BINSEARCH)
+      std::sort(ordered_array, ordered_array + size);
+    else
+      for (size_t i = size; i > 1; --i)
+        swap(ordered_array[i - 1], ordered_array[rand() % i]);
+    for (size_t i = 0; i < size; ++i)
+      collection->add(ordered_array[i].first, ordered_array[i].second);
+    delete [] ordered_array;
+  }
+  else
+    for (size_t i = 0; i < size; ++i)
+      collection->add(array[i].first, array[i].second);
+  assert(collection->size() == size);
+  double bytes_per_pair = collection->memory_usage() / (size*1.0);
+  delete collection;
+  return bytes_per_pair;
+}
+
+
+// Average time (in nanoseconds per node) for one profile pass over an
+// RBTCollection holding the first size pairs
+double profile(pair<string,int> array[], size_t size, RBTShape& shape)
+{
+  RBTCollection<string,int> collection;
+  for (size_t i = 0; i < size; ++i)
+    collection.add(array[i].first, array[i].second);
+  unsigned long times[ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    auto start = high_resolution_clock::now();
+    shape = collection.profile();
+    auto end = high_resolution_clock::now();
+    times[i] = duration_cast<nanoseconds>(end - start).count();
+    assert(shape.valid && shape.nodes == size);
+  }
+  return sum(times, ITERATIONS) / (ITERATIONS*1.0) / size;
+}
+
+
+// Average times (in microseconds) for operations on a BSTCollection
+// holding the first size pairs added in key order, so the tree is a
+// list size nodes deep: add (of a key past the end), add to a tree
+// built from the unsorted pairs, sort, height, copy, and delete
+void sorted_input(pair<string,int> array[], size_t size, double times[])
+{
+  pair<string,int>* sorted_array = new pair<string,int>[size + 2];
+  copy(array, array + size + 2, sorted_array);
+  std::sort(sorted_array, sorted_array + size + 2);
+  BSTCollection<string,int> sorted;
+  BSTCollection<string,int> unsorted;
+  for (size_t i = 0; i < size; ++i) {
+    sorted.add(sorted_array[i].first, sorted_array[i].second);
+    unsorted.add(array[i].first, array[i].second);
+  }
+  assert(sorted.height() == size);
+  unsigned long op_times[6][ITERATIONS];
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    auto start = high_resolution_clock::now();
+    sorted.add(sorted_array[size + 1].first, sorted_array[size + 1].second);
+    auto end = high_resolution_clock::now();
+    op_times[0][i] = duration_cast<microseconds>(end - start).count();
+    sorted.remove(sorted_array[size + 1].first);
+    start = high_resolution_clock::now();
+    unsorted.add(array[size + 1].first, array[size + 1].second);
+    end = high_resolution_clock::now();
+    op_times[1][i] = duration_cast<microseconds>(end - start).count();
+    unsorted.remove(array[size + 1].first);
+    ArrayList<string> sorted_keys;
+    start = high_resolution_clock::now();
+    sorted.sort(sorted_keys);
+    end = high_resolution_clock::now();
+    op_times[2][i] = duration_cast<microseconds>(end - start).count();
+    start = high_resolution_clock::now();
+    size_t height = sorted.height();
+    end = high_resolution_clock::now();
+    op_times[3][i] = duration_cast<microseconds>(end - start).count();
+    assert(height == size);
+    start = high_resolution_clock::now();
+    BSTCollection<string,int>* copied = new BSTCollection<string,int>(sorted);
+    end = high_resolution_clock::now();
+    op_times[4][i] = duration_cast<microseconds>(end - start).count();
+    start = high_resolution_clock::now();
+    delete copied;
+    end = high_resolution_clock::now();
+    op_times[5][i] = duration_cast<microseconds>(end - start).count();
+  }
+  for (size_t j = 0; j < 6; ++j)
+    times[j] = sum(op_times[j], ITERATIONS) / (ITERATIONS*1.0);
+  delete [] sorted_array;
+}
+
+
+// Operations per millisecond when the given number of threads share a
+// ShardedCollection of SHARED_SIZE pairs in RBT shards, each running
+// THREAD_OPS operations that are finds except for every
+// SHARDED_WRITE_EVERY-th, which removes a key and puts it back (only
+// the key's shard is locked, so writers to other shards don't wait).
+template<typename Partition>
+double sharded(pair<string,int> array[], const Partition& partition,
+               size_t threads)
+{
+  unsigned long times[ITERATIONS];
+  ShardedCollection<string,int,RBTCollection<string,int>,Partition> collection(partition);
+  for (size_t i = 0; i < SHARED_SIZE; ++i)
+    collection.add(array[i].first, array[i].second);
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    vector<thread> workers;
+    auto start = high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+      workers.push_back(thread([&collection, array, t]() {
+        int val = 0;
+        for (size_t j = 0; j < THREAD_OPS; ++j) {
+          size_t k = (t * THREAD_OPS + j * 7919) % SHARED_SIZE;
+          if (j % SHARDED_WRITE_EVERY == 0) {
+            // the remove and the add lock the shard separately, so
+            // another thread may put the key back in between
+            collection.remove(array[k].first);
+            collection.insert_or_assign(array[k].first, array[k].second);
+          }
+          else
+            collection.find(array[k].first, val);
+        }
+      }));
+    }
+    for (size_t t = 0; t < threads; ++t)
+      workers[t].join();
+    auto end = high_resolution_clock::now();
+    times[i] = duration_cast<microseconds>(end - start).count();
+  }
+  assert(collection.size() == SHARED_SIZE);
+  double avg = sum(times, ITERATIONS) / (ITERATIONS*1.0);
+  return (threads * THREAD_OPS) / (avg / 1000.0);
+}
@@ -8,9 +8,29 @@
 
 #include <iostream>
 #include <string>
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string_view>
+#include <csignal>
+#include <sys/resource.h>
 #include <gtest/gtest.h>
 #include "array_list.h"
 #include "rbt_collection.h"
+#include "avl_collection.h"
+#include "bst_collection.h"
+#include "hash_table_collection.h"
+#include "bin_search_collection.h"
+#include "array_list_collection.h"
+#include "concurrent_collection.h"
+#include "persistent_rbt_collection.h"
+#include "compact_rbt_collection.h"
+#include "bplus_tree_collection.h"
+#include "frozen_index.h"
+#include "wal_collection.h"
+#include "sharded_collection.h"
 
 
 using namespace std;
@@ -481,6 +501,1482 @@ TEST(RBTCollectionTest, RangeRemove) {
   ASSERT_EQ(false, member(string("c"), in_range2));
   ASSERT_EQ(true, member(string("d"), in_range2));
   ASSERT_EQ(true, member(string("e"), in_range2));
+  // removing the whole range at once
+  ArrayList<string> in_range3;
+  c.remove("b", "e");
+  c.find("a", "f", in_range3);
+  ASSERT_EQ(2, in_range3.size());
+  ASSERT_EQ(true, member(string("a"), in_range3));
+  ASSERT_EQ(true, member(string("f"), in_range3));
+  ASSERT_EQ(2, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+}
+
+// Test 16 - Removing a missing key (the rebalancing on the way down can
+// rotate at the root, so the root must still be updated)
+TEST(RBTCollectionTest, RemoveMissingKey) {
+  RBTCollection<string,int> c;
+  c.add("d", 40);
+  c.add("b", 20);
+  c.add("f", 60);
+  c.add("a", 10);
+  c.add("c", 30);
+  c.remove("z");
+  c.remove("0");
+  ASSERT_EQ(5, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  int v;
+  ASSERT_EQ(true, c.find("a", v));
+  ASSERT_EQ(true, c.find("f", v));
+  ASSERT_EQ(60, v);
+}
+
+// Test 17 - Repeated remove/add churn keeps the tree valid and, with
+// the slab allocator, reuses freed nodes instead of allocating
+TEST(RBTCollectionTest, ChurnReusesNodes) {
+  RBTCollection<int,int> c1;
+  RBTCollection<int,int,HeapAllocator> c2;
+  for (int i = 0; i < 500; ++i) {
+    c1.add((i * 37) % 500, i);
+    c2.add((i * 37) % 500, i);
+  }
+  size_t allocs = c1.node_allocations();
+  for (int i = 0; i < 2000; ++i) {
+    int k = (i * 101) % 500;
+    c1.remove(k);
+    c1.add(k, i);
+    c2.remove(k);
+    c2.add(k, i);
+    ASSERT_EQ(true, c1.valid_rbt());
+    ASSERT_EQ(true, c2.valid_rbt());
+  }
+  ASSERT_EQ(500, c1.size());
+  ASSERT_EQ(500, c2.size());
+  ASSERT_EQ(allocs, c1.node_allocations());
+  ASSERT_EQ(2500, c2.node_allocations());
+}
+
+// Test 18 - Bulk build from sorted input gives a valid red-black tree
+// (for every size, including the non-perfect ones) holding every pair
+TEST(RBTCollectionTest, BulkBuild) {
+  for (int n = 0; n <= 70; ++n) {
+    ArrayList<pair<int,int>> sorted_pairs;
+    for (int i = 0; i < n; ++i)
+      sorted_pairs.add(pair<int,int>(i * 2, i * 10));
+    RBTCollection<int,int> c(sorted_pairs);
+    ASSERT_EQ(n, c.size());
+    ASSERT_EQ(true, c.valid_rbt());
+    for (int i = 0; i < n; ++i) {
+      int v;
+      ASSERT_EQ(true, c.find(i * 2, v));
+      ASSERT_EQ(i * 10, v);
+      ASSERT_EQ(false, c.find(i * 2 + 1, v));
+    }
+    // the tree must still support add and remove
+    c.add(-1, 0);
+    c.remove(0);
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  // iterator range version replaces the existing contents
+  pair<string,int> items[4] = {{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+  RBTCollection<string,int,HeapAllocator> c;
+  c.add("z", 26);
+  c.build(items, items + 4);
+  ASSERT_EQ(4, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  ArrayList<string> sorted_keys;
+  c.sort(sorted_keys);
+  string k;
+  sorted_keys.get(3, k);
+  ASSERT_EQ("d", k);
+}
+
+// Test 19 - Iterators walk the pairs in key order in both directions,
+// and the bounds find the expected positions
+TEST(RBTCollectionTest, Iterators) {
+  RBTCollection<string,int> c;
+  ASSERT_EQ(true, c.begin() == c.end());
+  c.add("d", 40);
+  c.add("b", 20);
+  c.add("f", 60);
+  c.add("a", 10);
+  c.add("c", 30);
+  c.add("e", 50);
+  string expected = "abcdef";
+  size_t i = 0;
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    ASSERT_EQ(string(1, expected[i]), it.key());
+    ASSERT_EQ(10 * (int)(i + 1), it.value());
+    ++i;
+  }
+  ASSERT_EQ(6, i);
+  // backwards from the end
+  auto it = c.end();
+  for (int j = 5; j >= 0; --j) {
+    --it;
+    ASSERT_EQ(string(1, expected[j]), it.key());
+  }
+  ASSERT_EQ(true, it == c.begin());
+  // values can be updated in place
+  c.lower_bound("c").value() = 35;
+  int v;
+  c.find("c", v);
+  ASSERT_EQ(35, v);
+  // bounds
+  const RBTCollection<string,int>& cc = c;
+  ASSERT_EQ("c", cc.lower_bound("bb").key());
+  ASSERT_EQ("c", cc.lower_bound("c").key());
+  ASSERT_EQ("d", cc.upper_bound("c").key());
+  ASSERT_EQ(true, cc.lower_bound("g") == cc.end());
+  ASSERT_EQ(true, cc.upper_bound("f") == cc.end());
+  auto range = cc.equal_range("e");
+  ASSERT_EQ("e", range.first.key());
+  ASSERT_EQ("f", range.second.key());
+  range = cc.equal_range("ee");
+  ASSERT_EQ(true, range.first == range.second);
+}
+
+// Test 20 - Range scans visit keys in ascending order, only within the
+// range, and stop as soon as the visitor returns false
+TEST(RBTCollectionTest, OrderedRangeScan) {
+  RBTCollection<int,int> c;
+  for (int i = 0; i < 100; ++i)
+    c.add((i * 37) % 100, i);
+  ArrayList<int> in_range;
+  c.find(20, 29, in_range);
+  ASSERT_EQ(10, in_range.size());
+  for (int i = 0; i < 10; ++i) {
+    int k;
+    in_range.get(i, k);
+    ASSERT_EQ(20 + i, k);
+  }
+  // early stop after 5 keys
+  int visited = 0;
+  int last = -1;
+  c.scan(50, 99, [&](const int& key, const int&) {
+    EXPECT_LT(last, key);
+    last = key;
+    return ++visited < 5;
+  });
+  ASSERT_EQ(5, visited);
+  ASSERT_EQ(54, last);
+  // empty range
+  visited = 0;
+  c.scan(60, 50, [&](const int&, const int&) {
+    ++visited;
+    return true;
+  });
+  ASSERT_EQ(0, visited);
+}
+
+// Test 21 - rank, select and count agree with the sorted keys after
+// adds and removes (which rotate and so move the subtree sizes)
+TEST(RBTCollectionTest, OrderStatistics) {
+  RBTCollection<int,int> c;
+  for (int i = 0; i < 200; ++i)
+    c.add((i * 73) % 200, i);
+  for (int i = 0; i < 200; i += 3)
+    c.remove(i);
+  ASSERT_EQ(true, c.valid_rbt());
+  ArrayList<int> sorted_keys;
+  c.sort(sorted_keys);
+  for (size_t i = 0; i < sorted_keys.size(); ++i) {
+    int k1, k2;
+    sorted_keys.get(i, k1);
+    ASSERT_EQ(true, c.select(i, k2));
+    ASSERT_EQ(k1, k2);
+    ASSERT_EQ(i, c.rank(k1));
+  }
+  int k;
+  ASSERT_EQ(false, c.select(sorted_keys.size(), k));
+  ASSERT_EQ(0, c.rank(-5));
+  ASSERT_EQ(sorted_keys.size(), c.rank(500));
+  ArrayList<int> in_range;
+  c.find(10, 60, in_range);
+  ASSERT_EQ(in_range.size(), c.count(10, 60));
+  ASSERT_EQ(0, c.count(60, 10));
+  ASSERT_EQ(1, c.count(1, 1));
+  ASSERT_EQ(0, c.count(3, 3));
+}
+
+// Test 22 - join and split move whole subtrees and keep the trees valid
+TEST(RBTCollectionTest, JoinSplit) {
+  RBTCollection<int,int> left, right, c;
+  for (int i = 0; i < 300; ++i)
+    left.add(i, i);
+  for (int i = 301; i < 320; ++i)
+    right.add(i, i);
+  c.join(left, 300, -1, right);
+  ASSERT_EQ(320, c.size());
+  ASSERT_EQ(0, left.size());
+  ASSERT_EQ(0, right.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  int v = 0;
+  ASSERT_EQ(true, c.find(300, v));
+  ASSERT_EQ(-1, v);
+  c.split(150, left, right);
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(150, left.size());
+  ASSERT_EQ(170, right.size());
+  ASSERT_EQ(true, left.valid_rbt());
+  ASSERT_EQ(true, right.valid_rbt());
+  ASSERT_EQ(false, left.find(150, v));
+  ASSERT_EQ(true, right.find(150, v));
+  // the split trees share nodes, but stay independent
+  left.remove(10);
+  right.add(1000, 1000);
+  ASSERT_EQ(true, left.valid_rbt());
+  ASSERT_EQ(true, right.valid_rbt());
+  left.join(left, right);
+  ASSERT_EQ(320, left.size());
+  ASSERT_EQ(true, left.valid_rbt());
+  ASSERT_EQ(0, left.rank(0));
+  ASSERT_EQ(319, left.rank(1000));
+}
+
+// Test 23 - union, intersection and difference match the key sets
+// (sequential and with several threads)
+TEST(RBTCollectionTest, SetOperations) {
+  for (size_t threads = 1; threads <= 4; threads *= 2) {
+    RBTCollection<int,int> a, b, c, d, e, f;
+    for (int i = 0; i < 20000; i += 2)
+      a.add(i, 1);
+    for (int i = 0; i < 20000; i += 3)
+      b.add(i, 2);
+    c = a;
+    d = b;
+    e = a;
+    f = b;
+    a.set_union(b, threads);
+    c.set_intersection(d, threads);
+    e.set_difference(f, threads);
+    ASSERT_EQ(0, b.size());
+    ASSERT_EQ(true, a.valid_rbt());
+    ASSERT_EQ(true, c.valid_rbt());
+    ASSERT_EQ(true, e.valid_rbt());
+    ASSERT_EQ(10000 + 6667 - 3334, a.size());
+    ASSERT_EQ(3334, c.size());
+    ASSERT_EQ(10000 - 3334, e.size());
+    int v = 0;
+    ASSERT_EQ(true, a.find(6, v));
+    ASSERT_EQ(1, v);  // values in the left-hand collection win
+    ASSERT_EQ(true, a.find(9, v));
+    ASSERT_EQ(2, v);
+    ASSERT_EQ(true, c.find(12, v));
+    ASSERT_EQ(false, c.find(4, v));
+    ASSERT_EQ(true, e.find(4, v));
+    ASSERT_EQ(false, e.find(12, v));
+    ASSERT_EQ(a.size(), a.count(0, 20000));
+  }
+}
+
+// Test 24 - readers and writers sharing a ConcurrentCollection see
+// a valid tree and every pair that is never removed
+TEST(ConcurrentCollectionTest, ReadersAndWriters) {
+  ConcurrentCollection<int,int> c;
+  for (int i = 0; i < 1000; ++i)
+    c.add(i, i);
+  std::atomic<int> misses(0);
+  std::vector<std::thread> threads;
+  // writers churn the odd keys (each its own half of them)
+  for (int t = 0; t < 2; ++t)
+    threads.push_back(std::thread([&c, t]() {
+      for (int i = 0; i < 2000; ++i) {
+        int k = (4 * i + 1 + 2 * t) % 1000;
+        c.remove(k);
+        c.add(k, k);
+      }
+    }));
+  // readers only look for the even keys
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c, &misses]() {
+      for (int i = 0; i < 5000; ++i) {
+        int v = -1;
+        if (!c.find((i * 2) % 1000, v) || v != (i * 2) % 1000)
+          ++misses;
+      }
+    }));
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  ASSERT_EQ(0, misses.load());
+  ASSERT_EQ(1000, c.size());
+  bool valid = false;
+  c.read([&valid](const RBTCollection<int,int>& rbt) {
+    valid = rbt.valid_rbt();
+  });
+  ASSERT_EQ(true, valid);
+}
+
+// Test 25 - snapshots keep their contents while the original changes
+// (and vice versa)
+TEST(PersistentRBTCollectionTest, Snapshots) {
+  PersistentRBTCollection<int,int> c;
+  for (int i = 0; i < 100; ++i)
+    c.add(i, i);
+  PersistentRBTCollection<int,int> snap = c.snapshot();
+  for (int i = 0; i < 100; i += 2)
+    c.remove(i);
+  c.add(500, 500);
+  c.add(1, -1);
+  snap.add(-5, -5);
+  ASSERT_EQ(true, c.valid_rbt());
+  ASSERT_EQ(true, snap.valid_rbt());
+  ASSERT_EQ(51, c.size());
+  ASSERT_EQ(101, snap.size());
+  int v = 0;
+  ASSERT_EQ(false, c.find(2, v));
+  ASSERT_EQ(true, snap.find(2, v));
+  ASSERT_EQ(true, c.find(1, v));
+  ASSERT_EQ(-1, v);
+  ASSERT_EQ(true, snap.find(1, v));
+  ASSERT_EQ(1, v);
+  ASSERT_EQ(false, c.find(-5, v));
+  ASSERT_EQ(false, snap.find(500, v));
+  ArrayList<int> sorted_keys;
+  snap.sort(sorted_keys);
+  for (int i = 0; i < 100; ++i) {
+    sorted_keys.get(i + 1, v);
+    ASSERT_EQ(i, v);
+  }
+  // assignment shares the other tree, the old one is released
+  snap = c;
+  ASSERT_EQ(51, snap.size());
+  ASSERT_EQ(true, snap.find(500, v));
+}
+
+// Test 26 - an add after a snapshot only copies the search path
+TEST(PersistentRBTCollectionTest, PathCopying) {
+  PersistentRBTCollection<int,int> c;
+  for (int i = 0; i < 1000; ++i)
+    c.add(i, i);
+  ASSERT_EQ(1000, c.node_allocations());
+  // nothing is shared, so nothing is copied
+  c.add(1000, 1000);
+  ASSERT_EQ(1001, c.node_allocations());
+  PersistentRBTCollection<int,int> snap = c.snapshot();
+  size_t before = c.node_allocations();
+  c.add(500, -1);
+  ASSERT_GE(c.height(), c.node_allocations() - before);
+  before = c.node_allocations();
+  snap = c.snapshot();
+  c.remove(250);
+  ASSERT_GE(2 * c.height() + 2, c.node_allocations() - before);
+  ASSERT_EQ(true, c.valid_rbt());
+  ASSERT_EQ(true, snap.valid_rbt());
+  ASSERT_EQ(1000, c.size());
+  ASSERT_EQ(1001, snap.size());
+}
+
+// Test 27 - the compact layout supports the same operations (and
+// reuses removed nodes)
+TEST(CompactRBTCollectionTest, AddRemoveFind) {
+  CompactRBTCollection<int,string> c;
+  for (int i = 0; i < 500; ++i)
+    c.add((i * 37) % 500, to_string(i));
+  ASSERT_EQ(500, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  size_t bytes = c.memory_usage();
+  for (int i = 0; i < 500; i += 2)
+    c.remove(i);
+  c.remove(1000);
+  ASSERT_EQ(250, c.size());
+  ASSERT_EQ(true, c.valid_rbt());
+  for (int i = 0; i < 500; i += 2)
+    c.add(i, "x");
+  ASSERT_EQ(500, c.size());
+  ASSERT_EQ(bytes, c.memory_usage());
+  string v;
+  ASSERT_EQ(true, c.find(37, v));
+  ASSERT_EQ("1", v);
+  ASSERT_EQ(true, c.find(2, v));
+  ASSERT_EQ("x", v);
+  ASSERT_EQ(false, c.find(500, v));
+  ArrayList<int> in_range;
+  c.find(10, 19, in_range);
+  ASSERT_EQ(10, in_range.size());
+  CompactRBTCollection<int,string> d(c);
+  d.remove(37);
+  ASSERT_EQ(true, c.find(37, v));
+  ASSERT_EQ(false, d.find(37, v));
+  ASSERT_EQ(true, d.valid_rbt());
+}
+
+// Test 28 - small keys take fewer bytes per pair than the pointer layout
+TEST(CompactRBTCollectionTest, MemoryUsage) {
+  RBTCollection<int,int> rbt;
+  CompactRBTCollection<int,int> compact;
+  for (int i = 0; i < 4096; ++i) {
+    rbt.add(i, i);
+    compact.add(i, i);
+  }
+  ASSERT_GT(rbt.memory_usage(), compact.memory_usage());
+  ASSERT_GE(2 * 20 * 4096, compact.memory_usage() - sizeof(compact));
+}
+
+// Test 29 - a small fanout B+ tree splits, borrows and merges nodes as
+// pairs are added and removed
+TEST(BPlusTreeCollectionTest, AddRemoveFind) {
+  BPlusTreeCollection<int,int,4> c;
+  for (int i = 0; i < 500; ++i) {
+    c.add((i * 37) % 500, i);
+    ASSERT_EQ(true, c.valid_tree());
+  }
+  ASSERT_EQ(500, c.size());
+  ASSERT_LE(5, c.height());
+  int v = 0;
+  ASSERT_EQ(true, c.find(37, v));
+  ASSERT_EQ(1, v);
+  ASSERT_EQ(false, c.find(500, v));
+  for (int i = 0; i < 500; i += 3) {
+    c.remove(i);
+    ASSERT_EQ(true, c.valid_tree());
+  }
+  c.remove(1000);
+  ASSERT_EQ(333, c.size());
+  ASSERT_EQ(false, c.find(3, v));
+  ASSERT_EQ(true, c.find(4, v));
+  for (int i = 0; i < 500; ++i)
+    c.remove(i);
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(0, c.height());
+  ASSERT_EQ(true, c.valid_tree());
+  // the slot find_or_insert returns is the key's, even when adding it
+  // splits the leaf
+  for (int i = 0; i < 200; ++i) {
+    c.find_or_insert((i * 37) % 200) = i;
+    ASSERT_EQ(true, c.valid_tree());
+  }
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(true, c.find((i * 37) % 200, v));
+    ASSERT_EQ(i, v);
+  }
+}
+
+// Test 30 - range finds and sort follow the leaf links in key order
+TEST(BPlusTreeCollectionTest, RangeAndSort) {
+  BPlusTreeCollection<string,int> c;
+  // every two-letter key, added out of order
+  for (int i = 0; i < 26 * 26; ++i) {
+    int j = (i * 7) % (26 * 26);
+    string key = "";
+    key += char('a' + j / 26);
+    key += char('a' + j % 26);
+    c.add(key, i);
+  }
+  ASSERT_EQ(true, c.valid_tree());
+  ArrayList<string> sorted_keys;
+  c.sort(sorted_keys);
+  ASSERT_EQ(26 * 26, sorted_keys.size());
+  for (size_t i = 1; i < sorted_keys.size(); ++i) {
+    string k1, k2;
+    sorted_keys.get(i - 1, k1);
+    sorted_keys.get(i, k2);
+    ASSERT_LT(k1, k2);
+  }
+  ArrayList<string> in_range;
+  c.find("bb", "cc", in_range);
+  ASSERT_EQ(25 + 3, in_range.size());  // bb-bz and ca-cc
+  string first, last;
+  in_range.get(0, first);
+  in_range.get(in_range.size() - 1, last);
+  ASSERT_EQ("bb", first);
+  ASSERT_EQ("cc", last);
+  BPlusTreeCollection<string,int> copy(c);
+  copy.remove("bb");
+  ASSERT_EQ(true, copy.valid_tree());
+  ASSERT_EQ(c.size() - 1, copy.size());
+}
+
+// Test 31 - moving a collection hands over its nodes and empties the source
+TEST(RBTCollectionTest, MoveConstructAndAssign) {
+  RBTCollection<string,int> c;
+  for (int i = 0; i < 200; ++i)
+    c.add("k" + to_string(i), i);
+  RBTCollection<string,int> moved(std::move(c));
+  ASSERT_EQ(0, c.size());
+  ASSERT_EQ(200, moved.size());
+  ASSERT_EQ(true, moved.valid_rbt());
+  int v = 0;
+  ASSERT_EQ(true, moved.find("k150", v));
+  ASSERT_EQ(150, v);
+  // the moved-from collection is still usable
+  c.add("x", 1);
+  ASSERT_EQ(1, c.size());
+  c = std::move(moved);
+  ASSERT_EQ(200, c.size());
+  ASSERT_EQ(0, moved.size());
+  ASSERT_EQ(false, c.find("x", v));
+  ASSERT_EQ(true, c.find("k7", v));
+  ASSERT_EQ(7, v);
+  ASSERT_EQ(true, c.valid_rbt());
+  RBTCollection<string,int,HeapAllocator> h;
+  h.add("a", 1);
+  h.add("b", 2);
+  RBTCollection<string,int,HeapAllocator> h2;
+  h2 = std::move(h);
+  ASSERT_EQ(0, h.size());
+  ASSERT_EQ(2, h2.size());
+}
+
+// value type that counts how often it is copied
+struct Counted {
+  static int copies;
+  string s;
+  Counted() {}
+  Counted(const string& a, const string& b) : s(a + b) {}
+  Counted(const Counted& rhs) : s(rhs.s) {++copies;}
+  Counted(Counted&& rhs) : s(std::move(rhs.s)) {}
+  Counted& operator=(const Counted& rhs) {s = rhs.s; ++copies; return *this;}
+  Counted& operator=(Counted&& rhs) {s = std::move(rhs.s); return *this;}
+  bool operator<(const Counted& rhs) const {return s < rhs.s;}
+  bool operator>(const Counted& rhs) const {return s > rhs.s;}
+};
+int Counted::copies = 0;
+
+template<typename Coll>
+void add_without_copies()
+{
+  Coll c;
+  Counted::copies = 0;
+  for (int i = 0; i < 100; ++i) {
+    c.emplace(i, Counted("a", to_string(i)));
+    c.emplace(i + 100, "b", to_string(i));
+  }
+  c.add(500, Counted("c", ""));  // rvalue key and value
+  ASSERT_EQ(0, Counted::copies);
+  ASSERT_EQ(201, c.size());
+  Coll moved(std::move(c));
+  ASSERT_EQ(0, Counted::copies);
+  ASSERT_EQ(201, moved.size());
+  ASSERT_EQ(0, c.size());
+  Counted v;
+  ASSERT_EQ(true, moved.find(142, v));
+  ASSERT_EQ("b42", v.s);
+  ASSERT_EQ(true, moved.find(500, v));
+  ASSERT_EQ("c", v.s);
+}
+
+// Test 32 - rvalue add and emplace build the values without copying them
+TEST(CollectionTest, AddAndEmplaceWithoutCopies) {
+  add_without_copies<RBTCollection<int,Counted>>();
+  add_without_copies<RBTCollection<int,Counted,HeapAllocator>>();
+  add_without_copies<AVLCollection<int,Counted>>();
+  add_without_copies<BSTCollection<int,Counted>>();
+  add_without_copies<HashTableCollection<int,Counted>>();
+  ArrayList<Counted> list;
+  Counted::copies = 0;
+  for (int i = 0; i < 50; ++i)
+    list.emplace("d", to_string(i));
+  list.add(0, Counted("e", ""));
+  ASSERT_EQ(0, Counted::copies);
+  ASSERT_EQ(51, list.size());
+}
+
+template<typename Coll>
+void find_string_views()
+{
+  Coll c;
+  for (int i = 0; i < 100; ++i)
+    c.add("key" + to_string(i), i);
+  // a buffer with the lookup key inside it (string_view does not convert
+  // to string implicitly, so these only compile as heterogeneous finds)
+  const char buffer[] = "GET key42 key420";
+  int v = 0;
+  ASSERT_EQ(true, c.find(string_view(buffer + 4, 5), v));
+  ASSERT_EQ(42, v);
+  ASSERT_EQ(false, c.find(string_view(buffer + 10, 6), v));
+  ASSERT_EQ(false, c.find(string_view(buffer + 4, 3), v));
+  ASSERT_EQ(true, c.find("key7", v));
+  ASSERT_EQ(7, v);
+  ASSERT_EQ(true, c.find(string("key99"), v));
+  ASSERT_EQ(99, v);
+}
+
+// Test 33 - string_view and const char* lookups find string keys
+TEST(CollectionTest, HeterogeneousFind) {
+  find_string_views<RBTCollection<string,int>>();
+  find_string_views<AVLCollection<string,int>>();
+  find_string_views<BinSearchCollection<string,int>>();
+  find_string_views<HashTableCollection<string,int>>();
+}
+
+template<typename Coll>
+void case_insensitive_keys()
+{
+  Coll c;
+  c.add("Banana", 2);
+  c.add("apple", 1);
+  c.add("cherry", 3);
+  c.add("Date", 4);
+  int v = 0;
+  ASSERT_EQ(true, c.find(string("APPLE"), v));
+  ASSERT_EQ(1, v);
+  ASSERT_EQ(true, c.find(string("banana"), v));
+  ASSERT_EQ(2, v);
+  ArrayList<string> sorted_keys;
+  c.sort(sorted_keys);
+  string k;
+  sorted_keys.get(0, k);
+  ASSERT_EQ("apple", k);
+  sorted_keys.get(3, k);
+  ASSERT_EQ("Date", k);
+  ArrayList<string> in_range;
+  c.find(string("B"), string("CHERRY"), in_range);
+  ASSERT_EQ(2, in_range.size());
+  c.remove("CHERRY");
+  ASSERT_EQ(3, c.size());
+  ASSERT_EQ(false, c.find(string("cherry"), v));
+}
+
+template<typename Coll>
+void numeric_string_keys()
+{
+  Coll c;
+  for (int i = 100; i > 0; --i)
+    c.add(to_string(i), i);
+  ArrayList<string> sorted_keys;
+  c.sort(sorted_keys);
+  ASSERT_EQ(100, sorted_keys.size());
+  for (int i = 0; i < 100; ++i) {
+    string k;
+    sorted_keys.get(i, k);
+    ASSERT_EQ(to_string(i + 1), k);
+  }
+  int v = 0;
+  ASSERT_EQ(true, c.find(string("0042"), v));
+  ASSERT_EQ(42, v);
+  ArrayList<string> in_range;
+  c.find(string("9"), string("12"), in_range);
+  ASSERT_EQ(4, in_range.size());
+  c.remove("007");
+  ASSERT_EQ(99, c.size());
+  ASSERT_EQ(false, c.find(string("7"), v));
+}
+
+// Test 34 - tree collections order keys with a pluggable compare policy
+TEST(CollectionTest, ComparePolicies) {
+  case_insensitive_keys<RBTCollection<string,int,SlabAllocator,
+                                      CaseInsensitiveCompare>>();
+  case_insensitive_keys<AVLCollection<string,int,CaseInsensitiveCompare>>();
+  case_insensitive_keys<BSTCollection<string,int,CaseInsensitiveCompare>>();
+  case_insensitive_keys<BPlusTreeCollection<string,int,4,
+                                            CaseInsensitiveCompare>>();
+  case_insensitive_keys<CompactRBTCollection<string,int,
+                                             CaseInsensitiveCompare>>();
+  case_insensitive_keys<PersistentRBTCollection<string,int,
+                                                CaseInsensitiveCompare>>();
+  numeric_string_keys<BPlusTreeCollection<string,int,4,
+                                          NumericStringCompare>>();
+  numeric_string_keys<CompactRBTCollection<string,int,
+                                           NumericStringCompare>>();
+  numeric_string_keys<PersistentRBTCollection<string,int,
+                                              NumericStringCompare>>();
+  RBTCollection<string,int,SlabAllocator,NumericStringCompare> c;
+  for (int i = 200; i > 0; --i)
+    c.add(to_string(i), i);
+  ASSERT_EQ(true, c.valid_rbt());
+  ArrayList<string> sorted_keys;
+  c.sort(sorted_keys);
+  for (int i = 0; i < 200; ++i) {
+    string k;
+    sorted_keys.get(i, k);
+    ASSERT_EQ(to_string(i + 1), k);
+  }
+  int v = 0;
+  ASSERT_EQ(true, c.find(string("0042"), v));
+  ASSERT_EQ(42, v);
+  ASSERT_EQ(91, c.count("10", "100"));
+  ASSERT_EQ(8, c.rank("9"));
+  // ranges whose ends are out of order as plain strings
+  ASSERT_EQ(2, c.count("9", "10"));
+  ASSERT_EQ(0, c.count("10", "9"));
+  RBTCollection<string,int,SlabAllocator,CaseInsensitiveCompare> d;
+  d.add("apple", 1);
+  d.add("Banana", 2);
+  d.add("cherry", 3);
+  ASSERT_EQ(2, d.count("a", "Banana"));
+  ASSERT_EQ(0, d.count("Banana", "a"));
+}
+
+template<typename Coll>
+void count_words()
+{
+  Coll c;
+  // count each of 20 words, appearing 1 to 20 times, in place
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j <= i; ++j)
+      ++c.find_or_insert("w" + to_string((i * 7) % 20));
+  ASSERT_EQ(20, c.size());
+  for (int i = 0; i < 20; ++i) {
+    const Coll& read_only = c;
+    const int* count = read_only.find_ptr("w" + to_string((i * 7) % 20));
+    ASSERT_NE(nullptr, count);
+    ASSERT_EQ(i + 1, *count);
+  }
+  ASSERT_EQ(nullptr, c.find_ptr("w20"));
+  int* count = c.find_ptr("w3");
+  ASSERT_NE(nullptr, count);
+  *count = 100;
+  int v = 0;
+  ASSERT_EQ(true, c.find("w3", v));
+  ASSERT_EQ(100, v);
+  ASSERT_EQ(false, c.insert_or_assign("w3", 5));
+  ASSERT_EQ(true, c.insert_or_assign("w20", 6));
+  ASSERT_EQ(21, c.size());
+  ASSERT_EQ(true, c.find("w3", v));
+  ASSERT_EQ(5, v);
+  ASSERT_EQ(true, c.find("w20", v));
+  ASSERT_EQ(6, v);
+}
+
+// Test 35 - find_or_insert, insert_or_assign and find_ptr update values
+// in place in every collection
+TEST(CollectionTest, UpdateInPlace) {
+  count_words<RBTCollection<string,int>>();
+  count_words<ArrayListCollection<string,int>>();
+  count_words<BinSearchCollection<string,int>>();
+  count_words<HashTableCollection<string,int>>();
+  count_words<BSTCollection<string,int>>();
+  count_words<AVLCollection<string,int>>();
+  count_words<BPlusTreeCollection<string,int,4>>();
+  count_words<CompactRBTCollection<string,int>>();
+  count_words<PersistentRBTCollection<string,int>>();
+  count_words<ConcurrentCollection<string,int>>();
+  RBTCollection<string,int> c;
+  for (int i = 0; i < 500; ++i) {
+    c.find_or_insert(to_string(i % 250)) += i;
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  ASSERT_EQ(250, c.size());
+  int v = 0;
+  ASSERT_EQ(true, c.find("7", v));
+  ASSERT_EQ(7 + 257, v);
+}
+
+// Test 36 - updating a persistent collection in place leaves snapshots
+// unchanged
+TEST(PersistentRBTCollectionTest, UpdateInPlace) {
+  PersistentRBTCollection<int,int> c;
+  for (int i = 0; i < 100; ++i)
+    c.add(i, i);
+  PersistentRBTCollection<int,int> snap = c.snapshot();
+  c.find_or_insert(50) += 1000;
+  *c.find_ptr(7) = -7;
+  ++c.find_or_insert(100);
+  int v = 0;
+  ASSERT_EQ(true, c.find(50, v));
+  ASSERT_EQ(1050, v);
+  ASSERT_EQ(true, c.find(7, v));
+  ASSERT_EQ(-7, v);
+  ASSERT_EQ(true, c.find(100, v));
+  ASSERT_EQ(1, v);
+  ASSERT_EQ(true, snap.find(50, v));
+  ASSERT_EQ(50, v);
+  ASSERT_EQ(true, snap.find(7, v));
+  ASSERT_EQ(7, v);
+  ASSERT_EQ(false, snap.find(100, v));
+  ASSERT_EQ(true, c.valid_rbt());
+  ASSERT_EQ(101, c.size());
+  ASSERT_EQ(100, snap.size());
+  // missing keys copy nothing, and neither do paths already copied
+  size_t allocs = c.node_allocations();
+  ASSERT_EQ(nullptr, c.find_ptr(1000));
+  c.remove(1000);
+  *c.find_ptr(7) = -8;
+  ASSERT_EQ(allocs, c.node_allocations());
+  ASSERT_EQ(true, snap.find(7, v));
+  ASSERT_EQ(7, v);
+}
+
+// Test 37 - adds and finds starting from a hint keep a valid tree
+TEST(RBTCollectionTest, HintedAddAndFind) {
+  RBTCollection<int,int> c;
+  // ascending keys, each added next to the previous one
+  auto it = c.end();
+  for (int i = 0; i < 200; ++i) {
+    it = c.add_near(it, 2*i, i);
+    ASSERT_EQ(2*i, it.key());
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  // descending keys from the smallest key
+  it = c.begin();
+  for (int i = 1; i <= 50; ++i) {
+    it = c.add_near(it, -2*i, -i);
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  // odd keys with a far away (or wrong side) hint
+  it = c.begin();
+  for (int i = 0; i < 100; ++i) {
+    it = c.add_near(c.find_near(it, (i * 37) % 200 * 2), 2*i + 1, i);
+    ASSERT_EQ(2*i + 1, it.key());
+    ASSERT_EQ(true, c.valid_rbt());
+  }
+  ASSERT_EQ(350, c.size());
+  // rank/select use the subtree sizes kept by add_near
+  for (size_t r = 0; r < c.size(); ++r) {
+    int k = 0;
+    ASSERT_EQ(true, c.select(r, k));
+    ASSERT_EQ(r, c.rank(k));
+  }
+  // every key is found from every kind of hint
+  auto hint = c.begin();
+  for (int k = -100; k < 400; k += 3) {
+    auto found = c.find_near(hint, k);
+    bool in = (k < 0 && k % 2 == 0) || (k >= 0 && k < 200) ||
+              (k >= 200 && k < 400 && k % 2 == 0);
+    ASSERT_EQ(in, found != c.end());
+    if (in) {
+      ASSERT_EQ(k, found.key());
+      hint = found;
+    }
+    ASSERT_EQ(in, c.find_near(c.end(), k) != c.end());
+  }
+}
+
+// Test 38 - range removes from RBT and AVL trees keep exactly the keys
+// outside the range (and a valid, balanced tree)
+TEST(CollectionTest, RangeRemoveLarge) {
+  RBTCollection<int,int> c;
+  AVLCollection<int,int> a;
+  for (int i = 0; i < 1000; ++i) {
+    c.add((i * 7919) % 1000, i);
+    a.add((i * 7919) % 1000, i);
+  }
+  c.remove(100, 899);
+  a.remove(100, 899);
+  c.remove(-5, 9);
+  a.remove(-5, 9);
+  c.remove(990, 2000);
+  a.remove(990, 2000);
+  c.remove(50, 40);  // empty range
+  a.remove(50, 40);
+  ASSERT_EQ(true, c.valid_rbt());
+  ASSERT_EQ(180, c.size());
+  ASSERT_EQ(180, a.size());
+  ASSERT_GE(12, a.height());
+  ArrayList<int> ck, ak;
+  c.sort(ck);
+  a.sort(ak);
+  ASSERT_EQ(180, ck.size());
+  ASSERT_EQ(180, ak.size());
+  for (size_t i = 0; i < ck.size(); ++i) {
+    int expected = (i < 90) ? i + 10 : i + 810;
+    int k1 = 0, k2 = 0;
+    ck.get(i, k1);
+    ak.get(i, k2);
+    ASSERT_EQ(expected, k1);
+    ASSERT_EQ(expected, k2);
+    ASSERT_EQ(i, c.rank(k1));
+  }
+  // the trees keep working after the joins
+  for (int i = 100; i < 200; ++i) {
+    c.add(i, i);
+    a.add(i, i);
+  }
+  ASSERT_EQ(true, c.valid_rbt());
+  ASSERT_EQ(280, c.size());
+  ASSERT_EQ(280, a.size());
+}
+
+// Test 39 - find_many returns the same values as a find per key
+TEST(RBTCollectionTest, FindMany) {
+  RBTCollection<int,int> c;
+  ArrayList<int> keys;
+  ArrayList<int> values;
+  ArrayList<bool> found;
+  keys.add(1);
+  c.find_many(keys, values, found);  // empty tree
+  ASSERT_EQ(1, values.size());
+  ASSERT_EQ(false, found[0]);
+  for (int i = 0; i < 500; i += 2)
+    c.add(i, i * 10);
+  keys = ArrayList<int>();
+  for (int i = 0; i < 100; ++i)
+    keys.add((i * 37) % 520);  // more keys than run in lockstep
+  values = ArrayList<int>();
+  found = ArrayList<bool>();
+  c.find_many(keys, values, found);
+  ASSERT_EQ(100, values.size());
+  ASSERT_EQ(100, found.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    int v = -1;
+    bool f = c.find(keys[i], v);
+    ASSERT_EQ(f, found[i]);
+    if (f) {
+      ASSERT_EQ(v, values[i]);
+    }
+  }
+}
+
+// Test 40 - the statistics policy counts rebalancing work (and the
+// default policy counts nothing)
+TEST(RBTCollectionTest, RebalanceStats) {
+  RBTCollection<int,int> plain;
+  RBTCollection<int,int,SlabAllocator,ThreeWayCompare<int>,CountRBTStats> c;
+  for (int i = 0; i < 100; ++i) {
+    plain.add(i, i);
+    c.add(i, i);
+  }
+  ASSERT_EQ(0, plain.stats().adds);
+  ASSERT_EQ(0, plain.stats().single_rotations);
+  RBTStats s = c.stats();
+  ASSERT_EQ(100, s.adds);
+  ASSERT_EQ(0, s.removes);
+  ASSERT_LT(0, s.single_rotations);  // ascending keys rotate left
+  ASSERT_LT(0, s.color_flips);
+  ASSERT_LE(s.nodes_visited, 100 * c.height());
+  c.reset_stats();
+  ASSERT_EQ(0, c.stats().adds);
+  for (int i = 0; i < 100; i += 3)
+    c.remove(i);
+  s = c.stats();
+  ASSERT_EQ(34, s.removes);
+  ASSERT_EQ(34, s.sentinel_setups);
+  ASSERT_LT(0, s.nodes_visited);
+  ASSERT_EQ(true, c.valid_rbt());
+}
+
+// Test 41 - a saved tree loads back with the same pairs, and bad files
+// are rejected
+TEST(RBTCollectionTest, SaveAndLoad) {
+  const string path = "hw9test_save.bin";
+  RBTCollection<string,int> c;
+  for (int i = 0; i < 1000; ++i)
+    c.add(to_string((i * 7919) % 1000), i);
+  ASSERT_EQ(true, c.save(path));
+  RBTCollection<string,int> d;
+  d.add("x", 1);  // replaced by the load
+  ASSERT_EQ(true, d.load(path));
+  ASSERT_EQ(true, d.valid_rbt());
+  ASSERT_EQ(c.size(), d.size());
+  ArrayList<string> ck, dk;
+  c.sort(ck);
+  d.sort(dk);
+  for (size_t i = 0; i < ck.size(); ++i) {
+    ASSERT_EQ(ck[i], dk[i]);
+    int v1 = 0, v2 = 0;
+    ASSERT_EQ(true, c.find(ck[i], v1));
+    ASSERT_EQ(true, d.find(dk[i], v2));
+    ASSERT_EQ(v1, v2);
+    ASSERT_EQ(i, d.rank(dk[i]));
+  }
+  // an empty tree round trips too
+  RBTCollection<int,double> e;
+  ASSERT_EQ(true, e.save(path));
+  e.add(1, 1.5);
+  ASSERT_EQ(true, e.load(path));
+  ASSERT_EQ(0, e.size());
+  // a missing or truncated file leaves the collection empty
+  ASSERT_EQ(false, d.load("no/such/file.bin"));
+  ASSERT_EQ(0, d.size());
+  ASSERT_EQ(true, c.save(path));
+  ifstream in(path, ios::binary);
+  string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  in.close();
+  ofstream out(path, ios::binary | ios::trunc);
+  out.write(bytes.data(), bytes.size() / 2);
+  out.close();
+  ASSERT_EQ(false, d.load(path));
+  ASSERT_EQ(0, d.size());
+  // so are duplicate keys, and a count too big for the file (100 int
+  // pairs need 800 bytes, not 100)
+  RBTCollection<int,int> f;
+  for (int count : {2, 100}) {
+    ofstream bad(path, ios::binary | ios::trunc);
+    bad.write("RBT1", 4);
+    uint64_t n = count;
+    bad.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    int pairs[4] = {1, 10, 1, 20};
+    bad.write(reinterpret_cast<const char*>(pairs), sizeof(pairs));
+    if (count == 100)
+      bad.write(string(100 - sizeof(pairs), '\0').data(), 100 - sizeof(pairs));
+    bad.close();
+    ASSERT_EQ(false, f.load(path));
+    ASSERT_EQ(0, f.size());
+  }
+  remove(path.c_str());
+}
+
+// Test 42 - a frozen index answers finds and range finds like the
+// collection it was frozen from
+TEST(FrozenIndexTest, FreezeAndOpen) {
+  const string path = "hw9test_frozen.idx";
+  HashTableCollection<string,int> c;
+  for (int i = 0; i < 500; ++i)
+    c.add(to_string(i * 3), i);
+  ASSERT_EQ(true, (FrozenIndex<string,int>::freeze(c, path)));
+  FrozenIndex<string,int> f;
+  ASSERT_EQ(true, f.open(path));
+  ASSERT_EQ(500, f.size());
+  for (int i = 0; i < 1500; ++i) {
+    int v1 = -1, v2 = -1;
+    ASSERT_EQ(c.find(to_string(i), v1), f.find(to_string(i), v2));
+    ASSERT_EQ(v1, v2);
+  }
+  int v = 0;
+  ASSERT_EQ(true, f.find(string_view("42"), v));
+  ASSERT_EQ(14, v);
+  ArrayList<string> ck, fk;
+  c.find("10", "20", ck);
+  f.find("10", "20", fk);
+  ck.sort();
+  ASSERT_EQ(ck.size(), fk.size());
+  for (size_t i = 0; i < ck.size(); ++i)
+    ASSERT_EQ(ck[i], fk[i]);
+  ArrayList<string> all;
+  f.sort(all);
+  ASSERT_EQ(500, all.size());
+  for (size_t i = 1; i < all.size(); ++i)
+    ASSERT_LT(all[i - 1], all[i]);
+  // the index doesn't match other key/value types
+  FrozenIndex<int,int> wrong;
+  ASSERT_EQ(false, wrong.open(path));
+  ASSERT_EQ(false, wrong.open("no/such/file.idx"));
+  f.close();
+  ASSERT_EQ(0, f.size());
+  ASSERT_EQ(false, f.find("42", v));
+  remove(path.c_str());
+}
+
+// Test 43 - a logged collection recovers its writes from the log and
+// the last checkpoint, ignoring a torn record at the end of the log
+TEST(WALCollectionTest, LogAndRecover) {
+  const string snap = "hw9test_wal.snap", wal = "hw9test_wal.log";
+  remove(snap.c_str());
+  remove(wal.c_str());
+  {
+    WALCollection<string,int> c;
+    ASSERT_EQ(true, c.open(snap, wal, 8));
+    for (int i = 0; i < 100; ++i)
+      c.add(to_string(i), i);
+    c.remove("5");
+    c.insert_or_assign("7", 70);
+    c.find_or_insert("new");
+    ASSERT_EQ(103 % 8, c.pending());
+  }  // the destructor syncs the last group
+  {
+    WALCollection<string,int> c;
+    ASSERT_EQ(true, c.open(snap, wal));
+    ASSERT_EQ(100, c.size());
+    ASSERT_EQ(true, c.wrapped().valid_rbt());
+    int v = 0;
+    ASSERT_EQ(false, c.find("5", v));
+    ASSERT_EQ(true, c.find("7", v));
+    ASSERT_EQ(70, v);
+    ASSERT_EQ(true, c.find("new", v));
+    ASSERT_EQ(0, v);
+    ASSERT_EQ(true, c.checkpoint());
+    c.remove("new");
+    c.add("after", 1);
+  }
+  // a torn write at the end of the log is dropped
+  {
+    ofstream out(wal, ios::binary | ios::app);
+    out.write("\x30\0\0\0garbage", 11);
+  }
+  WALCollection<string,int> c;
+  ASSERT_EQ(true, c.open(snap, wal));
+  ASSERT_EQ(100, c.size());
+  int v = 0;
+  ASSERT_EQ(false, c.find("new", v));
+  ASSERT_EQ(true, c.find("after", v));
+  ASSERT_EQ(1, v);
+  ASSERT_EQ(true, c.find("99", v));
+  ASSERT_EQ(99, v);
+  // new records follow the valid ones
+  c.add("last", 2);
+  ASSERT_EQ(true, c.sync());
+  WALCollection<string,int> d;
+  ASSERT_EQ(true, d.open(snap, wal));
+  ASSERT_EQ(101, d.size());
+  ASSERT_EQ(true, d.find("last", v));
+  ASSERT_EQ(2, v);
+  // works over any collection, snapshotting through the Collection API
+  const string snap2 = "hw9test_wal2.snap", wal2 = "hw9test_wal2.log";
+  remove(snap2.c_str());
+  remove(wal2.c_str());
+  {
+    WALCollection<int,double,HashTableCollection<int,double>> h;
+    ASSERT_EQ(true, h.open(snap2, wal2));
+    for (int i = 0; i < 50; ++i)
+      h.add(i, i * 0.5);
+    ASSERT_EQ(true, h.checkpoint());
+    h.remove(0);
+  }
+  WALCollection<int,double,HashTableCollection<int,double>> h;
+  ASSERT_EQ(true, h.open(snap2, wal2));
+  ASSERT_EQ(49, h.size());
+  double dv = 0;
+  ASSERT_EQ(true, h.find(49, dv));
+  ASSERT_EQ(24.5, dv);
+  remove(snap.c_str());
+  remove(wal.c_str());
+  remove(snap2.c_str());
+  remove(wal2.c_str());
+}
+
+// Test 44 - every collection counts its nodes or arrays and the
+// memory held by long string keys and values
+TEST(MemoryUsageTest, AllCollections) {
+  const string long_value(100, 'v');
+  vector<Collection<string,string>*> colls = {
+    new ArrayListCollection<string,string>, new BinSearchCollection<string,string>,
+    new HashTableCollection<string,string>, new BSTCollection<string,string>,
+    new AVLCollection<string,string>, new RBTCollection<string,string>,
+    new BPlusTreeCollection<string,string>, new CompactRBTCollection<string,string>,
+    new PersistentRBTCollection<string,string>, new ConcurrentCollection<string,string>};
+  for (Collection<string,string>* c : colls) {
+    size_t empty = c->memory_usage();
+    for (int i = 0; i < 100; ++i)
+      c->add(to_string(i), "v");
+    size_t short_strings = c->memory_usage();
+    ASSERT_GE(short_strings, empty + 100 * 2 * sizeof(string));
+    for (int i = 0; i < 100; ++i)
+      c->insert_or_assign(to_string(i), long_value);
+    // each value now holds a heap buffer of at least 101 bytes
+    ASSERT_GE(c->memory_usage(), short_strings + 100 * 101);
+    for (int i = 0; i < 100; ++i)
+      c->remove(to_string(i));
+    ASSERT_EQ(0, c->size());
+    delete c;
+  }
+  // unused list capacity is counted
+  ArrayListCollection<int,int> a;
+  size_t ten = a.memory_usage();
+  a.add(1, 1);
+  ASSERT_EQ(ten, a.memory_usage());
+  // so is the bucket array: each add costs one node, except the add
+  // that grows the table from 16 to 32 buckets
+  HashTableCollection<int,int> h;
+  size_t node_bytes = 0, growth = 0;
+  for (int i = 0; i < 20; ++i) {
+    size_t before = h.memory_usage();
+    h.add(i, i);
+    size_t delta = h.memory_usage() - before;
+    if (i == 0)
+      node_bytes = delta;
+    else if (delta != node_bytes) {
+      ASSERT_EQ(0, growth);
+      growth = delta - node_bytes;
+    }
+  }
+  ASSERT_EQ(16 * sizeof(void*), growth);
+  // a list value counts its array and its items
+  RBTCollection<int,ArrayList<string>> lists;
+  ArrayList<string> l;
+  l.add(long_value);
+  lists.add(1, l);
+  ASSERT_GE(lists.memory_usage(), 10 * sizeof(string) + 101);
+}
+
+// Test 45 - one pass over the tree checks it and reports its shape
+TEST(RBTCollectionTest, Profile) {
+  RBTCollection<int,int> c;
+  RBTShape empty = c.profile();
+  ASSERT_EQ(true, empty.valid);
+  ASSERT_EQ(0, empty.nodes);
+  ASSERT_EQ(0, empty.height);
+  for (int i = 0; i < 4096; ++i)
+    c.add(i, i);
+  RBTShape shape = c.profile();
+  ASSERT_EQ(true, shape.valid);
+  ASSERT_EQ(4096, shape.nodes);
+  ASSERT_EQ(c.height(), shape.height);
+  // a red-black tree with n nodes is no taller than 2 log(n + 1)
+  ASSERT_GE(2 * 13, shape.height);
+  ASSERT_LE(shape.black_height, shape.height);
+  ASSERT_GE(2 * shape.black_height, shape.height);
+  ASSERT_LE(shape.avg_depth, shape.height);
+  ASSERT_GE(shape.avg_depth, 11.0);
+  ASSERT_EQ(shape.red_nodes / 4096.0, shape.red_ratio);
+  for (int i = 0; i < 4096; i += 2)
+    c.remove(i);
+  shape = c.profile();
+  ASSERT_EQ(true, shape.valid);
+  ASSERT_EQ(2048, shape.nodes);
+  ASSERT_LE(shape.red_ratio, 1.0);
+}
+
+// Test 46 - a BST built from sorted keys (a list-shaped tree) still
+// copies, traverses, removes and deletes correctly
+TEST(BSTCollectionTest, SortedInput) {
+  BSTCollection<int,int> c;
+  for (int i = 0; i < 10000; ++i)
+    c.add(i, i);
+  for (int i = -1; i >= -5000; --i)
+    c.add(i, i);  // a left-going spine from the root too
+  ASSERT_EQ(15000, c.size());
+  ASSERT_EQ(10000, c.height());
+  ArrayList<int> keys;
+  c.sort(keys);
+  ASSERT_EQ(15000, keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(int(i) - 5000, keys[i]);
+  ArrayList<int> in_range;
+  c.find(-10, 9, in_range);
+  ASSERT_EQ(20, in_range.size());
+  for (size_t i = 0; i < in_range.size(); ++i)
+    ASSERT_EQ(int(i) - 10, in_range[i]);
+  BSTCollection<int,int> d(c);
+  ASSERT_EQ(15000, d.size());
+  ASSERT_EQ(10000, d.height());
+  // the root (two children), its successor, a leaf, and a missing key
+  c.remove(0);
+  c.remove(1);
+  c.remove(9999);
+  c.remove(-5000);
+  c.remove(20000);
+  ASSERT_EQ(14996, c.size());
+  int v = 0;
+  ASSERT_EQ(false, c.find(0, v));
+  ASSERT_EQ(true, c.find(2, v));
+  ASSERT_EQ(true, d.find(0, v));
+  ArrayList<int> remaining;
+  c.sort(remaining);
+  ASSERT_EQ(14996, remaining.size());
+  for (size_t i = 1; i < remaining.size(); ++i)
+    ASSERT_LT(remaining[i - 1], remaining[i]);
+  d = c;
+  ASSERT_EQ(14996, d.size());
+}
+
+// Test 47 - a hash-sharded collection spreads keys over its shards,
+// takes writers on every shard at once, and merges ordered results
+TEST(ShardedCollectionTest, HashShards) {
+  ShardedCollection<int,int> c(HashPartition<int>(8));
+  ASSERT_EQ(8, c.shard_count());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c, t]() {
+      for (int i = t; i < 4000; i += 4)
+        c.add(i, i * 2);
+    }));
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  ASSERT_EQ(4000, c.size());
+  std::vector<int> per_shard(8, 0);
+  for (int i = 0; i < 4000; ++i)
+    ++per_shard[c.shard_of(i)];
+  for (int i = 0; i < 8; ++i)
+    ASSERT_GT(per_shard[i], 300);
+  int v = 0;
+  ASSERT_EQ(true, c.find(1234, v));
+  ASSERT_EQ(2468, v);
+  c.remove(1234);
+  c.remove(5000);
+  ASSERT_EQ(false, c.find(1234, v));
+  ASSERT_EQ(true, c.insert_or_assign(1234, 7));
+  ASSERT_EQ(false, c.insert_or_assign(1234, 8));
+  ASSERT_EQ(8, *c.find_ptr(1234));
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(4000, sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+    ASSERT_EQ(int(i), sorted[i]);
+  ArrayList<int> in_range;
+  c.find(100, 199, in_range);
+  ASSERT_EQ(100, in_range.size());
+  for (size_t i = 0; i < in_range.size(); ++i)
+    ASSERT_EQ(100 + int(i), in_range[i]);
+  ASSERT_GT(c.memory_usage(), 4000 * (sizeof(int) * 2));
+  // counters bumped from several threads under the shard locks
+  threads.clear();
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c]() {
+      for (int i = 0; i < 2000; ++i)
+        c.update(5000 + i % 16, [](int& count) {++count;});
+    }));
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  ASSERT_EQ(4016, c.size());
+  ASSERT_EQ(true, c.find(5007, v));
+  ASSERT_EQ(500, v);
+}
+
+// Test 48 - a range-sharded collection of unordered shards returns
+// range finds and sorted keys in order, visiting shards in turn
+TEST(ShardedCollectionTest, RangeShards) {
+  ArrayList<int> sample;
+  for (int i = 999; i >= 0; --i)
+    sample.add(i);
+  typedef RangePartition<int> Range;
+  ShardedCollection<int,int,HashTableCollection<int,int>,Range> c(Range::from_sample(sample, 4));
+  ASSERT_EQ(4, c.shard_count());
+  ASSERT_EQ(0, c.shard_of(-5));
+  ASSERT_EQ(0, c.shard_of(249));
+  ASSERT_EQ(1, c.shard_of(250));
+  ASSERT_EQ(3, c.shard_of(750));
+  ASSERT_EQ(3, c.shard_of(5000));
+  for (int i = 0; i < 1000; ++i)
+    c.add((i * 7) % 1000, i);
+  ASSERT_EQ(1000, c.size());
+  ArrayList<int> sorted;
+  c.sort(sorted);
+  ASSERT_EQ(1000, sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+    ASSERT_EQ(int(i), sorted[i]);
+  // a range across three shards
+  ArrayList<int> in_range;
+  c.find(200, 799, in_range);
+  ASSERT_EQ(600, in_range.size());
+  for (size_t i = 0; i < in_range.size(); ++i)
+    ASSERT_EQ(200 + int(i), in_range[i]);
+  ArrayList<int> empty;
+  c.find(10, 5, empty);
+  ASSERT_EQ(0, empty.size());
+  ArrayList<int> all;
+  c.keys(all);
+  ASSERT_EQ(1000, all.size());
+}
+
+// Test 49 - a log write that fails part way is cut back to the last
+// synced record, later writes are refused, and recovery keeps
+// everything synced before the failure
+TEST(WALCollectionTest, WriteFailure) {
+  const string snap = "hw9test_walfail.snap", wal = "hw9test_walfail.log";
+  remove(snap.c_str());
+  remove(wal.c_str());
+  {
+    WALCollection<string,int> c;
+    ASSERT_EQ(true, c.open(snap, wal));
+    for (int i = 0; i < 10; ++i)
+      c.add(to_string(i), i);
+    ifstream before(wal, ios::binary | ios::ate);
+    streamoff synced = before.tellg();
+    // a file size limit just past the end tears the next record
+    rlimit old_limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &old_limit));
+    rlimit limit = old_limit;
+    limit.rlim_cur = synced + 8;
+    void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+    c.add("torn", 10);
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    signal(SIGXFSZ, old_handler);
+    ASSERT_EQ(true, c.failed());
+    int v = 0;
+    ASSERT_EQ(false, c.find("torn", v));
+    c.add("refused", 11);
+    c.remove("3");
+    ASSERT_EQ(false, c.insert_or_assign("refused", 12));
+    ASSERT_EQ(false, c.find("refused", v));
+    c.update("4", [](int& val) {val = 40;});
+    c.update("refused", [](int& val) {val = 13;});
+    ASSERT_EQ(true, c.find("4", v));
+    ASSERT_EQ(4, v);
+    ASSERT_EQ(false, c.find("refused", v));
+    ASSERT_EQ(true, c.find("3", v));
+    ASSERT_EQ(false, c.sync());
+    ASSERT_EQ(false, c.checkpoint());
+    ASSERT_EQ(10, c.size());
+    ifstream after(wal, ios::binary | ios::ate);
+    ASSERT_EQ(synced, after.tellg());
+  }
+  WALCollection<string,int> c;
+  ASSERT_EQ(true, c.open(snap, wal));
+  ASSERT_EQ(false, c.failed());
+  ASSERT_EQ(10, c.size());
+  c.add("after", 1);
+  ASSERT_EQ(true, c.sync());
+  WALCollection<string,int> d;
+  ASSERT_EQ(true, d.open(snap, wal));
+  ASSERT_EQ(11, d.size());
+  remove(snap.c_str());
+  remove(wal.c_str());
+}
+
+// Test 50 - update changes values in place under the lock, so
+// counters bumped from several threads don't lose increments
+TEST(ConcurrentCollectionTest, Update) {
+  ConcurrentCollection<string,int> c;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c]() {
+      for (int i = 0; i < 5000; ++i)
+        c.update("w" + to_string(i % 10), [](int& count) {++count;});
+    }));
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  ASSERT_EQ(10, c.size());
+  for (int i = 0; i < 10; ++i) {
+    int v = 0;
+    ASSERT_EQ(true, c.find("w" + to_string(i), v));
+    ASSERT_EQ(2000, v);
+  }
+}
+
+// Test 51 - values changed with update are logged, so they survive
+// recovery like any other write
+TEST(WALCollectionTest, LoggedUpdate) {
+  const string snap = "hw9test_walupd.snap", wal = "hw9test_walupd.log";
+  remove(snap.c_str());
+  remove(wal.c_str());
+  {
+    WALCollection<string,int> c;
+    ASSERT_EQ(true, c.open(snap, wal, 16));
+    for (int i = 0; i < 50; ++i)
+      c.update("w" + to_string(i % 5), [](int& count) {++count;});
+    ASSERT_EQ(5, c.size());
+    c.add("x", 1);
+    c.update("x", [](int& val) {val *= 7;});
+    int v = 0;
+    ASSERT_EQ(true, c.find("x", v));
+    ASSERT_EQ(7, v);
+  }  // the destructor syncs the last group
+  WALCollection<string,int> c;
+  ASSERT_EQ(true, c.open(snap, wal));
+  ASSERT_EQ(6, c.size());
+  int v = 0;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(true, c.find("w" + to_string(i), v));
+    ASSERT_EQ(10, v);
+  }
+  ASSERT_EQ(true, c.find("x", v));
+  ASSERT_EQ(7, v);
+  remove(snap.c_str());
+  remove(wal.c_str());
+}
+
+// Test 52 - range shards route, find and order keys with the shards'
+// compare policy
+TEST(ShardedCollectionTest, ComparePolicy) {
+  typedef RBTCollection<string,int,SlabAllocator,CaseInsensitiveCompare> Tree;
+  typedef RangePartition<string,CaseInsensitiveCompare> Range;
+  const char* words[] = {"honey", "Apple", "fig", "Cherry", "date",
+                         "Grape", "banana", "Elder"};
+  ArrayList<string> sample;
+  for (int i = 0; i < 8; ++i)
+    sample.add(words[i]);
+  ShardedCollection<string,int,Tree,Range,RWLock,CaseInsensitiveCompare>
+    c(Range::from_sample(sample, 3));
+  ASSERT_EQ(3, c.shard_count());
+  for (int i = 0; i < 8; ++i)
+    c.add(words[i], i);
+  ASSERT_EQ(c.shard_of("apple"), c.shard_of("APPLE"));
+  ASSERT_EQ(c.shard_of("grape"), c.shard_of("GRAPE"));
+  int v = 0;
+  for (int i = 0; i < 8; ++i) {
+    string upper = words[i];
+    for (size_t j = 0; j < upper.size(); ++j)
+      upper[j] = toupper(upper[j]);
+    ASSERT_EQ(true, c.find(upper, v));
+    ASSERT_EQ(i, v);
+  }
+  ArrayList<string> sorted;
+  c.sort(sorted);
+  const char* in_order[] = {"Apple", "banana", "Cherry", "date", "Elder",
+                            "fig", "Grape", "honey"};
+  ASSERT_EQ(8, sorted.size());
+  for (int i = 0; i < 8; ++i)
+    ASSERT_EQ(in_order[i], sorted[i]);
+  ArrayList<string> in_range;
+  c.find("B", "ELDER", in_range);
+  ASSERT_EQ(4, in_range.size());
+  for (int i = 0; i < 4; ++i)
+    ASSERT_EQ(in_order[i + 1], in_range[i]);
+  ArrayList<string> empty;
+  c.find("fig", "apple", empty);
+  ASSERT_EQ(0, empty.size());
 }
 
 int main(int argc, char** argv)
@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------
+// FILE: key_compare.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Key comparison policies for the tree collections. A policy is
+// a default-constructible type whose call operator does a three-way
+// compare of two keys (or a key and a key-like lookup value):
+//
+//   compare(a, b) < 0   a orders before b
+//   compare(a, b) == 0  a and b are the same key
+//   compare(a, b) > 0   a orders after b
+//
+// so a tree visits each node with one compare instead of separate ==,
+// < and > tests.
+//
+//   ThreeWayCompare<K>     the natural (operator<) order of K, with
+//                          strings compared in a single pass
+//   CaseInsensitiveCompare strings ignoring ASCII letter case
+//   NumericStringCompare   strings of decimal digits by numeric value
+//                          ("9" < "10", "007" == "7")
+//----------------------------------------------------------------------
+
+#ifndef KEY_COMPARE_H
+#define KEY_COMPARE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+template<typename K>
+struct ThreeWayCompare
+{
+  template<typename A, typename B>
+  int operator()(const A& a, const B& b) const
+  {
+    if(a < b) return -1;
+    return (b < a) ? 1 : 0;
+  }
+};
+
+
+template<>
+struct ThreeWayCompare<std::string>
+{
+  int operator()(std::string_view a, std::string_view b) const
+  {
+    return a.compare(b);
+  }
+};
+
+
+struct CaseInsensitiveCompare
+{
+  int operator()(std::string_view a, std::string_view b) const
+  {
+    size_t n = a.size() < b.size() ? a.size() : b.size();
+    for(size_t i = 0; i < n; ++i){
+      char x = lower(a[i]);
+      char y = lower(b[i]);
+      if(x != y) return (unsigned char)x < (unsigned char)y ? -1 : 1;
+    }
+    if(a.size() == b.size()) return 0;
+    return a.size() < b.size() ? -1 : 1;
+  }
+
+private:
+  static char lower(char c) {return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;}
+};
+
+
+struct NumericStringCompare
+{
+  int operator()(std::string_view a, std::string_view b) const
+  {
+    a = strip_zeros(a);
+    b = strip_zeros(b);
+    // with no leading zeros, the longer number is the larger one
+    if(a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    return a.compare(b);
+  }
+
+private:
+  static std::string_view strip_zeros(std::string_view s)
+  {
+    size_t i = 0;
+    while(i < s.size() && s[i] == '0') ++i;
+    return s.substr(i);
+  }
+};
+
+
+#endif
@@ -0,0 +1,398 @@
+//----------------------------------------------------------------------
+// FILE: node_allocator.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Node allocation policies for the tree collections. A policy
+// is a class template over the node type that hands out constructed
+// nodes and takes them back:
+//
+//   allocate(args...)  construct a node from args and return it
+//   allocate_block(n)  construct n default nodes in one contiguous
+//                      block, or return nullptr if unsupported
+//   deallocate(n)      destroy n and give its storage back
+//   destroy(n)         run n's destructor only (storage kept until
+//                      release)
+//   release()          drop every node handed out at once, without
+//                      running destructors
+//   bulk_release       true if release() actually frees storage, in
+//                      which case destroy() + release() replaces a
+//                      deallocate() per node
+//   owns_storage()     true if release() can drop the nodes of this
+//                      allocator only (no other allocator shares them)
+//   absorb(rhs)        take over the nodes handed out by rhs, which
+//                      starts over empty
+//   share(rhs)         hand out and take back nodes from the same
+//                      storage as rhs
+//   system_allocations() number of calls made to the system allocator
+//
+// HeapAllocator does one new/delete per node. SlabAllocator carves
+// nodes out of large slabs, reuses freed nodes through a free list,
+// and releases all slabs at once. Its slabs live in an arena that is
+// normally owned by one tree; trees that exchange nodes (join, split,
+// set operations) merge or share arenas instead of copying nodes.
+// Collections sharing an arena must not be modified concurrently.
+//----------------------------------------------------------------------
+
+#ifndef NODE_ALLOCATOR_H
+#define NODE_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+template<typename Node>
+class HeapAllocator
+{
+public:
+  static const bool bulk_release = false;
+
+  HeapAllocator() : allocations(0) {}
+
+  template<typename... Args>
+  Node* allocate(Args&&... args)
+  {
+    ++allocations;
+    return new Node(std::forward<Args>(args)...);
+  }
+
+  Node* allocate_block(size_t) { return nullptr; }
+  void deallocate(Node* n) { delete n; }
+  void destroy(Node* n) { delete n; }
+  void release() {}
+  bool owns_storage() const { return true; }
+  void absorb(HeapAllocator<Node>&) {}
+  void share(HeapAllocator<Node>&) {}
+  size_t system_allocations() const { return allocations; }
+
+private:
+  size_t allocations; // number of calls to new
+};
+
+
+template<typename Node>
+class SlabAllocator
+{
+public:
+  static const bool bulk_release = true;
+
+  SlabAllocator();
+
+  // construct a new node (from the free list if possible)
+  template<typename... Args>
+  Node* allocate(Args&&... args);
+
+  // construct n default nodes in one contiguous block
+  Node* allocate_block(size_t n);
+
+  // destroy the node and push its storage onto the free list
+  void deallocate(Node* n);
+
+  // destroy the node, leaving its storage to release()
+  void destroy(Node* n);
+
+  // free every slab if no other allocator shares them (destructors
+  // must already have been run), otherwise start over with a new arena
+  void release();
+
+  // check if no other allocator shares the arena
+  bool owns_storage();
+
+  // take over all nodes of rhs (rhs starts over with a new arena)
+  void absorb(SlabAllocator<Node>& rhs);
+
+  // use the same arena as rhs
+  void share(SlabAllocator<Node>& rhs);
+
+  // number of slabs requested from the system allocator
+  size_t system_allocations() const;
+
+private:
+  // slab header, followed by the node storage
+  struct Slab {
+    Slab* next;
+    size_t capacity;
+  };
+
+  // freed node storage is reused as a free-list link
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  // slabs and free list (possibly shared by several allocators)
+  struct Arena {
+    Slab* slabs;  // most recently allocated slab (list of all slabs)
+    size_t used;  // nodes handed out from the front slab
+    size_t next_capacity; // node count for the next slab
+    FreeNode* free_list;  // freed nodes available for reuse
+    size_t allocations; // number of slabs allocated
+    std::shared_ptr<Arena> forward; // arena the slabs were moved into
+
+    Arena();
+    ~Arena();
+  };
+
+  static const size_t MIN_SLAB_NODES = 64;
+  static const size_t MAX_SLAB_NODES = 4096;
+
+  std::shared_ptr<Arena> arena;
+
+  // no copies (each tree owns its own arena)
+  SlabAllocator(const SlabAllocator<Node>& rhs);
+  SlabAllocator<Node>& operator=(const SlabAllocator<Node>& rhs);
+
+  // the arena in use (following and shortening forwards)
+  Arena* current();
+
+  // size of the slab header, rounded up to the node alignment
+  static size_t header_size();
+
+  // first node slot of a slab
+  static Node* slab_nodes(Slab* s);
+
+  // get storage for one node
+  void* allocate_slot();
+
+  // allocate a new slab that holds at least n nodes
+  void add_slab(Arena* a, size_t n);
+};
+
+
+template<typename Node>
+SlabAllocator<Node>::Arena::Arena()
+  : slabs(nullptr), used(0), next_capacity(MIN_SLAB_NODES),
+    free_list(nullptr), allocations(0)
+{
+}
+
+template<typename Node>
+SlabAllocator<Node>::Arena::~Arena()
+{
+  while(slabs){
+    Slab* tmp = slabs->next;
+    ::operator delete(slabs);
+    slabs = tmp;
+  }
+}
+
+template<typename Node>
+SlabAllocator<Node>::SlabAllocator()
+  : arena(std::make_shared<Arena>())
+{
+}
+
+//  Function: allocate()
+//  Description: Constructs a node from the given arguments, reusing a
+//  freed node if there is one, otherwise taking the next slot of the
+//  current slab
+//  Inputs: Node constructor arguments
+//  Outputs: The new node
+template<typename Node>
+template<typename... Args>
+Node* SlabAllocator<Node>::allocate(Args&&... args)
+{
+  return new (allocate_slot()) Node(std::forward<Args>(args)...);
+}
+
+//  Function: allocate_block()
+//  Description: Constructs n default nodes in a dedicated slab of
+//  exactly n nodes, so they are contiguous (the current slab keeps
+//  handing out its remaining nodes)
+//  Inputs: Number of nodes
+//  Outputs: The first node of the block
+template<typename Node>
+Node* SlabAllocator<Node>::allocate_block(size_t n)
+{
+  Arena* a = current();
+  Slab* s = static_cast<Slab*>(::operator new(header_size() + n * sizeof(Node)));
+  s->capacity = n;
+  ++a->allocations;
+  // link the block in behind the front slab
+  if(a->slabs){
+    s->next = a->slabs->next;
+    a->slabs->next = s;
+  }
+  else{
+    s->next = nullptr;
+    a->slabs = s;
+    a->used = n;
+  }
+  Node* block = slab_nodes(s);
+  for(size_t i = 0; i < n; ++i)
+    new (block + i) Node();
+  return block;
+}
+
+//  Function: deallocate()
+//  Description: Destroys the node and puts its storage on the free list
+//  Inputs: Node to deallocate
+//  Outputs: None
+template<typename Node>
+void SlabAllocator<Node>::deallocate(Node* n)
+{
+  Arena* a = current();
+  n->~Node();
+  FreeNode* f = reinterpret_cast<FreeNode*>(n);
+  f->next = a->free_list;
+  a->free_list = f;
+}
+
+//  Function: destroy()
+//  Description: Runs the node's destructor without reclaiming storage
+//  Inputs: Node to destroy
+//  Outputs: None
+template<typename Node>
+void SlabAllocator<Node>::destroy(Node* n)
+{
+  n->~Node();
+}
+
+//  Function: release()
+//  Description: Frees all slabs in one pass over the slab list (not the
+//  nodes), leaving the allocator empty. If another allocator shares the
+//  arena, the slabs are left to it and this allocator starts over.
+//  Inputs: None
+//  Outputs: None
+template<typename Node>
+void SlabAllocator<Node>::release()
+{
+  if(owns_storage() && !arena->slabs) return; // nothing to free
+  arena = std::make_shared<Arena>();
+}
+
+//  Function: owns_storage()
+//  Description: Checks if this is the only allocator using its arena
+//  Inputs: None
+//  Outputs: True if no other allocator shares the arena
+template<typename Node>
+bool SlabAllocator<Node>::owns_storage()
+{
+  current();
+  return arena.use_count() == 1;
+}
+
+//  Function: absorb()
+//  Description: Moves the slabs and free list of rhs's arena into this
+//  one, so the nodes handed out by rhs now belong here. Allocators
+//  still sharing rhs's old arena are forwarded to this one.
+//  Inputs: Allocator to take the nodes from
+//  Outputs: None
+template<typename Node>
+void SlabAllocator<Node>::absorb(SlabAllocator<Node>& rhs)
+{
+  Arena* a = current();
+  Arena* b = rhs.current();
+  if(a != b){
+    // append b's slabs behind our front slab (keeping our bump pointer)
+    if(b->slabs){
+      Slab* last = b->slabs;
+      while(last->next) last = last->next;
+      if(a->slabs){
+        last->next = a->slabs->next;
+        a->slabs->next = b->slabs;
+      }
+      else{
+        // we have no slabs yet, so b's front slab becomes ours
+        last->next = nullptr;
+        a->slabs = b->slabs;
+        a->used = b->used;
+        a->next_capacity = b->next_capacity;
+      }
+    }
+    // append b's free list to ours
+    if(b->free_list){
+      FreeNode* last = b->free_list;
+      while(last->next) last = last->next;
+      last->next = a->free_list;
+      a->free_list = b->free_list;
+    }
+    a->allocations += b->allocations;
+    b->slabs = nullptr;
+    b->free_list = nullptr;
+    b->allocations = 0;
+    b->forward = arena;
+  }
+  rhs.arena = std::make_shared<Arena>();
+}
+
+//  Function: share()
+//  Description: Switches this allocator to rhs's arena
+//  Inputs: Allocator to share with
+//  Outputs: None
+template<typename Node>
+void SlabAllocator<Node>::share(SlabAllocator<Node>& rhs)
+{
+  rhs.current();
+  arena = rhs.arena;
+}
+
+//  Function: system_allocations()
+//  Description: Returns how many slabs have been requested from the
+//  system allocator for the arena in use
+//  Inputs: None
+//  Outputs: Number of system allocations
+template<typename Node>
+size_t SlabAllocator<Node>::system_allocations() const
+{
+  const Arena* a = arena.get();
+  while(a->forward) a = a->forward.get();
+  return a->allocations;
+}
+
+// helper to find the arena in use
+template<typename Node>
+typename SlabAllocator<Node>::Arena* SlabAllocator<Node>::current()
+{
+  while(arena->forward){
+    std::shared_ptr<Arena> next = arena->forward;
+    arena = next;
+  }
+  return arena.get();
+}
+
+// helper to find the size of the slab header
+template<typename Node>
+size_t SlabAllocator<Node>::header_size()
+{
+  return (sizeof(Slab) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+}
+
+// helper to find the node storage of a slab
+template<typename Node>
+Node* SlabAllocator<Node>::slab_nodes(Slab* s)
+{
+  return reinterpret_cast<Node*>(reinterpret_cast<char*>(s) + header_size());
+}
+
+// helper to get storage for one node
+template<typename Node>
+void* SlabAllocator<Node>::allocate_slot()
+{
+  Arena* a = current();
+  // reuse a freed node first
+  if(a->free_list){
+    FreeNode* f = a->free_list;
+    a->free_list = f->next;
+    return f;
+  }
+  // otherwise bump allocate out of the front slab
+  if(!a->slabs || a->used == a->slabs->capacity) add_slab(a, a->next_capacity);
+  return slab_nodes(a->slabs) + a->used++;
+}
+
+// helper to allocate a new slab
+template<typename Node>
+void SlabAllocator<Node>::add_slab(Arena* a, size_t n)
+{
+  Slab* s = static_cast<Slab*>(::operator new(header_size() + n * sizeof(Node)));
+  s->next = a->slabs;
+  s->capacity = n;
+  a->slabs = s;
+  a->used = 0;
+  ++a->allocations;
+  // grow the slabs geometrically (up to a limit)
+  if(a->next_capacity < MAX_SLAB_NODES) a->next_capacity *= 2;
+}
+
+#endif
@@ -0,0 +1,767 @@
+//----------------------------------------------------------------------
+// FILE: persistent_rbt_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: A persistent Key-Value Collection implementation using a
+// (left-leaning) red-black tree. Nodes are shared between copies of
+// the collection and reference counted, so copying (taking a snapshot)
+// is O(1). add and remove copy only the nodes on the search path that
+// are shared with another copy, and a version's nodes are reclaimed
+// when its last copy is gone. Different copies may be used from
+// different threads.
+//----------------------------------------------------------------------
+
+#ifndef PERSISTENT_RBT_COLLECTION_H
+#define PERSISTENT_RBT_COLLECTION_H
+
+#include <atomic>
+#include <string>
+#include <iostream>
+#include "collection.h"
+#include "key_compare.h"
+#include "array_list.h"
+
+
+template<typename K, typename V, typename Compare = ThreeWayCompare<K>>
+class PersistentRBTCollection : public Collection<K,V>
+{
+public:
+
+  // create an empty collection
+  PersistentRBTCollection();
+
+  // copy constructor (shares the rhs tree)
+  PersistentRBTCollection(const PersistentRBTCollection<K,V,Compare>& rhs);
+
+  // assignment operator (shares the rhs tree)
+  PersistentRBTCollection<K,V,Compare>& operator=(const PersistentRBTCollection<K,V,Compare>& rhs);
+
+  // delete collection (the nodes no other copy uses)
+  ~PersistentRBTCollection();
+
+  // add a new key-value pair into the collection (replacing the value
+  // if the key is already there)
+  void add(const K& a_key, const V& a_val);
+
+  // remove a key-value pair from the collection
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // return the value associated with the key for in-place updates,
+  // adding the key with a default value if it isn't found (copies the
+  // shared nodes on the search path, so snapshots are not changed)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found (the non-const version copies the shared
+  // nodes on the search path, like find_or_insert)
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // find and return each key >= k1 and <= k2 (in ascending order)
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return a copy of the collection in its current state (O(1))
+  PersistentRBTCollection<K,V,Compare> snapshot() const;
+
+  // return the height of the tree
+  size_t height() const;
+
+  // number of nodes allocated by this copy of the collection
+  size_t node_allocations() const;
+
+  // return the number of bytes used by the collection (counting nodes
+  // shared with snapshots as if this copy owned them)
+  size_t memory_usage() const;
+
+  // for testing:
+
+  // check if tree satisfies the left-leaning red-black tree constraints
+  bool valid_rbt() const;
+
+  // pretty-print the red-black tree (with heights)
+  void print() const;
+
+
+private:
+
+  // LLRB node structure (only modified while the count is 1)
+  enum color_t {RED, BLACK};
+  struct Node {
+    K key;
+    V value;
+    Node* left;
+    Node* right;
+    color_t color;
+    std::atomic<size_t> refs;  // number of parents and roots using the node
+  };
+
+  // root node
+  Node* root;
+
+  // number of k-v pairs stored in the collection
+  size_t node_count;
+
+  // number of nodes allocated (not inherited by copies)
+  size_t allocations;
+
+  // helper to add a reference to a (possibly null) node
+  static Node* retain(Node* x);
+
+  // helper to drop a reference to a (possibly null) node, deleting
+  // the node (and dropping its child references) when it was the last
+  static void release(Node* x);
+
+  // helper to get a node that only this tree uses: h itself if it is
+  // not shared, otherwise a copy (consumes the reference to h)
+  Node* mut(Node* h);
+
+  // color helper (null nodes are BLACK)
+  static bool is_red(const Node* x);
+
+  // rotate and color-flip helpers (h must not be shared)
+  Node* rotate_left(Node* h);
+  Node* rotate_right(Node* h);
+  void flip_colors(Node* h);
+
+  // restore left-leaning constraints on the way up
+  Node* balance(Node* h);
+
+  // move a RED link down the left or right path
+  Node* move_red_left(Node* h);
+  Node* move_red_right(Node* h);
+
+  // recursive add and remove helpers (each takes and returns a
+  // reference to a subtree root); add sets found to the key's node and
+  // stores a_val there, or keeps the value (a default one for a new
+  // node) if a_val is nullptr
+  Node* add(Node* h, const K& a_key, const V* a_val, bool& added,
+            Node*& found);
+  Node* remove(Node* h, const K& a_key);
+  Node* remove_min(Node* h);
+
+  // three-way compare of two keys using the comparison policy
+  static int compare(const K& a, const K& b) {return Compare()(a, b);}
+
+  // helper to find the node with a key (nullptr if none)
+  const Node* find_node(const K& search_key) const;
+
+  // longest search path find_ptr records (an LLRB tree is at most
+  // 2 lg(n + 1) high)
+  static const size_t MAX_PATH = 2 * 64;
+
+  // helper to recursively collect a range of keys
+  void find(const Node* subtree_root, const K& k1, const K& k2,
+            ArrayList<K>& keys) const;
+
+  // helper to build sorted list of keys (used by keys and sort)
+  void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
+
+  // helper to total the keys' and values' dynamic memory
+  size_t dynamic_memory(const Node* subtree_root) const;
+
+  // height helper
+  size_t height(const Node* subtree_root) const;
+
+  // validate helper (returns the black height, or -1 if invalid)
+  int valid_rbt(const Node* subtree_root, const K* lo, const K* hi) const;
+
+  // recursive pretty-print helper
+  void print_tree(std::string indent, const Node* subtree_root) const;
+};
+
+
+template<typename K, typename V, typename Compare>
+PersistentRBTCollection<K,V,Compare>::PersistentRBTCollection()
+  : root(nullptr), node_count(0), allocations(0)
+{
+}
+
+template<typename K, typename V, typename Compare>
+PersistentRBTCollection<K,V,Compare>::PersistentRBTCollection(const PersistentRBTCollection<K,V,Compare>& rhs)
+  : root(retain(rhs.root)), node_count(rhs.node_count), allocations(0)
+{
+}
+
+template<typename K, typename V, typename Compare>
+PersistentRBTCollection<K,V,Compare>::~PersistentRBTCollection()
+{
+  release(root);
+}
+
+template<typename K, typename V, typename Compare>
+PersistentRBTCollection<K,V,Compare>&
+PersistentRBTCollection<K,V,Compare>::operator=(const PersistentRBTCollection<K,V,Compare>& rhs)
+{
+  if(this != &rhs){
+    Node* old_root = root;
+    root = retain(rhs.root);
+    node_count = rhs.node_count;
+    release(old_root);
+  }
+  return *this;
+}
+
+//  Function: add()
+//  Description: Adds a key-value pair, copying the shared nodes on the
+//  search path, then rebalancing on the way back up
+//  Inputs: Key and value to be added to the tree
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::add(const K& a_key, const V& a_val)
+{
+  insert_or_assign(a_key, a_val);
+}
+
+//  Function: remove()
+//  Description: Removes the pair with the given key (if any), copying
+//  the shared nodes on the search path
+//  Inputs: The key of the pair to be removed
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::remove(const K& a_key)
+{
+  if(!find_node(a_key)) return;  // nothing to copy if the key is missing
+  // make the root RED if both children are BLACK
+  if(!is_red(root->left) && !is_red(root->right)){
+    root = mut(root);
+    root->color = RED;
+  }
+  root = remove(root, a_key);
+  if(is_red(root)){
+    root = mut(root);
+    root->color = BLACK;
+  }
+  node_count--;
+}
+
+//  Function: find()
+//  Description: Finds the value of the given key
+//  Inputs: Key to search for, variable for the value
+//  Outputs: True if the key was found
+template<typename K, typename V, typename Compare>
+bool PersistentRBTCollection<K,V,Compare>::find(const K& search_key, V& the_val) const
+{
+  const Node* x = find_node(search_key);
+  if(!x) return false;
+  the_val = x->value;
+  return true;
+}
+
+//  Function: find_or_insert()
+//  Description: Returns the value of the given key in a node only this
+//  copy uses, adding the key with a default value if it is missing, in
+//  one path-copying descent (like insert_or_assign)
+//  Inputs: Key to search for
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename Compare>
+V& PersistentRBTCollection<K,V,Compare>::find_or_insert(const K& a_key)
+{
+  bool added = false;
+  Node* found = nullptr;
+  root = add(root, a_key, nullptr, added, found);
+  if(is_red(root)){
+    root = mut(root);
+    root->color = BLACK;
+  }
+  if(added) node_count++;
+  return found->value;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds a key-value pair or replaces the value of the key,
+//  copying the shared nodes on the search path, then rebalancing on the
+//  way back up
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename Compare>
+bool PersistentRBTCollection<K,V,Compare>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  bool added = false;
+  Node* found = nullptr;
+  root = add(root, a_key, &a_val, added, found);
+  if(is_red(root)){
+    root = mut(root);
+    root->color = BLACK;
+  }
+  if(added) node_count++;
+  return added;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value of the given key in place. The search
+//  remembers its path, and if the key is found on a path with shared
+//  nodes, those are copied from the root down (nothing is copied if
+//  the key is missing or the path isn't shared).
+//  Inputs: Key to search for
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V, typename Compare>
+V* PersistentRBTCollection<K,V,Compare>::find_ptr(const K& a_key)
+{
+  Node* path[MAX_PATH];
+  size_t depth = 0;
+  bool shared = false;
+  Node* x = root;
+  while(x){
+    path[depth++] = x;
+    if(x->refs.load(std::memory_order_acquire) != 1) shared = true;
+    int c = compare(a_key, x->key);
+    if(c < 0)
+      x = x->left;
+    else if(c > 0)
+      x = x->right;
+    else
+      break;
+  }
+  if(!x) return nullptr;
+  if(!shared) return &x->value;
+  // a node below a copied one is shared by the copy, so every node
+  // from the first shared one down is copied
+  Node** link = &root;
+  for(size_t i = 0; i < depth; ++i){
+    *link = mut(path[i]);
+    if(i + 1 < depth)
+      link = ((*link)->left == path[i + 1]) ? &(*link)->left : &(*link)->right;
+  }
+  return &(*link)->value;
+}
+
+template<typename K, typename V, typename Compare>
+const V* PersistentRBTCollection<K,V,Compare>::find_ptr(const K& a_key) const
+{
+  const Node* x = find_node(a_key);
+  return x ? &x->value : nullptr;
+}
+
+//  Function: find()
+//  Description: Finds each key >= k1 and <= k2, in ascending order
+//  Inputs: Smallest and largest key of the range, list for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::find(const K& k1, const K& k2,
+                                                ArrayList<K>& keys) const
+{
+  find(root, k1, k2, keys);
+}
+
+//  Function: keys()
+//  Description: Returns all keys in the collection
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::keys(ArrayList<K>& all_keys) const
+{
+  keys(root, all_keys);
+}
+
+//  Function: sort()
+//  Description: Returns all keys in ascending order
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  keys(all_keys_sorted);
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs in the collection
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::size() const
+{
+  return node_count;
+}
+
+//  Function: snapshot()
+//  Description: Returns a copy sharing the current tree, which later
+//  adds and removes (on either copy) do not change
+//  Inputs: None
+//  Outputs: The snapshot
+template<typename K, typename V, typename Compare>
+PersistentRBTCollection<K,V,Compare> PersistentRBTCollection<K,V,Compare>::snapshot() const
+{
+  return *this;
+}
+
+//  Function: height()
+//  Description: Returns the height of the tree
+//  Inputs: None
+//  Outputs: Height of the tree
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::height() const
+{
+  return height(root);
+}
+
+//  Function: node_allocations()
+//  Description: Returns the number of nodes this copy has allocated
+//  (new pairs plus copies of shared nodes)
+//  Inputs: None
+//  Outputs: Number of node allocations
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::node_allocations() const
+{
+  return allocations;
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection object, the
+//  nodes of its tree, and the keys' and values' dynamic memory
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::memory_usage() const
+{
+  return sizeof(*this) + node_count * sizeof(Node) + dynamic_memory(root);
+}
+
+//  Function: valid_rbt()
+//  Description: Checks the key order, that RED links lean left and
+//  never follow each other, and that the black heights are equal
+//  Inputs: None
+//  Outputs: True if the tree is valid
+template<typename K, typename V, typename Compare>
+bool PersistentRBTCollection<K,V,Compare>::valid_rbt() const
+{
+  return !is_red(root) && valid_rbt(root, nullptr, nullptr) >= 0;
+}
+
+//  Function: print()
+//  Description: Pretty-prints the tree
+//  Inputs: None
+//  Outputs: None
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::print() const
+{
+  print_tree("", root);
+}
+
+//----------------------------------------------------------------------
+// Helper Functions
+//----------------------------------------------------------------------
+
+// helper function to share a node
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::retain(Node* x)
+{
+  if(x) x->refs.fetch_add(1, std::memory_order_relaxed);
+  return x;
+}
+
+// helper function to stop sharing a node
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::release(Node* x)
+{
+  // whoever drops the last reference deletes the node (acq_rel so the
+  // deleting thread sees every earlier use of the node)
+  if(x && x->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+    release(x->left);
+    release(x->right);
+    delete x;
+  }
+}
+
+// helper function to get an unshared node for modification
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::mut(Node* h)
+{
+  // only this tree can reach h, so it can be changed in place
+  if(h->refs.load(std::memory_order_acquire) == 1) return h;
+  // otherwise copy it (the copy shares h's children)
+  Node* c = new Node;
+  c->key = h->key;
+  c->value = h->value;
+  c->left = retain(h->left);
+  c->right = retain(h->right);
+  c->color = h->color;
+  c->refs.store(1, std::memory_order_relaxed);
+  allocations++;
+  release(h);
+  return c;
+}
+
+// helper function for find, remove and the const find_ptr
+template<typename K, typename V, typename Compare>
+const typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::find_node(const K& search_key) const
+{
+  const Node* x = root;
+  while(x){
+    int c = compare(search_key, x->key);
+    if(c < 0)
+      x = x->left;
+    else if(c > 0)
+      x = x->right;
+    else
+      return x;
+  }
+  return nullptr;
+}
+
+// helper function for node colors
+template<typename K, typename V, typename Compare>
+bool PersistentRBTCollection<K,V,Compare>::is_red(const Node* x)
+{
+  return x && x->color == RED;
+}
+
+// helper function for left rotations
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::rotate_left(Node* h)
+{
+  Node* x = mut(h->right);
+  h->right = x->left;
+  x->left = h;
+  x->color = h->color;
+  h->color = RED;
+  return x;
+}
+
+// helper function for right rotations
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::rotate_right(Node* h)
+{
+  Node* x = mut(h->left);
+  h->left = x->right;
+  x->right = h;
+  x->color = h->color;
+  h->color = RED;
+  return x;
+}
+
+// helper function to flip the colors of a node and its children
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::flip_colors(Node* h)
+{
+  h->color = (h->color == RED) ? BLACK : RED;
+  h->left = mut(h->left);
+  h->left->color = (h->left->color == RED) ? BLACK : RED;
+  h->right = mut(h->right);
+  h->right->color = (h->right->color == RED) ? BLACK : RED;
+}
+
+// helper function for rebalancing on the way up
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::balance(Node* h)
+{
+  if(is_red(h->right) && !is_red(h->left)) h = rotate_left(h);
+  if(is_red(h->left) && is_red(h->left->left)) h = rotate_right(h);
+  if(is_red(h->left) && is_red(h->right)) flip_colors(h);
+  return h;
+}
+
+// helper function for remove (h is RED, its left child and left
+// grandchild are BLACK)
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::move_red_left(Node* h)
+{
+  flip_colors(h);
+  if(is_red(h->right->left)){
+    h->right = rotate_right(mut(h->right));
+    h = rotate_left(h);
+    flip_colors(h);
+  }
+  return h;
+}
+
+// helper function for remove (h is RED, its right child and the
+// right child's left child are BLACK)
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::move_red_right(Node* h)
+{
+  flip_colors(h);
+  if(is_red(h->left->left)){
+    h = rotate_right(h);
+    flip_colors(h);
+  }
+  return h;
+}
+
+// helper function for add
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::add(Node* h, const K& a_key, const V* a_val,
+                                          bool& added, Node*& found)
+{
+  // add the new (RED) node at the bottom
+  if(!h){
+    Node* n = new Node;
+    n->key = a_key;
+    n->value = a_val ? *a_val : V();
+    n->left = nullptr;
+    n->right = nullptr;
+    n->color = RED;
+    n->refs.store(1, std::memory_order_relaxed);
+    allocations++;
+    added = true;
+    found = n;
+    return n;
+  }
+  // (rebalancing below only relinks nodes this copy owns, so found
+  // stays valid)
+  h = mut(h);
+  int c = compare(a_key, h->key);
+  if(c < 0)
+    h->left = add(h->left, a_key, a_val, added, found);
+  else if(c > 0)
+    h->right = add(h->right, a_key, a_val, added, found);
+  else{
+    if(a_val) h->value = *a_val;
+    found = h;
+  }
+  return balance(h);
+}
+
+// helper function for remove (the key must be in the subtree)
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::remove(Node* h, const K& a_key)
+{
+  h = mut(h);
+  if(compare(a_key, h->key) < 0){
+    if(!is_red(h->left) && !is_red(h->left->left)) h = move_red_left(h);
+    h->left = remove(h->left, a_key);
+  }
+  else{
+    if(is_red(h->left)) h = rotate_right(h);
+    // a match at the bottom (no children) is simply dropped
+    if(compare(a_key, h->key) == 0 && !h->right){
+      release(h);
+      return nullptr;
+    }
+    if(!is_red(h->right) && !is_red(h->right->left)) h = move_red_right(h);
+    // replace a match with its successor, then remove the successor
+    if(compare(a_key, h->key) == 0){
+      const Node* m = h->right;
+      while(m->left) m = m->left;
+      h->key = m->key;
+      h->value = m->value;
+      h->right = remove_min(h->right);
+    }
+    else
+      h->right = remove(h->right, a_key);
+  }
+  return balance(h);
+}
+
+// helper function for remove (removes the smallest key)
+template<typename K, typename V, typename Compare>
+typename PersistentRBTCollection<K,V,Compare>::Node*
+PersistentRBTCollection<K,V,Compare>::remove_min(Node* h)
+{
+  h = mut(h);
+  if(!h->left){
+    release(h);
+    return nullptr;
+  }
+  if(!is_red(h->left) && !is_red(h->left->left)) h = move_red_left(h);
+  h->left = remove_min(h->left);
+  return balance(h);
+}
+
+// helper function for find (range)
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::find(const Node* subtree_root,
+const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  if(!subtree_root) return;
+  // traverse left only if smaller keys can still be in range
+  int c1 = compare(subtree_root->key, k1);
+  int c2 = compare(subtree_root->key, k2);
+  if(c1 > 0) find(subtree_root->left, k1, k2, keys);
+  if(c1 >= 0 && c2 <= 0)
+    keys.add(subtree_root->key);
+  // traverse right only if larger keys can still be in range
+  if(c2 < 0) find(subtree_root->right, k1, k2, keys);
+}
+
+// helper function for keys
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::keys(const Node* subtree_root,
+                                                ArrayList<K>& all_keys) const
+{
+  if(!subtree_root) return;
+  keys(subtree_root->left, all_keys);
+  all_keys.add(subtree_root->key);
+  keys(subtree_root->right, all_keys);
+}
+
+// helper function for memory_usage
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::dynamic_memory(const Node* subtree_root) const
+{
+  if(!subtree_root) return 0;
+  return DynamicMemory<K>::bytes(subtree_root->key)
+    + DynamicMemory<V>::bytes(subtree_root->value)
+    + dynamic_memory(subtree_root->left) + dynamic_memory(subtree_root->right);
+}
+
+// helper function for height
+template<typename K, typename V, typename Compare>
+size_t PersistentRBTCollection<K,V,Compare>::height(const Node* subtree_root) const
+{
+  if(!subtree_root) return 0;
+  size_t lh = height(subtree_root->left);
+  size_t rh = height(subtree_root->right);
+  return 1 + (lh > rh ? lh : rh);
+}
+
+// helper function for valid_rbt
+template<typename K, typename V, typename Compare>
+int PersistentRBTCollection<K,V,Compare>::valid_rbt(const Node* subtree_root,
+                                                    const K* lo, const K* hi) const
+{
+  if(!subtree_root) return 0;
+  // keys must stay between the ancestors' keys
+  if((lo && compare(*lo, subtree_root->key) >= 0) ||
+     (hi && compare(subtree_root->key, *hi) >= 0))
+    return -1;
+  // RED links lean left and never follow each other
+  if(is_red(subtree_root->right)) return -1;
+  if(is_red(subtree_root) && is_red(subtree_root->left)) return -1;
+  int lh = valid_rbt(subtree_root->left, lo, &subtree_root->key);
+  int rh = valid_rbt(subtree_root->right, &subtree_root->key, hi);
+  if(lh < 0 || rh < 0 || lh != rh) return -1;
+  return lh + (is_red(subtree_root) ? 0 : 1);
+}
+
+// helper function for print
+template<typename K, typename V, typename Compare>
+void PersistentRBTCollection<K,V,Compare>::print_tree(std::string indent,
+                                                      const Node* subtree_root) const
+{
+  if(!subtree_root) return;
+  std::string color = "[BLACK]";
+  if(subtree_root->color == RED) color = "[RED]";
+  std::cout << indent << subtree_root->key << " "
+            << color << " (h=" << height(subtree_root) << ")" << std::endl;
+  print_tree(indent + "  ", subtree_root->left);
+  print_tree(indent + "  ", subtree_root->right);
+}
+
+
+#endif
@@ -44,5 +44,6 @@ set key left
 # Plot the data
 plot infile u 1:2 t "HashTable Collection" w linespoints pointtype 7, \
      infile u 1:3 t "AVL Collection" w linespoints pointtype 7, \
-     infile u 1:4 t "RBT Collection" w linespoints pointtype 7
+     infile u 1:4 t "RBT Collection" w linespoints pointtype 7, \
+     infile u 1:5 t "B+ Tree Collection" w linespoints pointtype 7
      
\ No newline at end of file
@@ -11,11 +11,20 @@
 
 
 #include "string.h"
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <type_traits>
 #include "collection.h"
 #include "array_list.h"
+#include "node_allocator.h"
+#include "key_compare.h"
+#include "rbt_stats.h"
+#include "serialize.h"
 
 
-template<typename K, typename V>
+template<typename K, typename V, template<typename> class Alloc = SlabAllocator,
+         typename Compare = ThreeWayCompare<K>, typename Stats = NoRBTStats>
 class RBTCollection : public Collection<K,V>
 {
 public:
@@ -23,11 +32,20 @@ public:
   // create an empty collection
   RBTCollection();
   
+  // create a collection from pairs given in ascending key order
+  RBTCollection(const ArrayList<std::pair<K,V>>& sorted_pairs);
+
   // copy constructor
-  RBTCollection(const RBTCollection<K,V>& rhs);
+  RBTCollection(const RBTCollection<K,V,Alloc,Compare,Stats>& rhs);
+
+  // move constructor (takes over the rhs nodes, leaving rhs empty)
+  RBTCollection(RBTCollection<K,V,Alloc,Compare,Stats>&& rhs);
 
   // assignment operator
-  RBTCollection<K,V>& operator=(const RBTCollection<K,V>& rhs);
+  RBTCollection<K,V,Alloc,Compare,Stats>& operator=(const RBTCollection<K,V,Alloc,Compare,Stats>& rhs);
+
+  // move assignment operator
+  RBTCollection<K,V,Alloc,Compare,Stats>& operator=(RBTCollection<K,V,Alloc,Compare,Stats>&& rhs);
 
   // delete collection
   ~RBTCollection();
@@ -35,14 +53,57 @@ public:
   // add a new key-value pair into the collection 
   void add(const K& a_key, const V& a_val);
 
+  // add a new key-value pair, moving the key and value into the node
+  void add(K&& a_key, V&& a_val);
+
+  // add a new key-value pair, building the key and value in place
+  // from the given arguments
+  template<typename KK, typename... Args>
+  void emplace(KK&& a_key, Args&&... args);
+
   // remove a key-value pair from the collectiona
   void remove(const K& a_key);
 
+  // remove each key-value pair with k1 <= key <= k2 in O(log^2 n + m)
+  // time for m removed pairs (instead of m separate removes)
+  void remove(const K& k1, const K& k2);
+
   // find and return the value associated with the key
   bool find(const K& search_key, V& the_val) const;
 
-  // find and return each key >= k1 and <= k2 
+  // find using any key-like type that compares against K (e.g., a
+  // std::string_view for string keys), without building a K
+  template<typename Q>
+  bool find(const Q& search_key, V& the_val) const;
+
+  // return the value associated with the key for in-place updates,
+  // adding the key with a default value if it isn't found (one pass
+  // down the tree either way)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // find many keys at once, adding the value (V() if not found) and
+  // whether each key was found to values and found, in the order of
+  // search_keys; the searches run in lockstep so their cache misses
+  // overlap
+  void find_many(const ArrayList<K>& search_keys, ArrayList<V>& values,
+                 ArrayList<bool>& found) const;
+
+  // find and return each key >= k1 and <= k2 (in ascending order)
   void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // call visit(key, value) on each pair with k1 <= key <= k2 in
+  // ascending key order, stopping early if visit returns false
+  template<typename Visit>
+  void scan(const K& k1, const K& k2, Visit visit) const;
   
   // return all of the keys in the collection 
   void keys(ArrayList<K>& all_keys) const;
@@ -53,9 +114,84 @@ public:
   // return the number of key-value pairs in the collection
   size_t size() const;
 
+  // replace the collection with the pairs in [first, last), which must
+  // be in ascending key order (linear time)
+  template<typename Iter>
+  void build(Iter first, Iter last);
+
+  // write the pairs to a binary file in ascending key order (see
+  // serialize.h for how keys and values are written); returns false if
+  // the file can't be written
+  bool save(const std::string& path) const;
+
+  // replace the collection with the pairs in a file written by save,
+  // rebuilding the tree in linear time; returns false (leaving the
+  // collection empty) if the file can't be read or isn't a valid save
+  bool load(const std::string& path);
+
   // return the height of the tree
   size_t height() const;
 
+  // return the number of keys less than the given key
+  size_t rank(const K& a_key) const;
+
+  // find the key at the given (0-based) position in ascending order
+  // returns false if the index is out of range
+  bool select(size_t index, K& the_key) const;
+
+  // return the number of keys >= k1 and <= k2
+  size_t count(const K& k1, const K& k2) const;
+
+  // replace the collection with the pairs of left, the given pair, and
+  // the pairs of right, where every key in left is smaller than a_key
+  // and every key in right is larger (left and right are emptied)
+  void join(RBTCollection<K,V,Alloc,Compare,Stats>& left, const K& a_key, const V& a_val,
+            RBTCollection<K,V,Alloc,Compare,Stats>& right);
+
+  // replace the collection with the pairs of left followed by the pairs
+  // of right, where every key in left is smaller than every key in
+  // right (left and right are emptied)
+  void join(RBTCollection<K,V,Alloc,Compare,Stats>& left, RBTCollection<K,V,Alloc,Compare,Stats>& right);
+
+  // move the pairs with keys < a_key into left and the rest into
+  // right, leaving this collection empty (with SlabAllocator, left and
+  // right keep sharing this collection's node arena, so they must not
+  // be modified from different threads at the same time, e.g. as two
+  // ConcurrentCollections or two shards; copying one, or emptying it,
+  // gives it an arena of its own)
+  void split(const K& a_key, RBTCollection<K,V,Alloc,Compare,Stats>& left,
+             RBTCollection<K,V,Alloc,Compare,Stats>& right);
+
+  // keep every key in this collection or rhs (values in this
+  // collection win), using up to the given number of threads
+  // (rhs is emptied)
+  void set_union(RBTCollection<K,V,Alloc,Compare,Stats>& rhs, size_t threads = 1);
+
+  // keep only the keys that are also in rhs (rhs is emptied)
+  void set_intersection(RBTCollection<K,V,Alloc,Compare,Stats>& rhs, size_t threads = 1);
+
+  // remove every key that is in rhs (rhs is emptied)
+  void set_difference(RBTCollection<K,V,Alloc,Compare,Stats>& rhs, size_t threads = 1);
+
+  // number of calls made to the system allocator for nodes
+  size_t node_allocations() const;
+
+  // return the number of bytes used by the collection (the collection
+  // object, one node per pair, and the keys' and values' dynamic
+  // memory, not counting allocator overhead)
+  size_t memory_usage() const;
+
+  // return the rebalancing counts kept by the statistics policy (all
+  // zero with the default NoRBTStats)
+  RBTStats stats() const;
+
+  // start the rebalancing counts over
+  void reset_stats();
+
+  // check the tree in one iterative pass (red-black constraints, key
+  // order, parent links and subtree sizes) and report its shape
+  RBTShape profile() const;
+
   // for testing:
 
   // check if tree satisfies the red-black tree constraints
@@ -76,6 +212,14 @@ private:
     Node* right;
     Node* parent;
     color_t color;
+    size_t size;  // number of nodes in the subtree rooted here
+
+    Node() : left(nullptr), right(nullptr), parent(nullptr), color(RED), size(1) {}
+    // builds the key and value in place for a new (red) leaf
+    template<typename KK, typename... Args>
+    Node(KK&& k, Args&&... args)
+      : key(std::forward<KK>(k)), value(std::forward<Args>(args)...),
+        left(nullptr), right(nullptr), parent(nullptr), color(RED), size(1) {}
   };
 
   // root node
@@ -84,25 +228,150 @@ private:
   // number of k-v pairs stored in the collection
   size_t node_count;
 
-  // helper to empty entire hash table
+  // node allocation policy
+  Alloc<Node> alloc;
+
+  // parent of the root during remove (so the root can be rebalanced)
+  Node sentinel;
+
+  // rebalancing statistics policy
+  Stats counters;
+
+  // three-way compare of two keys (or a key and a key-like value)
+  // using the comparison policy
+  template<typename A, typename B>
+  static int compare(const A& a, const B& b) {return Compare()(a, b);}
+
+  // helper to find the node holding a key (nullptr if none)
+  template<typename Q>
+  Node* find_node(const Q& search_key) const;
+
+  // helper to find the node holding a key, adding a node built from
+  // the key and args (with top-down rebalancing) if there is none
+  template<typename... Args>
+  Node* find_or_add(const K& a_key, bool& added, Args&&... args);
+
+  // helper to find the root of the smallest subtree around the hint
+  // whose key range holds the search key (climbing from the hint)
+  Node* finger_start(Node* hint, const K& search_key) const;
+
+  // helper to empty the entire tree
+  void make_empty();
+
+  // helper to deallocate each node of a subtree
   void make_empty(Node* subtree_root);
 
   // copy helper
   void copy(Node* lhs_subtree_root, const Node* rhs_subtree_root); 
     
-  // helper to recursively find range of keys
-  void find(const Node* subtree_root, const K& k1, const K& k2,
-            ArrayList<K>& keys) const;
+  // helper to recursively scan a range of keys (returns false once
+  // the visitor asks to stop)
+  template<typename Visit>
+  bool scan(const Node* subtree_root, const K& k1, const K& k2,
+            Visit& visit) const;
 
   // helper to build sorted list of keys (used by keys and sort)
   void keys(const Node* subtree_root, ArrayList<K>& all_keys) const;
 
+  // bulk-build helper: replace the tree with n nodes whose keys and
+  // values are assigned, in key order, by fill(node)
+  template<typename Fill>
+  void build_tree(size_t n, Fill& fill);
+
+  // bulk-build helper: link n nodes into a subtree at the given depth
+  template<typename Fill>
+  Node* build_tree(size_t n, size_t depth, size_t red_depth, Node* block,
+                   size_t& used, Fill& fill);
+
+  // subtree size helper (0 for an empty subtree)
+  static size_t node_size(const Node* subtree_root);
+
+  // helper to recompute a node's subtree size from its children
+  static void update_size(Node* x);
+
+  // helper to add delta to the subtree size of x and each ancestor
+  // (stopping at the remove sentinel)
+  void adjust_sizes(Node* x, long delta);
+
+  // helper to count the keys <= the given key
+  size_t rank_upper(const K& a_key) const;
+
   // rotate right helper
   void rotate_right(Node* k2);
 
   // rotate left helper
   void rotate_left(Node* k2);
 
+  // rotate helpers for detached trees (top is the root of the tree)
+  static void rotate_right(Node* k2, Node*& top);
+  static void rotate_left(Node* k2, Node*& top);
+
+  // subtrees smaller than this are never split across threads
+  static const size_t PARALLEL_CUTOFF = 4096;
+
+  // number of searches find_many runs in lockstep
+  static const size_t FIND_LANES = 16;
+
+  // first bytes of a file written by save
+  static constexpr char SAVE_MAGIC[4] = {'R', 'B', 'T', '1'};
+
+  // helper to start loading a node into the cache
+  static void prefetch(const Node* x);
+
+  // helper to count the black nodes on the leftmost path of a subtree
+  static size_t black_height(const Node* subtree_root);
+
+  // helper to join two detached trees with m in between (all keys in
+  // l < m->key < all keys in r), returns the new root
+  static Node* join(Node* l, Node* m, Node* r);
+
+  // helper to join two detached trees (all keys in l < all keys in r)
+  static Node* join(Node* l, Node* r);
+
+  // helper to detach the node with the largest key from a tree
+  static void split_last(Node* t, Node*& rest, Node*& last);
+
+  // helper to split a detached tree into the keys < a_key and the rest
+  static void split(Node* t, const K& a_key, Node*& l, Node*& r);
+
+  // helper to split a detached tree into the keys < a_key, a node with
+  // key a_key (nullptr if none), and the keys > a_key
+  static void split(Node* t, const K& a_key, Node*& l, Node*& found,
+                    Node*& r);
+
+  // restore red-black constraints bottom up from the red node x
+  // (counting the flips and rotations in counts, if given)
+  static void join_rebalance(Node* x, Node*& top, Stats* counts = nullptr);
+
+  // set operation helpers, each consuming the trees t1 and t2 and
+  // collecting the nodes left over in garbage (the halves run as
+  // separate tasks while spawn_depth > 0)
+  static Node* unite(Node* t1, Node* t2, size_t spawn_depth,
+                     ArrayList<Node*>& garbage);
+  static Node* intersect(Node* t1, Node* t2, size_t spawn_depth,
+                         ArrayList<Node*>& garbage);
+  static Node* subtract(Node* t1, Node* t2, size_t spawn_depth,
+                        ArrayList<Node*>& garbage);
+
+  // helper to add every node of a subtree to garbage
+  static void collect(Node* t, ArrayList<Node*>& garbage);
+
+  // helper to detach the root of a tree from its children
+  static void detach(Node* t, Node*& l, Node*& r);
+
+  // helper to find the task depth for a number of threads
+  static size_t spawn_depth(size_t threads);
+
+  // helper to take over the nodes of rhs, leaving it empty
+  Node* take(RBTCollection<K,V,Alloc,Compare,Stats>& rhs);
+
+  // helper to deallocate the nodes left over by a set operation
+  void release_nodes(ArrayList<Node*>& garbage);
+
+  // helper to remove the keys >= k1 and <= k2 from a detached tree,
+  // joining the parts that are kept (returns the new root)
+  Node* remove_range(Node* t, const K& k1, const K& k2);
+
   // restore red-black constraints in add
   void add_rebalance(Node* x);
 
@@ -116,56 +385,167 @@ private:
   // for testing:
   // ------------
   
-  // validate helper
-  bool valid_rbt(Node* subtree_root) const;
-
-  // validate helper
-  size_t black_node_height(Node* subtree_root) const;
-  
   // recursive pretty-print helper
   void print_tree(std::string indent, Node* subtree_root) const;
+
+  // in-order successor helper (nullptr after the largest key)
+  template<typename N>
+  static N* successor(N* x);
+
+  // in-order predecessor helper (nullptr before the smallest key)
+  template<typename N>
+  static N* predecessor(N* x);
+
+  // helper to find the node with the largest key in a subtree
+  template<typename N>
+  static N* maximum(N* subtree_root);
+
+  // helper to find the first node with key >= search_key
+  Node* lower_bound_node(const K& search_key) const;
+
+  // helper to find the first node with key > search_key
+  Node* upper_bound_node(const K& search_key) const;
+
+public:
+
+  // Bidirectional in-order iterator over the key-value pairs. Moving
+  // to the next (or previous) pair follows the parent pointers, so no
+  // keys are copied up front. Iterators are invalidated by remove.
+  template<typename N, typename R>
+  class basic_iterator
+  {
+  public:
+    basic_iterator() : node(nullptr), tree(nullptr) {}
+
+    // allows converting an iterator into a const_iterator
+    template<typename N2, typename R2>
+    basic_iterator(const basic_iterator<N2,R2>& rhs)
+      : node(rhs.node), tree(rhs.tree) {}
+
+    // key and value of the current pair
+    const K& key() const {return node->key;}
+    R value() const {return node->value;}
+
+    // move to the next pair in key order
+    basic_iterator& operator++() {node = successor(node); return *this;}
+    basic_iterator operator++(int) {basic_iterator tmp = *this; ++*this; return tmp;}
+
+    // move to the previous pair in key order (end() moves to the last)
+    basic_iterator& operator--()
+    {
+      node = node ? predecessor(node) : maximum<N>(tree->root);
+      return *this;
+    }
+    basic_iterator operator--(int) {basic_iterator tmp = *this; --*this; return tmp;}
+
+    template<typename N2, typename R2>
+    bool operator==(const basic_iterator<N2,R2>& rhs) const {return node == rhs.node;}
+    template<typename N2, typename R2>
+    bool operator!=(const basic_iterator<N2,R2>& rhs) const {return node != rhs.node;}
+
+  private:
+    friend class RBTCollection;
+    template<typename N2, typename R2> friend class basic_iterator;
+
+    basic_iterator(N* n, const RBTCollection* t) : node(n), tree(t) {}
+
+    N* node;  // current node (nullptr at the end)
+    const RBTCollection* tree;  // tree being iterated
+  };
+
+  typedef basic_iterator<Node, V&> iterator;
+  typedef basic_iterator<const Node, const V&> const_iterator;
+
+  // iterators to the smallest key and past the largest key
+  iterator begin();
+  const_iterator begin() const;
+  iterator end();
+  const_iterator end() const;
+
+  // iterator to the first pair with key >= search_key
+  iterator lower_bound(const K& search_key);
+  const_iterator lower_bound(const K& search_key) const;
+
+  // iterator to the first pair with key > search_key
+  iterator upper_bound(const K& search_key);
+  const_iterator upper_bound(const K& search_key) const;
+
+  // range of pairs with key == search_key
+  std::pair<iterator,iterator> equal_range(const K& search_key);
+  std::pair<const_iterator,const_iterator> equal_range(const K& search_key) const;
+
+  // add a new key-value pair, starting the search at the hint (e.g.,
+  // the iterator returned by the previous add) instead of the root, so
+  // keys near the hint take O(log d) compares for a distance d from
+  // the hint; returns an iterator to the new pair for the next add
+  iterator add_near(const_iterator hint, const K& a_key, const V& a_val);
+
+  // find the pair with the given key, starting the search at the hint
+  // (end() if the key isn't found)
+  iterator find_near(const_iterator hint, const K& search_key);
+  const_iterator find_near(const_iterator hint, const K& search_key) const;
 };
 
 
 // TODO: Finish the above functions below
 
-template<typename K, typename V>
-RBTCollection<K,V>::RBTCollection()
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>::RBTCollection()
   : node_count(0)
 {
   root = nullptr;
 }
 
-template<typename K, typename V>
-RBTCollection<K,V>::RBTCollection(const RBTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>::RBTCollection(const ArrayList<std::pair<K,V>>& sorted_pairs)
+  : root(nullptr), node_count(0)
+{
+  size_t i = 0;
+  auto fill = [&](Node* n){
+    std::pair<K,V> item;
+    sorted_pairs.get(i++, item);
+    n->key = item.first;
+    n->value = item.second;
+  };
+  build_tree(sorted_pairs.size(), fill);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>::RBTCollection(const RBTCollection<K,V,A,C,S>& rhs)
   : node_count(0), root(nullptr)
 {
   // defer to the assignment operator
   *this = rhs;
 }
 
-template<typename K, typename V>
-RBTCollection<K,V>::~RBTCollection()
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>::RBTCollection(RBTCollection<K,V,A,C,S>&& rhs)
+  : root(nullptr), node_count(rhs.node_count)
 {
-  make_empty(root);
-  root = nullptr;
+  root = take(rhs);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>::~RBTCollection()
+{
+  make_empty();
 }
 
-template<typename K, typename V>
-RBTCollection<K,V>& RBTCollection<K,V>::operator=(const RBTCollection<K,V>& rhs)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>& RBTCollection<K,V,A,C,S>::operator=(const RBTCollection<K,V,A,C,S>& rhs)
 {
   if(this != &rhs){
-    make_empty(root); // delete the lhs tree
-    root = nullptr;
-    root = new Node;
+    make_empty(); // delete the lhs tree
     if(rhs.root){
       // copy rhs root into lhs root
+      root = alloc.allocate();
       root->key = rhs.root->key;
       root->value = rhs.root->value;
       root->left = nullptr;
       root->right = nullptr;
       root->parent = nullptr;
       root->color = BLACK;
+      root->size = rhs.root->size;
       node_count++; // increment node_count variable
       copy(root, rhs.root); // copy the rhs tree into the lhs tree
     }
@@ -173,29 +553,59 @@ RBTCollection<K,V>& RBTCollection<K,V>::operator=(const RBTCollection<K,V>& rhs)
   return *this;
 }
 
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTCollection<K,V,A,C,S>& RBTCollection<K,V,A,C,S>::operator=(RBTCollection<K,V,A,C,S>&& rhs)
+{
+  if(this != &rhs){
+    make_empty(); // delete the lhs tree
+    node_count = rhs.node_count;
+    root = take(rhs);
+  }
+  return *this;
+}
+
 //  Function: add()
 //  Description: Adds a new key-value pair to the tree
 //  Inputs: Key and value to be added to the tree
 //  Outputs: None
-template<typename K, typename V>
-void RBTCollection<K,V>::add(const K& a_key, const V& a_val){
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::add(const K& a_key, const V& a_val){
+  emplace(a_key, a_val);
+}
+
+//  Function: add()
+//  Description: Adds a new key-value pair to the tree, moving the key
+//  and value into the new node instead of copying them
+//  Inputs: Key and value to be added to the tree
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::add(K&& a_key, V&& a_val){
+  emplace(std::move(a_key), std::move(a_val));
+}
+
+//  Function: emplace()
+//  Description: Adds a new key-value pair to the tree, constructing the
+//  key and value directly inside the new node (no default construction
+//  followed by assignment)
+//  Inputs: Key (or argument for the key) and the arguments for the value
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename KK, typename... Args>
+void RBTCollection<K,V,A,C,S>::emplace(KK&& a_key, Args&&... args){
   // create the node to be added to the tree
-  Node* n = new Node;
-  n->key = a_key;
-  n->value = a_val;
-  n->color = RED;
-  n->left = nullptr;
-  n->right = nullptr;
-  n->parent = nullptr;
+  Node* n = alloc.allocate(std::forward<KK>(a_key), std::forward<Args>(args)...);
+  const K& key = n->key;
+  counters.add();
 
   Node* x = root; // pointer to the current node
   Node* p = nullptr;  // pointer to the parent of the current node
   // iterate through the tree and rebalance
   while(x){
+    counters.visit();
     add_rebalance(x); // rebalance the RBT
     p = x;  // move the parent node forward
     // move the current node ahead through the tree
-    if(a_key <= x->key)
+    if(compare(key, x->key) <= 0)
       x = x->left;
     else
       x = x->right;
@@ -203,14 +613,16 @@ void RBTCollection<K,V>::add(const K& a_key, const V& a_val){
   // add the new node at the correct location in the tree
   if(!p)  // special case - add to an empty list
     root = n;
-  else if(a_key <= p->key){
+  else if(compare(key, p->key) <= 0){
     p->left = n;
     n->parent = p;
+    adjust_sizes(p, 1); // count n in each ancestor's subtree
     add_rebalance(n);
   }
   else{
     p->right = n;
     n->parent = p;
+    adjust_sizes(p, 1); // count n in each ancestor's subtree
     add_rebalance(n);
   }
   root->color = BLACK; // color the root BLACK
@@ -221,52 +633,64 @@ void RBTCollection<K,V>::add(const K& a_key, const V& a_val){
 //  Description: Removes the requested key-value pair from the tree
 //  Inputs: The key of the pair to be removed
 //  Outputs: None
-template<typename K, typename V>
-void RBTCollection<K,V>::remove(const K& a_key){
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::remove(const K& a_key){
   if(!root) return; // return if the list is empty
 
-  // create sentinel Node
-  Node* sentinel = new Node;
-  sentinel->right = root;
-  sentinel->left = nullptr;
-  sentinel->parent = nullptr;
-  sentinel->color = RED;
-  root->parent = sentinel;
+  counters.remove();
+  counters.sentinel();
+
+  // set up the sentinel as the root's parent
+  sentinel.right = root;
+  sentinel.left = nullptr;
+  sentinel.parent = nullptr;
+  sentinel.color = RED;
+  root->parent = &sentinel;
 
   Node* x = root;
-  Node* p = sentinel;
+  Node* p = &sentinel;
   bool found = false;
 
   // iteratively find the node to delete
   while(x && !found){
+    counters.visit();
+    int c = compare(a_key, x->key);
     // rebalance and go left
-    if(a_key < x->key){
+    if(c < 0){
       remove_rebalance(x, false);
       x = x->left;
     }
     // rebalance and go right
-    else if(a_key > x->key){
+    else if(c > 0){
       remove_rebalance(x, true);
       x = x->right;
     }
     // found node to remove
-    else if(a_key == x->key){
+    else{
       remove_rebalance(x, x->left);
       found = true;
     }
   }
-  if(!found) return; // the key does not exist in the tree
+  if(!found){
+    // the key does not exist in the tree (but the rebalancing on the
+    // way down may have rotated at the root)
+    root = sentinel.right;
+    root->parent = nullptr;
+    root->color = BLACK;
+    return;
+  }
   p = x->parent;
 
   // delete cases
   // case 1 - 0 or 1 children
   if(!x->left || !x->right){
+    adjust_sizes(p, -1); // x leaves each ancestor's subtree
     if(x->left){
       Node* tmp = x->left;
       tmp->parent = p;
       if(x == p->left) p->left = tmp;
       if(x == p->right) p->right = tmp;
-      delete x;   
+      alloc.deallocate(x);   
       x = tmp; 
     }
     else if(x->right){
@@ -274,33 +698,36 @@ void RBTCollection<K,V>::remove(const K& a_key){
       tmp->parent = p;
       if(x == p->left) p->left = tmp;
       if(x == p->right) p->right = tmp;
-      delete x;
+      alloc.deallocate(x);
       x = tmp;
     }
     else{
       if(x == p->left) p->left = nullptr;
       if(x == p->right) p->right = nullptr;
-      delete x;
+      alloc.deallocate(x);
     }
   }
   // case 2 - 2 children
   else{
     Node* s = x->right;
+    counters.successor_step();
     remove_rebalance(s, false);
     // special case - successor is the node to the right of x
     if(!s->left){
       // copy the values of s into x
       x->key = s->key;
       x->value = s->value;
+      adjust_sizes(s->parent, -1); // s leaves each ancestor's subtree
       Node* tmp = s->right;
       if(tmp) tmp->parent = s->parent;
       if(s == s->parent->left) s->parent->left = tmp;
       if(s == s->parent->right) s->parent->right = tmp;
-      delete s; // delete successor
+      alloc.deallocate(s); // delete successor
     }
     else{
       while(s->left){
         s = s->left;
+        counters.successor_step();
         remove_rebalance(s,false);
       }
       // copy s pair into x
@@ -308,69 +735,196 @@ void RBTCollection<K,V>::remove(const K& a_key){
       x->value = s->value;
       // remove s
       Node* s_p = s->parent;
+      adjust_sizes(s_p, -1); // s leaves each ancestor's subtree
       if(s->right){
         Node* tmp = s->right;
         s_p->left = tmp;
         tmp->parent = s_p;
-        delete s;
+        alloc.deallocate(s);
       }
       else{
         s_p->left = nullptr;
-        delete s;
+        alloc.deallocate(s);
       }
     }
   }
   
   // clean up
-  root = sentinel->right;
+  root = sentinel.right;
   if(root) {
     root->parent = nullptr;
     root->color = BLACK;
   }
-  delete sentinel;
   node_count--;
 }
 
+//  Function: remove()
+//  Description: Removes every pair in a range of keys. The nodes on the
+//  paths to k1 and k2 are detached and joined back together around the
+//  removed keys, so each removed node is only deallocated (no separate
+//  top-down remove per key).
+//  Inputs: Smallest and largest key of the range
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::remove(const K& k1, const K& k2){
+  if(!root || compare(k2, k1) < 0) return;
+  root = remove_range(root, k1, k2);
+  if(root){
+    root->parent = nullptr;
+    root->color = BLACK;
+  }
+}
+
 //  Function: find()
 //  Description: Finds the value associated with the given key, if it exists in the tree
 //  Inputs: Key to be found
 //  Outputs: Value associated with the key, whether or not the pair exists in the tree
-template<typename K, typename V>
-bool RBTCollection<K,V>::find(const K& search_key, V& return_val) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::find(const K& search_key, V& return_val) const
 {
-  // special case if the tree is empty
-  if(node_count == 0) return false;
+  return find<K>(search_key, return_val);
+}
 
-  Node* cur = root; // Node pointer to keep track of current location in the tree
-  while(cur){
-    if(search_key == cur->key){ // search_key is found
-      return_val = cur->value;  // return the value at cur
-      return true;  // return true since you found search_key
+//  Function: find()
+//  Description: Finds the value associated with a key-like search key
+//  (one that can be compared directly with the keys in the tree)
+//  Inputs: Key to be found
+//  Outputs: Value associated with the key, whether or not the pair exists in the tree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Q>
+bool RBTCollection<K,V,A,C,S>::find(const Q& search_key, V& return_val) const
+{
+  Node* cur = find_node(search_key);
+  if(!cur) return false; // return false since you did not find search_key
+  return_val = cur->value;  // return the value at cur
+  return true;
+}
+
+//  Function: find_or_insert()
+//  Description: Returns the value associated with the given key, adding
+//  the key with a default value if it is not in the tree. Both cases
+//  take a single pass down the tree.
+//  Inputs: Key to be found
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+V& RBTCollection<K,V,A,C,S>::find_or_insert(const K& a_key)
+{
+  bool added;
+  return find_or_add(a_key, added)->value;
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds the key-value pair, or replaces the value if the key
+//  is already in the tree
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  bool added;
+  Node* n = find_or_add(a_key, added, a_val);
+  if(!added) n->value = a_val;
+  return added;
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value associated with the given key in place
+//  Inputs: Key to be found
+//  Outputs: Pointer to the value associated with the key (nullptr if not found)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+V* RBTCollection<K,V,A,C,S>::find_ptr(const K& a_key)
+{
+  Node* n = find_node(a_key);
+  return n ? &n->value : nullptr;
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+const V* RBTCollection<K,V,A,C,S>::find_ptr(const K& a_key) const
+{
+  Node* n = find_node(a_key);
+  return n ? &n->value : nullptr;
+}
+
+//  Function: find_many()
+//  Description: Finds the values of many keys, descending the tree for
+//  FIND_LANES keys at a time in lockstep. Each step moves every search
+//  down one level and prefetches the next node, so one search's cache
+//  miss is hidden behind the compares of the others.
+//  Inputs: Keys to be found, lists for the values and found flags
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::find_many(const ArrayList<K>& search_keys,
+                                     ArrayList<V>& values,
+                                     ArrayList<bool>& found) const
+{
+  size_t n = search_keys.size();
+  for(size_t first = 0; first < n; first += FIND_LANES){
+    size_t lanes = (n - first < FIND_LANES) ? n - first : FIND_LANES;
+    const Node* cur[FIND_LANES];  // next node of each search
+    const Node* hit[FIND_LANES];  // node found by each search
+    for(size_t i = 0; i < lanes; ++i){
+      cur[i] = root;
+      hit[i] = nullptr;
+    }
+    bool active = root;
+    while(active){
+      active = false;
+      for(size_t i = 0; i < lanes; ++i){
+        const Node* x = cur[i];
+        if(!x) continue;
+        int c = compare(search_keys[first + i], x->key);
+        if(c == 0){
+          hit[i] = x;
+          x = nullptr;
+        }
+        else
+          x = (c < 0) ? x->left : x->right;
+        cur[i] = x;
+        if(x){
+          prefetch(x);
+          active = true;
+        }
+      }
+    }
+    for(size_t i = 0; i < lanes; ++i){
+      values.add(hit[i] ? hit[i]->value : V());
+      found.add(hit[i] != nullptr);
     }
-    else if(search_key < cur->key) // key at cur is less than search_key
-      cur = cur->left;  // iterate through cur's left subtree
-    else  // key at cur is greater than search_key
-      cur = cur->right; // iterate through cur's right subtree
   }
-  return false; // return false since you did not find search_key
 }
 
 //  Function: find()
 //  Description: Finds and returns all keys between the given k1 and k2 keys
 //  Inputs: Given key "limits"
 //  Outputs: All keys between the given "limits"
-template<typename K, typename V>
-void RBTCollection<K,V>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  scan(k1, k2, [&](const K& key, const V&){
+    keys.add(key);
+    return true;
+  });
+}
+
+//  Function: scan()
+//  Description: Visits each key-value pair with a key between k1 and k2
+//  in ascending key order, skipping subtrees that are out of range.
+//  The scan stops as soon as the visitor returns false.
+//  Inputs: Given key "limits", visitor called as visit(key, value)
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Visit>
+void RBTCollection<K,V,A,C,S>::scan(const K& k1, const K& k2, Visit visit) const
 {
-  find(root, k1, k2, keys);
+  scan(root, k1, k2, visit);
 }
 
 //  Function: keys()
 //  Description: Returns a list of all the keys in the tree (using in-order traversal)
 //  Inputs: None
 //  Outputs: List of all keys in the collection
-template<typename K, typename V>
-void RBTCollection<K,V>::keys(ArrayList<K>& all_keys) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::keys(ArrayList<K>& all_keys) const
 {
   keys(root, all_keys);
 }
@@ -379,8 +933,8 @@ void RBTCollection<K,V>::keys(ArrayList<K>& all_keys) const
 //  Description: Returns a list of all the keys in sorted order
 //  Inputs: None
 //  Outputs: A list of the keys in the system in sorted order
-template<typename K, typename V>
-void RBTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::sort(ArrayList<K>& all_keys_sorted) const
 {
   keys(all_keys_sorted);
 }
@@ -389,144 +943,796 @@ void RBTCollection<K,V>::sort(ArrayList<K>& all_keys_sorted) const
 //  Description: Returns the number of key-value pairs of the tree
 //  Inputs: None
 //  Outputs: The number of key-value pairs in the tree
-template<typename K, typename V>
-size_t RBTCollection<K,V>::size() const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::size() const
 {
   return node_count;
 }
 
+//  Function: build()
+//  Description: Replaces the contents of the tree with the given pairs
+//  (in ascending key order) in linear time, without any rebalancing
+//  Inputs: Iterator range over pairs (with first = key, second = value)
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Iter>
+void RBTCollection<K,V,A,C,S>::build(Iter first, Iter last)
+{
+  auto fill = [&](Node* n){
+    n->key = first->first;
+    n->value = first->second;
+    ++first;
+  };
+  build_tree(std::distance(first, last), fill);
+}
+
+//  Function: save()
+//  Description: Writes a header (magic bytes and the number of pairs)
+//  and then each key and value in ascending key order
+//  Inputs: Path of the file to write
+//  Outputs: True if the whole file was written
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::save(const std::string& path) const
+{
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if(!out) return false;
+  out.write(SAVE_MAGIC, sizeof(SAVE_MAGIC));
+  Serializer<uint64_t>::write(out, node_count);
+  for(const_iterator it = begin(); it != end(); ++it){
+    Serializer<K>::write(out, it.key());
+    Serializer<V>::write(out, it.value());
+  }
+  out.flush();
+  return bool(out);
+}
+
+//  Function: load()
+//  Description: Reads a file written by save straight into the nodes
+//  of a bulk build (one contiguous block, filled in key order), so no
+//  key is compared against the tree or rebalanced
+//  Inputs: Path of the file to read
+//  Outputs: True if the file was a complete save with keys in strictly
+//  ascending order
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::load(const std::string& path)
+{
+  make_empty();
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(SAVE_MAGIC)];
+  uint64_t n = 0;
+  if(!in.read(magic, sizeof(magic)) || memcmp(magic, SAVE_MAGIC, sizeof(magic)) != 0
+     || !Serializer<uint64_t>::read(in, n))
+    return false;
+  // the pair count must fit in what is left of the file (at the
+  // smallest size a pair can be written as) before that many nodes are
+  // allocated
+  const uint64_t pair_size = Serializer<K>::min_size + Serializer<V>::min_size;
+  std::streampos start = in.tellg();
+  in.seekg(0, std::ios::end);
+  if(n > uint64_t(in.tellg() - start) / (pair_size ? pair_size : 1)) return false;
+  in.seekg(start);
+  bool ok = true;
+  const Node* prev = nullptr;
+  auto fill = [&](Node* x){
+    // after a bad read the rest of the nodes are only filled with
+    // defaults, and the tree is dropped below
+    if(ok)
+      ok = Serializer<K>::read(in, x->key) && Serializer<V>::read(in, x->value)
+           && (!prev || compare(prev->key, x->key) < 0);
+    prev = x;
+  };
+  build_tree(n, fill);
+  if(!ok){
+    make_empty();
+    return false;
+  }
+  return true;
+}
+
 //  Function: height()
 //  Description: Returns the height of the tree
 //  Inputs: None
 //  Outputs: The height of the tree (counting of nodes)
-template<typename K, typename V>
-size_t RBTCollection<K,V>::height() const{
-  if(size() == 0) return 0;
-  return height(root);
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::height() const{
+  return profile().height;
 }
 
-//----------------------------------------------------------------------
-// Helper Functions
-//----------------------------------------------------------------------
-
-// helper function for destructor
-template<typename K, typename V>
-void RBTCollection<K,V>::make_empty(Node* subtree_root)
+//  Function: rank()
+//  Description: Counts the keys less than the given key using the
+//  subtree sizes along one root-to-leaf path
+//  Inputs: Key to rank
+//  Outputs: Number of keys in the tree less than the key
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::rank(const K& a_key) const
 {
-  // if the subtree root is null, return (base case)
-  if(!subtree_root){
-    return;
-  }
-  // delete the left and right subtrees of the current node
-  if(subtree_root->left){
-    make_empty(subtree_root->left);
-    subtree_root->left = nullptr;
-  }
-  if(subtree_root->right){
-    make_empty(subtree_root->right);
-    subtree_root->right = nullptr;
+  size_t r = 0;
+  Node* x = root;
+  while(x){
+    if(compare(x->key, a_key) < 0){
+      r += node_size(x->left) + 1; // x and its left subtree are smaller
+      x = x->right;
+    }
+    else
+      x = x->left;
   }
-  // delete the current node
-  // if(subtree_root->parent) subtree_root->parent = nullptr;
-  delete subtree_root;
-  node_count--;
+  return r;
 }
 
-// helper function for copy constructor
-template<typename K, typename V>
-void RBTCollection<K,V>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+//  Function: select()
+//  Description: Finds the key at the given position in ascending order
+//  using the subtree sizes along one root-to-leaf path
+//  Inputs: 0-based index of the key
+//  Outputs: The key at the index, whether or not the index is valid
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::select(size_t index, K& the_key) const
 {
-  // base case (if the root is nullptr)
-  if(!rhs_subtree_root) return;
-  // copy left subtree over if it exists
-  if(rhs_subtree_root->left){
-    // new Node to copy to left subtree of lhs_subtree_root
-    Node* tmp = new Node;
-    tmp->key = rhs_subtree_root->left->key;
-    tmp->value = rhs_subtree_root->left->value;
-    tmp->left = nullptr;
-    tmp->right = nullptr;
-    tmp->parent = nullptr;
-    tmp->color = rhs_subtree_root->left->color;
-
-    // add new Node to the left subtree of lhs_subtree_root
-    lhs_subtree_root->left = tmp;
-    tmp->parent = lhs_subtree_root;
-    node_count++; // increment node_count variable
-
-    // copy the rest of the left subtree of rhs_subtree_root
-    copy(lhs_subtree_root->left, rhs_subtree_root->left);
+  Node* x = root;
+  while(x){
+    size_t left_size = node_size(x->left);
+    if(index < left_size)
+      x = x->left;
+    else if(index == left_size){
+      the_key = x->key;
+      return true;
+    }
+    else{
+      index -= left_size + 1; // skip x and its left subtree
+      x = x->right;
+    }
   }
+  return false;
+}
 
-  // copy right subtree over if it exists
-  if(rhs_subtree_root->right){
-
-    // new Node to copy to right subtree of lhs_subtree_root
-    Node* tmp = new Node;
-    tmp->key = rhs_subtree_root->right->key;
-    tmp->value = rhs_subtree_root->right->value;
-    tmp->left = nullptr;
-    tmp->right = nullptr;
-    tmp->parent = nullptr;
-    tmp->color = rhs_subtree_root->right->color;
-
-    // add new Node to the right subtree of lhs_subtree_root
-    lhs_subtree_root->right = tmp;
-    tmp->parent = lhs_subtree_root;
-    node_count++; // increment node_count variable
+//  Function: count()
+//  Description: Counts the keys between k1 and k2 from two ranks,
+//  without visiting the keys themselves
+//  Inputs: Given key "limits"
+//  Outputs: Number of keys >= k1 and <= k2
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::count(const K& k1, const K& k2) const
+{
+  if(compare(k2, k1) < 0) return 0;
+  return rank_upper(k2) - rank(k1);
+}
 
-    // copy the rest of the right subtree of rhs_subtree_root
-    copy(lhs_subtree_root->right, rhs_subtree_root->right);
-  }
+//  Function: join()
+//  Description: Joins left, the given pair, and right into this
+//  collection in O(log n) time by linking the shorter tree in at the
+//  matching black height (this collection may be left or right)
+//  Inputs: Tree of smaller keys, key and value, tree of larger keys
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::join(RBTCollection<K,V,A,C,S>& left, const K& a_key,
+                                const V& a_val, RBTCollection<K,V,A,C,S>& right)
+{
+  if(this != &left && this != &right) make_empty();
+  Node* l = (this == &left) ? root : take(left);
+  Node* r = (this == &right) ? root : take(right);
+  Node* m = alloc.allocate();
+  m->key = a_key;
+  m->value = a_val;
+  root = join(l, m, r);
+  node_count = root->size;
 }
 
-// helper function for find-range
-template<typename K, typename V>
-void RBTCollection<K,V>::find(const Node* subtree_root, 
-const K& k1, const K& k2, ArrayList<K>& keys) const
+//  Function: join()
+//  Description: Joins left and right into this collection in O(log n)
+//  time (this collection may be left or right)
+//  Inputs: Tree of smaller keys, tree of larger keys
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::join(RBTCollection<K,V,A,C,S>& left,
+                                RBTCollection<K,V,A,C,S>& right)
 {
-  // check if you have reached the end of a path (base case)
-  if(!subtree_root) return;
+  if(&left == &right) return;
+  if(this != &left && this != &right) make_empty();
+  Node* l = (this == &left) ? root : take(left);
+  Node* r = (this == &right) ? root : take(right);
+  root = join(l, r);
+  node_count = node_size(root);
+}
 
-  // traverse through the tree
-  if(subtree_root->key < k1){
-    find(subtree_root->right, k1, k2, keys);  // traverse right
+//  Function: split()
+//  Description: Splits the tree around a key in O(log n) time. The
+//  nodes are moved, not copied, so left and right share this
+//  collection's node storage afterwards.
+//  Inputs: Key to split at, trees for the smaller and the other keys
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::split(const K& a_key, RBTCollection<K,V,A,C,S>& left,
+                                 RBTCollection<K,V,A,C,S>& right)
+{
+  Node* l = nullptr;
+  Node* r = nullptr;
+  split(root, a_key, l, r);
+  root = nullptr;
+  node_count = 0;
+  // left and right take over this collection's nodes
+  if(&left != this){
+    left.make_empty();
+    left.alloc.share(alloc);
   }
-  else if(subtree_root->key >= k1 && subtree_root->key <= k2){
-    keys.add(subtree_root->key);  // if the key is within range, add it to the array list
-    find(subtree_root->right, k1, k2, keys);  // traverse right
-    find(subtree_root->left, k1, k2, keys); // traverse left
+  if(&right != this && &right != &left){
+    right.make_empty();
+    right.alloc.share(alloc);
   }
-  else{
-    find(subtree_root->left, k1, k2, keys); // traverse left
+  if(&left != this && &right != this) alloc.release();
+  if(&left == &right){
+    left.root = join(l, r);
+    left.node_count = node_size(left.root);
+    return;
   }
+  left.root = l;
+  left.node_count = node_size(l);
+  right.root = r;
+  right.node_count = node_size(r);
 }
 
-// helper function for keys
-template<typename K, typename V>
-void RBTCollection<K,V>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+//  Function: set_union()
+//  Description: Merges rhs into this collection by splitting rhs at
+//  this tree's root and uniting the halves recursively (in parallel
+//  tasks near the top of the tree), O(m log(n/m + 1)) work
+//  Inputs: Collection to merge in, maximum number of threads
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::set_union(RBTCollection<K,V,A,C,S>& rhs, size_t threads)
 {
-  // check if you have reached the end of a path (base case)
-  if(!subtree_root) return;
-  // traverse left subtree
-  keys(subtree_root->left, all_keys);
-  // visit subtree_root
-  all_keys.add(subtree_root->key);
-  // traverse right subtree
-  keys(subtree_root->right, all_keys);
+  if(this == &rhs) return;
+  Node* t2 = take(rhs);
+  ArrayList<Node*> garbage;
+  root = unite(root, t2, spawn_depth(threads), garbage);
+  release_nodes(garbage);
+  node_count = node_size(root);
 }
 
-// helper function for right rotations
-template<typename K, typename V>
-void RBTCollection<K,V>::rotate_right(Node*k2){
-  Node* k1 = k2->left;  // k1 is k2's left child
+//  Function: set_intersection()
+//  Description: Keeps only the keys also in rhs (same approach as
+//  set_union)
+//  Inputs: Collection to intersect with, maximum number of threads
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::set_intersection(RBTCollection<K,V,A,C,S>& rhs,
+                                            size_t threads)
+{
+  if(this == &rhs) return;
+  Node* t2 = take(rhs);
+  ArrayList<Node*> garbage;
+  root = intersect(root, t2, spawn_depth(threads), garbage);
+  release_nodes(garbage);
+  node_count = node_size(root);
+}
+
+//  Function: set_difference()
+//  Description: Removes the keys in rhs from this collection (same
+//  approach as set_union)
+//  Inputs: Collection of keys to remove, maximum number of threads
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::set_difference(RBTCollection<K,V,A,C,S>& rhs,
+                                          size_t threads)
+{
+  if(this == &rhs){
+    make_empty();
+    return;
+  }
+  Node* t2 = take(rhs);
+  ArrayList<Node*> garbage;
+  root = subtract(root, t2, spawn_depth(threads), garbage);
+  release_nodes(garbage);
+  node_count = node_size(root);
+}
+
+//  Function: node_allocations()
+//  Description: Returns the number of calls the node allocator has made
+//  to the system allocator
+//  Inputs: None
+//  Outputs: Number of system allocations for nodes
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::node_allocations() const
+{
+  return alloc.system_allocations();
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection object, its
+//  nodes, and the keys' and values' dynamic memory
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::memory_usage() const
+{
+  size_t bytes = sizeof(*this) + node_count * sizeof(Node);
+  const Node* x = root;
+  while(x && x->left) x = x->left;
+  // walk the nodes in order (no recursion or extra storage)
+  for(; x; x = successor(x))
+    bytes += DynamicMemory<K>::bytes(x->key) + DynamicMemory<V>::bytes(x->value);
+  return bytes;
+}
+
+//  Function: stats()
+//  Description: Returns the flips, rotations and path lengths counted
+//  by the statistics policy since the last reset
+//  Inputs: None
+//  Outputs: Rebalancing counts (all zero unless counted)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTStats RBTCollection<K,V,A,C,S>::stats() const
+{
+  return counters.stats();
+}
+
+//  Function: reset_stats()
+//  Description: Starts the rebalancing counts over
+//  Inputs: None
+//  Outputs: None
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::reset_stats()
+{
+  counters.reset();
+}
+
+//  Function: begin()
+//  Description: Returns an iterator to the pair with the smallest key
+//  Inputs: None
+//  Outputs: Iterator to the first pair (end() if the tree is empty)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator RBTCollection<K,V,A,C,S>::begin()
+{
+  Node* x = root;
+  while(x && x->left) x = x->left;
+  return iterator(x, this);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::const_iterator RBTCollection<K,V,A,C,S>::begin() const
+{
+  return const_cast<RBTCollection<K,V,A,C,S>*>(this)->begin();
+}
+
+//  Function: end()
+//  Description: Returns the iterator past the pair with the largest key
+//  Inputs: None
+//  Outputs: End iterator
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator RBTCollection<K,V,A,C,S>::end()
+{
+  return iterator(nullptr, this);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::const_iterator RBTCollection<K,V,A,C,S>::end() const
+{
+  return const_iterator(nullptr, this);
+}
+
+//  Function: lower_bound()
+//  Description: Finds the first pair whose key is not less than the
+//  given key, in one root-to-leaf walk
+//  Inputs: Key to search for
+//  Outputs: Iterator to the pair (end() if there is none)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator
+RBTCollection<K,V,A,C,S>::lower_bound(const K& search_key)
+{
+  return iterator(lower_bound_node(search_key), this);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::const_iterator
+RBTCollection<K,V,A,C,S>::lower_bound(const K& search_key) const
+{
+  return const_iterator(lower_bound_node(search_key), this);
+}
+
+//  Function: upper_bound()
+//  Description: Finds the first pair whose key is greater than the
+//  given key, in one root-to-leaf walk
+//  Inputs: Key to search for
+//  Outputs: Iterator to the pair (end() if there is none)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator
+RBTCollection<K,V,A,C,S>::upper_bound(const K& search_key)
+{
+  return iterator(upper_bound_node(search_key), this);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::const_iterator
+RBTCollection<K,V,A,C,S>::upper_bound(const K& search_key) const
+{
+  return const_iterator(upper_bound_node(search_key), this);
+}
+
+//  Function: equal_range()
+//  Description: Finds the range of pairs whose key equals the given key
+//  Inputs: Key to search for
+//  Outputs: lower_bound and upper_bound of the key
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+std::pair<typename RBTCollection<K,V,A,C,S>::iterator,
+          typename RBTCollection<K,V,A,C,S>::iterator>
+RBTCollection<K,V,A,C,S>::equal_range(const K& search_key)
+{
+  return std::make_pair(lower_bound(search_key), upper_bound(search_key));
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+std::pair<typename RBTCollection<K,V,A,C,S>::const_iterator,
+          typename RBTCollection<K,V,A,C,S>::const_iterator>
+RBTCollection<K,V,A,C,S>::equal_range(const K& search_key) const
+{
+  return std::make_pair(lower_bound(search_key), upper_bound(search_key));
+}
+
+//  Function: add_near()
+//  Description: Adds a new key-value pair, searching for its place from
+//  the hint instead of the root and rebalancing bottom up. Keys added in
+//  (nearly) ascending or descending order with the previous add as the
+//  hint take O(1) compares each. The subtree sizes on the path to the
+//  root are still updated, but without any key compares.
+//  Inputs: Iterator near the key (end() searches from the root), key
+//  and value to be added to the tree
+//  Outputs: Iterator to the new pair
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator
+RBTCollection<K,V,A,C,S>::add_near(const_iterator hint, const K& a_key, const V& a_val)
+{
+  Node* n = alloc.allocate(a_key, a_val);
+  counters.add();
+  Node* x = finger_start(const_cast<Node*>(hint.node), a_key);
+  Node* p = nullptr;
+  // search down from the subtree found near the hint
+  while(x){
+    counters.visit();
+    p = x;
+    if(compare(a_key, x->key) <= 0)
+      x = x->left;
+    else
+      x = x->right;
+  }
+  if(!p)  // special case - add to an empty tree
+    root = n;
+  else{
+    if(compare(a_key, p->key) <= 0)
+      p->left = n;
+    else
+      p->right = n;
+    n->parent = p;
+    adjust_sizes(p, 1); // count n in each ancestor's subtree
+  }
+  join_rebalance(n, root, &counters);  // bottom-up fixup (colors the root BLACK)
+  node_count++;
+  return iterator(n, this);
+}
+
+//  Function: find_near()
+//  Description: Finds the pair with the given key, searching from the
+//  hint instead of the root
+//  Inputs: Iterator near the key (end() searches from the root), key to
+//  be found
+//  Outputs: Iterator to the pair (end() if the key isn't found)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::iterator
+RBTCollection<K,V,A,C,S>::find_near(const_iterator hint, const K& search_key)
+{
+  Node* x = finger_start(const_cast<Node*>(hint.node), search_key);
+  while(x){
+    int c = compare(search_key, x->key);
+    if(c == 0)
+      break;
+    x = (c < 0) ? x->left : x->right;
+  }
+  return iterator(x, this);
+}
+
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::const_iterator
+RBTCollection<K,V,A,C,S>::find_near(const_iterator hint, const K& search_key) const
+{
+  return const_cast<RBTCollection<K,V,A,C,S>*>(this)->find_near(hint, search_key);
+}
+
+//----------------------------------------------------------------------
+// Helper Functions
+//----------------------------------------------------------------------
+
+// helper function for find and find_ptr
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Q>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::find_node(const Q& search_key) const
+{
+  Node* cur = root; // Node pointer to keep track of current location in the tree
+  while(cur){
+    int c = compare(search_key, cur->key);
+    if(c == 0) // search_key is found
+      return cur;
+    else if(c < 0) // key at cur is less than search_key
+      cur = cur->left;  // iterate through cur's left subtree
+    else  // key at cur is greater than search_key
+      cur = cur->right; // iterate through cur's right subtree
+  }
+  return nullptr;
+}
+
+// helper function for find_or_insert and insert_or_assign
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename... Args>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::find_or_add(const K& a_key, bool& added, Args&&... args)
+{
+  Node* x = root; // pointer to the current node
+  Node* p = nullptr;  // pointer to the parent of the current node
+  int c = 0;
+  // iterate through the tree and rebalance (as in add) until the key
+  // or its insertion point is found
+  counters.add();
+  while(x){
+    counters.visit();
+    c = compare(a_key, x->key);
+    if(c == 0){
+      // the flips and rotations made on the way down leave a valid tree
+      root->color = BLACK;
+      added = false;
+      return x;
+    }
+    add_rebalance(x); // rebalance the RBT
+    p = x;  // move the parent node forward
+    x = (c < 0) ? x->left : x->right;
+  }
+  // add the new node at the insertion point
+  Node* n = alloc.allocate(a_key, std::forward<Args>(args)...);
+  if(!p)  // special case - add to an empty list
+    root = n;
+  else{
+    if(c < 0)
+      p->left = n;
+    else
+      p->right = n;
+    n->parent = p;
+    adjust_sizes(p, 1); // count n in each ancestor's subtree
+    add_rebalance(n);
+  }
+  root->color = BLACK; // color the root BLACK
+  node_count++; // increase the node count
+  added = true;
+  return n;
+}
+
+// helper function for destructor and assignment operator
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::make_empty()
+{
+  // nodes only need to be visited if they have destructors to run,
+  // the allocator cannot free them in bulk (or shares them with
+  // another tree)
+  if(!(A<Node>::bulk_release && std::is_trivially_destructible<Node>::value)
+     || !alloc.owns_storage())
+    make_empty(root);
+  alloc.release();
+  root = nullptr;
+  node_count = 0;
+}
+
+// helper function to deallocate a subtree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::make_empty(Node* subtree_root)
+{
+  // if the subtree root is null, return (base case)
+  if(!subtree_root){
+    return;
+  }
+  // delete the left and right subtrees of the current node
+  if(subtree_root->left){
+    make_empty(subtree_root->left);
+    subtree_root->left = nullptr;
+  }
+  if(subtree_root->right){
+    make_empty(subtree_root->right);
+    subtree_root->right = nullptr;
+  }
+  // delete the current node
+  // if(subtree_root->parent) subtree_root->parent = nullptr;
+  alloc.deallocate(subtree_root);
+  node_count--;
+}
+
+// helper function for copy constructor
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::copy(Node* lhs_subtree_root, const Node* rhs_subtree_root)
+{
+  // base case (if the root is nullptr)
+  if(!rhs_subtree_root) return;
+  // copy left subtree over if it exists
+  if(rhs_subtree_root->left){
+    // new Node to copy to left subtree of lhs_subtree_root
+    Node* tmp = alloc.allocate();
+    tmp->key = rhs_subtree_root->left->key;
+    tmp->value = rhs_subtree_root->left->value;
+    tmp->left = nullptr;
+    tmp->right = nullptr;
+    tmp->parent = nullptr;
+    tmp->color = rhs_subtree_root->left->color;
+    tmp->size = rhs_subtree_root->left->size;
+
+    // add new Node to the left subtree of lhs_subtree_root
+    lhs_subtree_root->left = tmp;
+    tmp->parent = lhs_subtree_root;
+    node_count++; // increment node_count variable
+
+    // copy the rest of the left subtree of rhs_subtree_root
+    copy(lhs_subtree_root->left, rhs_subtree_root->left);
+  }
+
+  // copy right subtree over if it exists
+  if(rhs_subtree_root->right){
+
+    // new Node to copy to right subtree of lhs_subtree_root
+    Node* tmp = alloc.allocate();
+    tmp->key = rhs_subtree_root->right->key;
+    tmp->value = rhs_subtree_root->right->value;
+    tmp->left = nullptr;
+    tmp->right = nullptr;
+    tmp->parent = nullptr;
+    tmp->color = rhs_subtree_root->right->color;
+    tmp->size = rhs_subtree_root->right->size;
+
+    // add new Node to the right subtree of lhs_subtree_root
+    lhs_subtree_root->right = tmp;
+    tmp->parent = lhs_subtree_root;
+    node_count++; // increment node_count variable
+
+    // copy the rest of the right subtree of rhs_subtree_root
+    copy(lhs_subtree_root->right, rhs_subtree_root->right);
+  }
+}
+
+// helper function for the bulk builds
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Fill>
+void RBTCollection<K,V,A,C,S>::build_tree(size_t n, Fill& fill)
+{
+  make_empty();
+  if(n == 0) return;
+  // the split below puts every leaf at depth floor(log2 n) or one
+  // above it, so coloring the deepest level RED (and everything else
+  // BLACK) gives equal black heights on every path
+  size_t red_depth = 0;
+  while((n >> (red_depth + 1)) > 0) ++red_depth;
+  Node* block = alloc.allocate_block(n); // nullptr if not supported
+  size_t used = 0;
+  root = build_tree(n, 0, red_depth, block, used, fill);
+  root->parent = nullptr;
+  root->color = BLACK;
+  node_count = n;
+}
+
+// helper function for the bulk builds (in-order, so the nodes of a
+// block are laid out in key order)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Fill>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::build_tree(size_t n, size_t depth, size_t red_depth,
+                                 Node* block, size_t& used, Fill& fill)
+{
+  if(n == 0) return nullptr;
+  size_t left_count = (n - 1) / 2;
+  Node* lptr = build_tree(left_count, depth + 1, red_depth, block, used, fill);
+  Node* x = block ? block + used++ : alloc.allocate();
+  fill(x);
+  x->color = (depth == red_depth && depth > 0) ? RED : BLACK;
+  x->left = lptr;
+  if(lptr) lptr->parent = x;
+  x->right = build_tree(n - 1 - left_count, depth + 1, red_depth, block, used, fill);
+  if(x->right) x->right->parent = x;
+  x->size = n;
+  return x;
+}
+
+// helper function for scan (and find-range)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename Visit>
+bool RBTCollection<K,V,A,C,S>::scan(const Node* subtree_root,
+const K& k1, const K& k2, Visit& visit) const
+{
+  // check if you have reached the end of a path (base case)
+  if(!subtree_root) return true;
+
+  int c1 = compare(subtree_root->key, k1);
+  int c2 = compare(subtree_root->key, k2);
+  // traverse left only if smaller keys can still be in range
+  if(c1 > 0 && !scan(subtree_root->left, k1, k2, visit))
+    return false;
+  // visit subtree_root if its key is within range
+  if(c1 >= 0 && c2 <= 0 && !visit(subtree_root->key, subtree_root->value))
+    return false;
+  // traverse right only if larger keys can still be in range
+  if(c2 < 0)
+    return scan(subtree_root->right, k1, k2, visit);
+  return true;
+}
+
+// helper function for keys
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::keys(const Node* subtree_root, ArrayList<K>& all_keys) const
+{
+  // check if you have reached the end of a path (base case)
+  if(!subtree_root) return;
+  // traverse left subtree
+  keys(subtree_root->left, all_keys);
+  // visit subtree_root
+  all_keys.add(subtree_root->key);
+  // traverse right subtree
+  keys(subtree_root->right, all_keys);
+}
+
+// helper function for subtree sizes
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::node_size(const Node* subtree_root)
+{
+  return subtree_root ? subtree_root->size : 0;
+}
+
+// helper function to recompute a subtree size
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::update_size(Node* x)
+{
+  x->size = node_size(x->left) + node_size(x->right) + 1;
+}
+
+// helper function to adjust the subtree sizes on the path to the root
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::adjust_sizes(Node* x, long delta)
+{
+  while(x && x != &sentinel){
+    x->size += delta;
+    x = x->parent;
+  }
+}
+
+// helper function for count
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::rank_upper(const K& a_key) const
+{
+  size_t r = 0;
+  Node* x = root;
+  while(x){
+    if(compare(a_key, x->key) < 0)
+      x = x->left;
+    else{
+      r += node_size(x->left) + 1; // x and its left subtree are <= a_key
+      x = x->right;
+    }
+  }
+  return r;
+}
+
+// helper function for right rotations
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::rotate_right(Node*k2){
+  rotate_right(k2, root);
+}
+
+// helper function for left rotations
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::rotate_left(Node* k2){
+  rotate_left(k2, root);
+}
+
+// helper function for right rotations in a given tree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::rotate_right(Node*k2, Node*& top){
+  Node* k1 = k2->left;  // k1 is k2's left child
   // point k2's left to k1's right subtree
   k2->left = k1->right;
   if(k2->left) k2->left->parent = k2;
   k1->right = k2; // move k2 to be k1's right child
+  // update the subtree sizes (k2 first, since it is now below k1)
+  update_size(k2);
+  update_size(k1);
   // update k1 and k2's parents
   k1->parent = k2->parent;
-  if(!k2->parent) root = k1;
+  if(!k2->parent) top = k1;
   else{
     if(k2 == k2->parent->right) k2->parent->right = k1;
     else k2->parent->left = k1;
@@ -534,17 +1740,20 @@ void RBTCollection<K,V>::rotate_right(Node*k2){
   k2->parent = k1;
 }
 
-// helper function for left rotations
-template<typename K, typename V>
-void RBTCollection<K,V>::rotate_left(Node* k2){
+// helper function for left rotations in a given tree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::rotate_left(Node* k2, Node*& top){
   Node* k1 = k2->right;  // k1 is k2's right child
   // point k2's right to k1's left subtree
   k2->right = k1->left;
   if(k2->right) k2->right->parent = k2;  
   k1->left = k2; // move k2 to be k1's right child
+  // update the subtree sizes (k2 first, since it is now below k1)
+  update_size(k2);
+  update_size(k1);
   // update k1 and k2's parents
   k1->parent = k2->parent;
-  if(!k2->parent) root = k1;
+  if(!k2->parent) top = k1;
   else{
     if(k2 == k2->parent->right) k2->parent->right = k1;
     else k2->parent->left = k1;
@@ -552,10 +1761,444 @@ void RBTCollection<K,V>::rotate_left(Node* k2){
   k2->parent = k1;
 }
 
+// helper function for join: black height of a subtree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::black_height(const Node* subtree_root)
+{
+  size_t h = 0;
+  for(; subtree_root; subtree_root = subtree_root->left)
+    if(subtree_root->color == BLACK) ++h;
+  return h;
+}
+
+// helper function for join: attach m (and r) where the black heights
+// match, then fix the red-red violation on the way up
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::join(Node* l, Node* m, Node* r)
+{
+  // the roots of the detached trees can always be made BLACK
+  if(l){ l->parent = nullptr; l->color = BLACK; }
+  if(r){ r->parent = nullptr; r->color = BLACK; }
+  size_t lh = black_height(l);
+  size_t rh = black_height(r);
+  m->parent = nullptr;
+
+  // equal black heights - m becomes the new (BLACK) root
+  if(lh == rh){
+    m->left = l;
+    m->right = r;
+    if(l) l->parent = m;
+    if(r) r->parent = m;
+    m->color = BLACK;
+    update_size(m);
+    return m;
+  }
+
+  // walk down the inner spine of the taller tree (the right spine of
+  // l, or the left spine of r) to a BLACK node (or null) with the
+  // shorter tree's black height, and put m (RED) in its place
+  bool left_taller = lh > rh;
+  Node* top = left_taller ? l : r;
+  size_t h = left_taller ? lh : rh;
+  size_t target = left_taller ? rh : lh;
+  Node* p = nullptr;
+  Node* x = top;
+  while(h != target || (x && x->color == RED)){
+    if(x->color == BLACK) --h;
+    p = x;
+    x = left_taller ? x->right : x->left;
+  }
+  if(left_taller){
+    m->left = x;
+    m->right = r;
+    p->right = m;
+  }
+  else{
+    m->left = l;
+    m->right = x;
+    p->left = m;
+  }
+  if(m->left) m->left->parent = m;
+  if(m->right) m->right->parent = m;
+  m->parent = p;
+  m->color = RED;
+  update_size(m);
+  // the ancestors of m gained m and the shorter tree
+  size_t added = 1 + node_size(left_taller ? r : l);
+  for(Node* y = p; y; y = y->parent)
+    y->size += added;
+  join_rebalance(m, top);
+  return top;
+}
+
+// helper function for join: join without a middle node
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::join(Node* l, Node* r)
+{
+  if(!l){
+    if(r) r->parent = nullptr;
+    return r;
+  }
+  if(!r){
+    l->parent = nullptr;
+    return l;
+  }
+  // use the largest key of l as the middle node
+  Node* rest = nullptr;
+  Node* last = nullptr;
+  split_last(l, rest, last);
+  return join(rest, last, r);
+}
+
+// helper function for join: detach the largest node of a tree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::split_last(Node* t, Node*& rest, Node*& last)
+{
+  Node* l = nullptr;
+  Node* r = nullptr;
+  detach(t, l, r);
+  if(!r){
+    rest = l;
+    last = t;
+    return;
+  }
+  Node* r_rest = nullptr;
+  split_last(r, r_rest, last);
+  rest = join(l, t, r_rest);
+}
+
+// helper function for split: keys < a_key go to l, the rest to r
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::split(Node* t, const K& a_key, Node*& l, Node*& r)
+{
+  if(!t){
+    l = nullptr;
+    r = nullptr;
+    return;
+  }
+  Node* tl = nullptr;
+  Node* tr = nullptr;
+  detach(t, tl, tr);
+  if(compare(t->key, a_key) < 0){
+    // t and its left subtree are all < a_key
+    Node* mid = nullptr;
+    split(tr, a_key, mid, r);
+    l = join(tl, t, mid);
+  }
+  else{
+    // t and its right subtree are all >= a_key
+    Node* mid = nullptr;
+    split(tl, a_key, l, mid);
+    r = join(mid, t, tr);
+  }
+}
+
+// helper function for the set operations: split around a_key
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::split(Node* t, const K& a_key, Node*& l,
+                                 Node*& found, Node*& r)
+{
+  if(!t){
+    l = nullptr;
+    found = nullptr;
+    r = nullptr;
+    return;
+  }
+  Node* tl = nullptr;
+  Node* tr = nullptr;
+  detach(t, tl, tr);
+  int c = compare(a_key, t->key);
+  if(c < 0){
+    Node* mid = nullptr;
+    split(tl, a_key, l, found, mid);
+    r = join(mid, t, tr);
+  }
+  else if(c > 0){
+    Node* mid = nullptr;
+    split(tr, a_key, mid, found, r);
+    l = join(tl, t, mid);
+  }
+  else{
+    l = tl;
+    found = t;
+    r = tr;
+    if(l) l->parent = nullptr;
+    if(r) r->parent = nullptr;
+  }
+}
+
+// helper function for join: bottom-up red-black insert fixup
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::join_rebalance(Node* x, Node*& top, S* counts)
+{
+  while(x->parent && x->parent->color == RED){
+    Node* p = x->parent;
+    Node* g = p->parent;  // exists, since a RED node is never the root
+    Node* u = (p == g->left) ? g->right : g->left;
+    // case 1 - RED uncle, color flip and continue from g
+    if(u && u->color == RED){
+      p->color = BLACK;
+      u->color = BLACK;
+      g->color = RED;
+      x = g;
+      if(counts) counts->color_flip();
+    }
+    // cases 2 and 3 - rotate(s) at p and g
+    else if(p == g->left){
+      if(x == p->right){
+        rotate_left(p, top);
+        x = p;
+        p = x->parent;
+        if(counts) counts->double_rotation();
+      }
+      else if(counts) counts->single_rotation();
+      rotate_right(g, top);
+      p->color = BLACK;
+      g->color = RED;
+    }
+    else{
+      if(x == p->left){
+        rotate_right(p, top);
+        x = p;
+        p = x->parent;
+        if(counts) counts->double_rotation();
+      }
+      else if(counts) counts->single_rotation();
+      rotate_left(g, top);
+      p->color = BLACK;
+      g->color = RED;
+    }
+  }
+  top->color = BLACK;
+}
+
+// helper function for the set operations: union of t1 and t2
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::unite(Node* t1, Node* t2, size_t spawn_depth,
+                            ArrayList<Node*>& garbage)
+{
+  if(!t1) return t2;
+  if(!t2) return t1;
+  // split t2 around the root of t1 (whose value wins)
+  Node* l1 = nullptr;
+  Node* r1 = nullptr;
+  detach(t1, l1, r1);
+  Node* l2 = nullptr;
+  Node* dup = nullptr;
+  Node* r2 = nullptr;
+  split(t2, t1->key, l2, dup, r2);
+  if(dup) garbage.add(dup);
+  Node* l = nullptr;
+  Node* r = nullptr;
+  if(spawn_depth > 0 && node_size(t1) + node_size(t2) >= PARALLEL_CUTOFF){
+    ArrayList<Node*> left_garbage;
+    std::future<Node*> left = std::async(std::launch::async, unite, l1, l2,
+                                         spawn_depth - 1, std::ref(left_garbage));
+    r = unite(r1, r2, spawn_depth - 1, garbage);
+    l = left.get();
+    for(size_t i = 0; i < left_garbage.size(); ++i){
+      Node* n = nullptr;
+      left_garbage.get(i, n);
+      garbage.add(n);
+    }
+  }
+  else{
+    l = unite(l1, l2, 0, garbage);
+    r = unite(r1, r2, 0, garbage);
+  }
+  return join(l, t1, r);
+}
+
+// helper function for the set operations: intersection of t1 and t2
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::intersect(Node* t1, Node* t2, size_t spawn_depth,
+                                ArrayList<Node*>& garbage)
+{
+  if(!t1 || !t2){
+    // nothing in the other tree can match
+    collect(t1, garbage);
+    collect(t2, garbage);
+    return nullptr;
+  }
+  Node* l1 = nullptr;
+  Node* r1 = nullptr;
+  detach(t1, l1, r1);
+  Node* l2 = nullptr;
+  Node* dup = nullptr;
+  Node* r2 = nullptr;
+  split(t2, t1->key, l2, dup, r2);
+  Node* l = nullptr;
+  Node* r = nullptr;
+  if(spawn_depth > 0 && node_size(t1) + node_size(t2) >= PARALLEL_CUTOFF){
+    ArrayList<Node*> left_garbage;
+    std::future<Node*> left = std::async(std::launch::async, intersect, l1, l2,
+                                         spawn_depth - 1, std::ref(left_garbage));
+    r = intersect(r1, r2, spawn_depth - 1, garbage);
+    l = left.get();
+    for(size_t i = 0; i < left_garbage.size(); ++i){
+      Node* n = nullptr;
+      left_garbage.get(i, n);
+      garbage.add(n);
+    }
+  }
+  else{
+    l = intersect(l1, l2, 0, garbage);
+    r = intersect(r1, r2, 0, garbage);
+  }
+  // keep t1's node only if t2 had the same key
+  if(dup){
+    garbage.add(dup);
+    return join(l, t1, r);
+  }
+  garbage.add(t1);
+  return join(l, r);
+}
+
+// helper function for the set operations: t1 minus t2
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::subtract(Node* t1, Node* t2, size_t spawn_depth,
+                               ArrayList<Node*>& garbage)
+{
+  if(!t1 || !t2){
+    // the nodes of t2 are no longer needed
+    collect(t2, garbage);
+    return t1;
+  }
+  // split t1 around the root of t2 (which is always dropped)
+  Node* l2 = nullptr;
+  Node* r2 = nullptr;
+  detach(t2, l2, r2);
+  Node* l1 = nullptr;
+  Node* dup = nullptr;
+  Node* r1 = nullptr;
+  split(t1, t2->key, l1, dup, r1);
+  garbage.add(t2);
+  if(dup) garbage.add(dup);
+  Node* l = nullptr;
+  Node* r = nullptr;
+  if(spawn_depth > 0 && node_size(t1) + node_size(t2) >= PARALLEL_CUTOFF){
+    ArrayList<Node*> left_garbage;
+    std::future<Node*> left = std::async(std::launch::async, subtract, l1, l2,
+                                         spawn_depth - 1, std::ref(left_garbage));
+    r = subtract(r1, r2, spawn_depth - 1, garbage);
+    l = left.get();
+    for(size_t i = 0; i < left_garbage.size(); ++i){
+      Node* n = nullptr;
+      left_garbage.get(i, n);
+      garbage.add(n);
+    }
+  }
+  else{
+    l = subtract(l1, l2, 0, garbage);
+    r = subtract(r1, r2, 0, garbage);
+  }
+  return join(l, r);
+}
+
+// helper function for the set operations: drop a whole subtree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::collect(Node* t, ArrayList<Node*>& garbage)
+{
+  if(!t) return;
+  collect(t->left, garbage);
+  collect(t->right, garbage);
+  garbage.add(t);
+}
+
+// helper function for join and split: detach a node's children
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::detach(Node* t, Node*& l, Node*& r)
+{
+  l = t->left;
+  r = t->right;
+  if(l) l->parent = nullptr;
+  if(r) r->parent = nullptr;
+  t->left = nullptr;
+  t->right = nullptr;
+}
+
+// helper function for the set operations: levels of tasks to spawn
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::spawn_depth(size_t threads)
+{
+  // each level doubles the number of tasks running at once
+  size_t depth = 0;
+  while((size_t(1) << depth) < threads) ++depth;
+  return depth;
+}
+
+// helper function for join and the set operations: take over the
+// nodes of rhs (rhs must not be this collection)
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::take(RBTCollection<K,V,A,C,S>& rhs)
+{
+  Node* t = rhs.root;
+  rhs.root = nullptr;
+  rhs.node_count = 0;
+  alloc.absorb(rhs.alloc);
+  return t;
+}
+
+// helper function for the set operations: free the left-over nodes
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::release_nodes(ArrayList<Node*>& garbage)
+{
+  for(size_t i = 0; i < garbage.size(); ++i){
+    Node* n = nullptr;
+    garbage.get(i, n);
+    alloc.deallocate(n);
+  }
+}
+
+// helper function for find_many
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::prefetch(const Node* x)
+{
+#if defined(__GNUC__)
+  __builtin_prefetch(x);
+#else
+  (void)x;  // no prefetch builtin
+#endif
+}
+
+// helper function for range remove
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::remove_range(Node* t, const K& k1, const K& k2)
+{
+  if(!t) return nullptr;
+  Node* tl = nullptr;
+  Node* tr = nullptr;
+  if(compare(t->key, k1) < 0){
+    // t and its left subtree are below the range
+    if(!t->right) return t;
+    detach(t, tl, tr);
+    return join(tl, t, remove_range(tr, k1, k2));
+  }
+  if(compare(t->key, k2) > 0){
+    // t and its right subtree are above the range
+    if(!t->left) return t;
+    detach(t, tl, tr);
+    return join(remove_range(tl, k1, k2), t, tr);
+  }
+  // t is in the range, keep what is left of its subtrees
+  detach(t, tl, tr);
+  alloc.deallocate(t);
+  node_count--;
+  Node* l = remove_range(tl, k1, k2);
+  Node* r = remove_range(tr, k1, k2);
+  return join(l, r);
+}
 
 // helper function for rebalancing during the add function
-template<typename K, typename V>
-void RBTCollection<K,V>::add_rebalance(Node* x){
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::add_rebalance(Node* x){
   if(!x) return;  // case if the list is empty
 
   Node* p = x->parent;  // parent node pointer
@@ -569,6 +2212,7 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
     x->color = RED;
     lptr->color = BLACK;
     rptr->color = BLACK;
+    counters.color_flip();
   }
   if(p && p->color == RED && x->color == RED){
     Node* g = p->parent;
@@ -576,6 +2220,7 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
     if(g && p == g->right){
       // case 3 - right-left rotation (x is an inside node)
       if(x == p->left){
+        counters.double_rotation();
         rotate_right(p);  // rotate right at p
         rotate_left(g); // rotate left at g
         // adjust colors
@@ -584,6 +2229,7 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
       }
       // case 2 - left rotation (x is an outside node)
       else if(x == p->right){
+        counters.single_rotation();
         rotate_left(g);
         p->color = BLACK;
         g->color = RED;
@@ -593,6 +2239,7 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
     else if(g && p == g->left){
       // case 2 - right rotation (X is an outside node)
       if(x == p->left){
+        counters.single_rotation();
         rotate_right(g);
         // adjust colors
         p->color = BLACK;
@@ -600,6 +2247,7 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
       }
       // case 3 - left-right rotation (x is an inside node)
       else if(x == p->right){
+        counters.double_rotation();
         rotate_left(p);
         rotate_right(g);
         // adjust colors
@@ -611,8 +2259,8 @@ void RBTCollection<K,V>::add_rebalance(Node* x){
 }
 
 // helper function for rebalancing during the remove function
-template<typename K, typename V>
-void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::remove_rebalance(Node* x, bool going_right){
   if(x->color == RED) return;
 
   Node* p = x->parent;
@@ -624,23 +2272,34 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
 
   // case 1 - x has non-nav RED child
   if((lptr && lptr->color == RED) || (rptr && rptr->color == RED)){
-    if(lptr && lptr->color == RED && going_right){
+    // (nothing to do if the child along the path is already RED)
+    if(lptr && lptr->color == RED && going_right
+       && !(rptr && rptr->color == RED)){
+      counters.single_rotation();
       rotate_right(x);
       x->color = RED;
       lptr->color = BLACK;
     }
-    else if(rptr && rptr->color == RED && !going_right){
+    else if(rptr && rptr->color == RED && !going_right
+            && !(lptr && lptr->color == RED)){
+      counters.single_rotation();
       rotate_left(x);
       x->color = RED;
       rptr->color = BLACK;
     }
   }
+  // case 2 (at the root) - no sibling, so x can simply be made RED
+  else if(!t){
+    x->color = RED;
+    counters.color_flip();
+  }
   // case 2 - color flip
   else if(t && (!t->left || t->left->color == BLACK)
           && (!t->right || t->right->color == BLACK)){
     p->color = BLACK;
     x->color = RED;
     t->color = RED;
+    counters.color_flip();
   }
   // case 3 & 4 - rotations
   else if(t && ((t->left && t->left->color == RED) || 
@@ -649,6 +2308,7 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
       Node* r = t->left;
       // case 3 - t has an outside RED child
       if(t == p->left){
+        counters.single_rotation();
         rotate_right(p);
         t->color = RED;
         r->color = BLACK;
@@ -657,6 +2317,7 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
       }
       // case 4 - t has an inside RED child
       else if(t == p->right){
+        counters.double_rotation();
         rotate_right(t);
         rotate_left(p);
         p->color = BLACK;
@@ -667,6 +2328,7 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
       Node* r = t->right;
       // case 4 - t has an inside RED child
       if(t ==p->left){
+        counters.double_rotation();
         rotate_left(t);
         rotate_right(p);
         p->color = BLACK;
@@ -674,6 +2336,7 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
       }
       // case 3 - t has an outside RED child
       else if(t == p->right){
+        counters.single_rotation();
         rotate_left(p);
         t->color = RED;
         r->color = BLACK;
@@ -684,9 +2347,207 @@ void RBTCollection<K,V>::remove_rebalance(Node* x, bool going_right){
   }
 }
 
+// helper function for iterator increment
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename N>
+N* RBTCollection<K,V,A,C,S>::successor(N* x)
+{
+  // smallest key of the right subtree
+  if(x->right){
+    x = x->right;
+    while(x->left) x = x->left;
+    return x;
+  }
+  // otherwise the first ancestor reached from its left subtree
+  N* p = x->parent;
+  while(p && x == p->right){
+    x = p;
+    p = p->parent;
+  }
+  return p;
+}
+
+// helper function for iterator decrement
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename N>
+N* RBTCollection<K,V,A,C,S>::predecessor(N* x)
+{
+  // largest key of the left subtree
+  if(x->left) return maximum(x->left);
+  // otherwise the first ancestor reached from its right subtree
+  N* p = x->parent;
+  while(p && x == p->left){
+    x = p;
+    p = p->parent;
+  }
+  return p;
+}
+
+// helper function for the largest key in a subtree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+template<typename N>
+N* RBTCollection<K,V,A,C,S>::maximum(N* subtree_root)
+{
+  N* x = subtree_root;
+  while(x && x->right) x = x->right;
+  return x;
+}
+
+// helper function for add_near and find_near
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::finger_start(Node* hint, const K& search_key) const
+{
+  if(!hint)
+    return root;
+  Node* x = hint;
+  bool spine = true;  // every step so far was up a right (or left) edge
+  if(compare(search_key, hint->key) > 0){
+    // climb until an ancestor's key bounds the search key from above
+    // (the hint bounds it from below)
+    while(x->parent){
+      Node* p = x->parent;
+      if(x == p->left){
+        if(compare(search_key, p->key) < 0)
+          return x;
+        spine = false;
+      }
+      x = p;
+    }
+    // nothing above the hint is larger, so the hint is the largest key
+    // and the search key goes directly to its right
+    return spine ? hint : root;
+  }
+  // climb until an ancestor's key bounds the search key from below
+  while(x->parent){
+    Node* p = x->parent;
+    if(x == p->right){
+      if(compare(search_key, p->key) > 0)
+        return x;
+      spine = false;
+    }
+    x = p;
+  }
+  return spine ? hint : root;
+}
+
+// helper function for lower_bound
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::lower_bound_node(const K& search_key) const
+{
+  Node* x = root;
+  Node* candidate = nullptr; // smallest key >= search_key seen so far
+  while(x){
+    if(compare(x->key, search_key) < 0)
+      x = x->right;
+    else{
+      candidate = x;
+      x = x->left;
+    }
+  }
+  return candidate;
+}
+
+// helper function for upper_bound
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+typename RBTCollection<K,V,A,C,S>::Node*
+RBTCollection<K,V,A,C,S>::upper_bound_node(const K& search_key) const
+{
+  Node* x = root;
+  Node* candidate = nullptr; // smallest key > search_key seen so far
+  while(x){
+    if(compare(search_key, x->key) < 0){
+      candidate = x;
+      x = x->left;
+    }
+    else
+      x = x->right;
+  }
+  return candidate;
+}
+
+//  Function: profile()
+//  Description: Walks the tree once in order, following parent links
+//  instead of recursing, and checks that the root is BLACK, no RED node
+//  has a RED child, every path has the same number of BLACK nodes, the
+//  keys are in order, and the parent links and subtree sizes match,
+//  while totalling the depths and colors
+//  Inputs: None
+//  Outputs: Validity and shape of the tree
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+RBTShape RBTCollection<K,V,A,C,S>::profile() const
+{
+  RBTShape shape;
+  if(!root){
+    shape.valid = node_count == 0;
+    return shape;
+  }
+  shape.valid = root->color == BLACK && !root->parent;
+  size_t depth = 0;         // depth of x
+  size_t blacks = 0;        // BLACK nodes from the root to x
+  size_t total_depth = 0;   // sum of the node depths
+  bool leaf_seen = false;   // black_height is set
+  const Node* last = nullptr;  // previous node in order
+  const Node* prev = nullptr;  // node the walk came from
+  const Node* x = root;
+  while(x && shape.valid){
+    const Node* next;
+    if(prev == x->parent){
+      // first arrival at x, from above
+      ++depth;
+      if(x->color == BLACK) ++blacks;
+      else ++shape.red_nodes;
+      ++shape.nodes;
+      total_depth += depth;
+      if(depth > shape.height) shape.height = depth;
+      const Node* l = x->left;
+      const Node* r = x->right;
+      if((l && l->parent != x) || (r && r->parent != x)
+         || x->size != node_size(l) + node_size(r) + 1
+         || (x->color == RED && ((l && l->color == RED) || (r && r->color == RED))))
+        shape.valid = false;
+      // a missing child ends a path, which must match the others
+      if(!l || !r){
+        if(!leaf_seen) shape.black_height = blacks;
+        leaf_seen = true;
+        if(blacks != shape.black_height) shape.valid = false;
+      }
+      if(l)
+        next = l;
+      else{
+        if(last && compare(last->key, x->key) > 0) shape.valid = false;
+        last = x;
+        next = r ? r : x->parent;
+      }
+    }
+    else if(prev == x->left){
+      // back from the left subtree, so x is next in order
+      if(last && compare(last->key, x->key) > 0) shape.valid = false;
+      last = x;
+      next = x->right ? x->right : x->parent;
+    }
+    else
+      next = x->parent;  // back from the right subtree
+    if(next == x->parent){
+      // done with x's subtree
+      if(x->color == BLACK) --blacks;
+      --depth;
+    }
+    prev = x;
+    x = next;
+  }
+  if(shape.nodes != node_count) shape.valid = false;
+  if(shape.nodes > 0){
+    shape.avg_depth = total_depth / (shape.nodes * 1.0);
+    shape.red_ratio = shape.red_nodes / (shape.nodes * 1.0);
+  }
+  return shape;
+}
+
 // helper function for height
-template<typename K, typename V>
-size_t RBTCollection<K,V>::height(Node* subtree_root) const{
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+size_t RBTCollection<K,V,A,C,S>::height(Node* subtree_root) const{
   if(!subtree_root) return 0;
   size_t left_height = 0;  // variable to keep track of the height of the left subtree
   size_t right_height = 0; // variable to keep track of the height of the right subtree
@@ -704,55 +2565,22 @@ size_t RBTCollection<K,V>::height(Node* subtree_root) const{
 // Provided Helper Functions:
 //----------------------------------------------------------------------
 
-template<typename K, typename V>
-bool RBTCollection<K,V>::valid_rbt() const
-{
-  return !root or (root->color == BLACK and valid_rbt(root));
-}
-
-
-template<typename K, typename V>
-bool RBTCollection<K,V>::valid_rbt(Node* subtree_root) const
-{
-  if (!subtree_root)
-    return true;
-  color_t rc = subtree_root->color;
-  color_t lcc = subtree_root->left ? subtree_root->left->color : BLACK;
-  color_t rcc = subtree_root->right ? subtree_root->right->color : BLACK;  
-  size_t lbh = black_node_height(subtree_root->left);
-  size_t rbh = black_node_height(subtree_root->right);
-  bool lv = valid_rbt(subtree_root->left);
-  bool rv = valid_rbt(subtree_root->right);
-  // check equal black node heights, no two consecutive red nodes, and
-  // left and right are valid RBTs
-  return (lbh == rbh) and (rc != RED or (lcc != RED and rcc != RED)) and lv and rv;
-}
-
-
-template<typename K, typename V>
-size_t RBTCollection<K,V>::black_node_height(Node* subtree_root) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+bool RBTCollection<K,V,A,C,S>::valid_rbt() const
 {
-  if (!subtree_root)
-    return 1;
-  size_t hl = black_node_height(subtree_root->left);
-  size_t hr = black_node_height(subtree_root->right);
-  size_t h = hl > hr ? hl : hr;
-  if (subtree_root->color == BLACK)
-    return 1 + h;
-  else
-    return h;
+  return profile().valid;
 }
 
 
-template<typename K, typename V>
-void RBTCollection<K,V>::print() const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::print() const
 {
   print_tree("", root);
 }
 
 
-template<typename K, typename V>
-void RBTCollection<K,V>::print_tree(std::string indent, Node* subtree_root) const
+template<typename K, typename V, template<typename> class A, typename C, typename S>
+void RBTCollection<K,V,A,C,S>::print_tree(std::string indent, Node* subtree_root) const
 {
   if (!subtree_root)
     return;
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------
+// FILE: rbt_stats.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Rebalancing statistics policies for RBTCollection. A policy is
+// told about each add and remove and about the work done on the way:
+//
+//   add() / remove()    an add or remove operation started
+//   visit()             a node was visited on the search path
+//   color_flip()        a color flip (no rotation) during rebalancing
+//   single_rotation()   a single rotation during rebalancing
+//   double_rotation()   a double rotation during rebalancing
+//   sentinel()          remove set up the sentinel above the root
+//   successor_step()    remove stepped toward a two-child node's
+//                       successor
+//   stats()             the counts so far (all zero if not counted)
+//   reset()             start counting over
+//
+// NoRBTStats ignores everything, so with the default policy the calls
+// are empty inline functions that compile to nothing. CountRBTStats
+// keeps the counts.
+//
+// RBTShape is the tree shape reported by RBTCollection::profile, which
+// checks the red-black constraints in the same pass.
+//----------------------------------------------------------------------
+
+#ifndef RBT_STATS_H
+#define RBT_STATS_H
+
+#include <cstddef>
+
+
+// counts reported by a statistics policy
+struct RBTStats
+{
+  size_t adds = 0;              // add operations
+  size_t removes = 0;           // remove operations
+  size_t nodes_visited = 0;     // nodes on the add and remove paths
+  size_t color_flips = 0;       // color flips without a rotation
+  size_t single_rotations = 0;  // single rotations
+  size_t double_rotations = 0;  // double rotations
+  size_t sentinel_setups = 0;   // remove sentinel set ups
+  size_t successor_steps = 0;   // nodes walked to find successors
+};
+
+
+// shape of a tree reported by RBTCollection::profile
+struct RBTShape
+{
+  bool valid = true;        // every constraint checked held
+  size_t nodes = 0;         // nodes in the tree
+  size_t height = 0;        // nodes on the longest root-to-leaf path
+  size_t black_height = 0;  // black nodes on each root-to-leaf path
+  size_t red_nodes = 0;     // RED nodes
+  double avg_depth = 0;     // average node depth (the root is at 1)
+  double red_ratio = 0;     // RED nodes per node
+};
+
+
+struct NoRBTStats
+{
+  static const bool enabled = false;
+
+  void add() {}
+  void remove() {}
+  void visit() {}
+  void color_flip() {}
+  void single_rotation() {}
+  void double_rotation() {}
+  void sentinel() {}
+  void successor_step() {}
+  RBTStats stats() const { return RBTStats(); }
+  void reset() {}
+};
+
+
+struct CountRBTStats
+{
+  static const bool enabled = true;
+
+  void add() { ++counts.adds; }
+  void remove() { ++counts.removes; }
+  void visit() { ++counts.nodes_visited; }
+  void color_flip() { ++counts.color_flips; }
+  void single_rotation() { ++counts.single_rotations; }
+  void double_rotation() { ++counts.double_rotations; }
+  void sentinel() { ++counts.sentinel_setups; }
+  void successor_step() { ++counts.successor_steps; }
+  RBTStats stats() const { return counts; }
+  void reset() { counts = RBTStats(); }
+
+private:
+  RBTStats counts;
+};
+
+
+#endif
@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------
+// FILE: rw_lock.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Lock policies for ConcurrentCollection. A lock policy provides
+// lock()/unlock() for writers and lock_shared()/unlock_shared() for
+// readers:
+//
+//   RWLock         scalable reader-writer lock, readers only touch a
+//                  per-thread slot, so they do not contend with each
+//                  other (writers wait for every slot to drain)
+//   ExclusiveLock  one mutex for everything (readers are serialized)
+//----------------------------------------------------------------------
+
+#ifndef RW_LOCK_H
+#define RW_LOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+
+class RWLock
+{
+public:
+  RWLock();
+
+  // exclusive (writer) access
+  void lock();
+  void unlock();
+
+  // shared (reader) access
+  void lock_shared();
+  void unlock_shared();
+
+private:
+  static const size_t SLOTS = 64;       // reader slots
+  static const size_t CACHE_LINE = 64;  // slot padding
+
+  // reader count for the threads hashed to a slot, on its own cache
+  // line so readers in different slots never share a line
+  struct alignas(CACHE_LINE) Slot {
+    std::atomic<size_t> readers;
+  };
+
+  Slot slots[SLOTS];
+  std::atomic<bool> writer;   // set while a writer holds (or waits for) the lock
+  std::mutex writer_mutex;    // orders the writers
+
+  // no copies
+  RWLock(const RWLock& rhs);
+  RWLock& operator=(const RWLock& rhs);
+
+  // the reader slot of the calling thread
+  static size_t slot();
+};
+
+
+class ExclusiveLock
+{
+public:
+  void lock() {m.lock();}
+  void unlock() {m.unlock();}
+  void lock_shared() {m.lock();}
+  void unlock_shared() {m.unlock();}
+
+private:
+  std::mutex m;
+};
+
+
+// holds shared access to a lock for the lifetime of the guard
+template<typename Lock>
+class SharedGuard
+{
+public:
+  explicit SharedGuard(Lock& l) : lock(l) {lock.lock_shared();}
+  ~SharedGuard() {lock.unlock_shared();}
+
+private:
+  Lock& lock;
+
+  // no copies
+  SharedGuard(const SharedGuard& rhs);
+  SharedGuard& operator=(const SharedGuard& rhs);
+};
+
+
+inline RWLock::RWLock()
+  : writer(false)
+{
+  for(size_t i = 0; i < SLOTS; ++i)
+    slots[i].readers.store(0);
+}
+
+//  Function: lock()
+//  Description: Waits for exclusive access. New readers are turned
+//  away as soon as the writer flag is set, then the writer waits for
+//  the readers already inside to leave.
+//  Inputs: None
+//  Outputs: None
+inline void RWLock::lock()
+{
+  writer_mutex.lock();
+  writer.store(true);
+  for(size_t i = 0; i < SLOTS; ++i)
+    while(slots[i].readers.load() != 0)
+      std::this_thread::yield();
+}
+
+//  Function: unlock()
+//  Description: Releases exclusive access
+//  Inputs: None
+//  Outputs: None
+inline void RWLock::unlock()
+{
+  writer.store(false);
+  writer_mutex.unlock();
+}
+
+//  Function: lock_shared()
+//  Description: Waits for shared access. The reader announces itself
+//  in its slot and then checks the writer flag (both sequentially
+//  consistent, so either the reader sees the writer or the writer sees
+//  the reader), backing out while a writer is active.
+//  Inputs: None
+//  Outputs: None
+inline void RWLock::lock_shared()
+{
+  std::atomic<size_t>& readers = slots[slot()].readers;
+  while(true){
+    readers.fetch_add(1);
+    if(!writer.load()) return;
+    // a writer is active, back out until it is done
+    readers.fetch_sub(1);
+    while(writer.load())
+      std::this_thread::yield();
+  }
+}
+
+//  Function: unlock_shared()
+//  Description: Releases shared access
+//  Inputs: None
+//  Outputs: None
+inline void RWLock::unlock_shared()
+{
+  slots[slot()].readers.fetch_sub(1);
+}
+
+// helper function to find the calling thread's reader slot
+inline size_t RWLock::slot()
+{
+  // hand out slots round-robin (thread ids are often aligned, so
+  // hashing them spreads poorly)
+  static std::atomic<size_t> next_slot(0);
+  static thread_local size_t index = next_slot.fetch_add(1) % SLOTS;
+  return index;
+}
+
+
+#endif
@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------
+// FILE: serialize.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Binary serialization of keys and values for the collection
+// save/load functions. Serializer<T> writes and reads one item:
+//
+//   write(out, item)   append the item's bytes to the stream
+//   read(in, item)     read an item back, returning false on a short
+//                      or malformed read
+//   min_size           the fewest bytes any item is written as (used
+//                      to check counts read from a file against its
+//                      size before allocating for them)
+//
+// Trivially copyable types (ints, doubles, plain structs) are written
+// as their raw bytes, and std::string as a 64-bit length followed by
+// its characters. Other types can be saved by specializing Serializer.
+// The format uses the machine's byte order, so files are only meant to
+// be read back on the same kind of machine.
+//----------------------------------------------------------------------
+
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+
+template<typename T>
+struct Serializer
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "specialize Serializer<T> to save this type");
+
+  static const size_t min_size = sizeof(T);
+
+  static void write(std::ostream& out, const T& item)
+  {
+    out.write(reinterpret_cast<const char*>(&item), sizeof(T));
+  }
+
+  static bool read(std::istream& in, T& item)
+  {
+    return bool(in.read(reinterpret_cast<char*>(&item), sizeof(T)));
+  }
+};
+
+
+template<>
+struct Serializer<std::string>
+{
+  static const size_t min_size = sizeof(uint64_t);
+
+  static void write(std::ostream& out, const std::string& item)
+  {
+    Serializer<uint64_t>::write(out, item.size());
+    out.write(item.data(), item.size());
+  }
+
+  static bool read(std::istream& in, std::string& item)
+  {
+    uint64_t length = 0;
+    if(!Serializer<uint64_t>::read(in, length)) return false;
+    // read in pieces, so a corrupt length fails at the end of the file
+    // instead of turning into a huge allocation
+    const uint64_t PIECE = 65536;
+    item.clear();
+    while(length > 0){
+      size_t n = length < PIECE ? length : PIECE;
+      size_t used = item.size();
+      item.resize(used + n);
+      if(!in.read(&item[used], n)) return false;
+      length -= n;
+    }
+    return true;
+  }
+};
+
+
+#endif
@@ -0,0 +1,501 @@
+//----------------------------------------------------------------------
+// FILE: sharded_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Thread-safe collection that partitions its keys across a
+// number of inner collections (shards), each with its own lock, so
+// writers to different shards run at the same time instead of taking
+// turns behind one lock (see ConcurrentCollection). A partition policy
+// maps each key to a shard:
+//
+//   HashPartition   spreads keys evenly by hash (the default); range
+//                   finds and sort visit every shard and merge
+//   RangePartition  splits the key space at given keys, so shard i
+//                   holds the keys below shard i+1's; range finds only
+//                   visit the shards the range covers, and sort
+//                   concatenates the shards in order
+//
+// The shards can be any collection (RBTCollection by default). Keys are
+// ordered by a compare policy (see key_compare.h), which must be the
+// one the shards and a range partition use. Each operation on one key
+// locks only that key's shard; operations over many keys (range find,
+// keys, sort, size) lock one shard at a time, so they see each shard
+// at a consistent point but not the whole collection at one instant. As in ConcurrentCollection, find_or_insert
+// and find_ptr are not safe while other threads write; update() changes
+// a value in place under the shard lock.
+//----------------------------------------------------------------------
+
+#ifndef SHARDED_COLLECTION_H
+#define SHARDED_COLLECTION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include "collection.h"
+#include "array_list.h"
+#include "rbt_collection.h"
+#include "hash_table_collection.h"
+#include "array_list_collection.h"
+#include "key_compare.h"
+#include "rw_lock.h"
+
+
+// hash partition policy (the hash is mixed before it is reduced to a
+// shard, so that keys whose hashes share low bits, like small ints,
+// still spread out, and so a HashTableCollection shard using the same
+// hash doesn't see only the keys of one residue; keys are hashed as
+// they are, so it only suits the default compare policy)
+template<typename K>
+class HashPartition
+{
+public:
+  static const bool ordered = false;
+
+  explicit HashPartition(size_t shard_count = 16)
+    : count(shard_count ? shard_count : 1) {}
+
+  size_t shards() const {return count;}
+
+  size_t shard(const K& key) const
+  {
+    uint64_t h = uint64_t(KeyHash<K>()(key)) * 0x9e3779b97f4a7c15ull;
+    return size_t((h >> 32) % count);
+  }
+
+  size_t dynamic_memory() const {return 0;}
+
+private:
+  size_t count;
+};
+
+
+// range partition policy (shard i holds the keys >= split_keys[i-1]
+// and < split_keys[i] in the order of the compare policy, which must
+// be the shards' own)
+template<typename K, typename Compare = ThreeWayCompare<K>>
+class RangePartition
+{
+public:
+  static const bool ordered = true;
+
+  // one shard holding every key
+  RangePartition() {}
+
+  // split_keys must be in ascending order
+  explicit RangePartition(const ArrayList<K>& split_keys)
+    : bounds(split_keys) {}
+
+  // split a sample of the keys (in any order) into shard_count shards
+  // of about the same number of keys
+  static RangePartition<K,Compare> from_sample(ArrayList<K> sample, size_t shard_count)
+  {
+    if(sample.size() > 0)
+      std::sort(&sample[0], &sample[0] + sample.size(), less);
+    ArrayList<K> split_keys;
+    for(size_t i = 1; i < shard_count && sample.size() > 0; ++i)
+      split_keys.add(sample[i * sample.size() / shard_count]);
+    return RangePartition<K,Compare>(split_keys);
+  }
+
+  size_t shards() const {return bounds.size() + 1;}
+
+  // the number of split keys <= key (binary search)
+  size_t shard(const K& key) const
+  {
+    size_t lo = 0;
+    size_t hi = bounds.size();
+    while(lo < hi){
+      size_t mid = lo + (hi - lo) / 2;
+      if(Compare()(key, bounds[mid]) < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+
+  size_t dynamic_memory() const {return bounds.dynamic_memory();}
+
+private:
+  ArrayList<K> bounds;
+
+  static bool less(const K& a, const K& b) {return Compare()(a, b) < 0;}
+};
+
+
+// detects shard collections whose range finds return keys out of order
+// (their runs are sorted before they are merged)
+template<typename Impl>
+struct UnorderedRangeFind : std::false_type {};
+
+template<typename K, typename V>
+struct UnorderedRangeFind<HashTableCollection<K,V>> : std::true_type {};
+
+template<typename K, typename V>
+struct UnorderedRangeFind<ArrayListCollection<K,V>> : std::true_type {};
+
+
+template<typename K, typename V, typename Impl = RBTCollection<K,V>,
+         typename Partition = HashPartition<K>, typename Lock = RWLock,
+         typename Compare = ThreeWayCompare<K>>
+class ShardedCollection : public Collection<K,V>
+{
+public:
+
+  // create a collection with one empty shard per partition shard
+  explicit ShardedCollection(const Partition& a_partition = Partition());
+
+  // delete the shards
+  ~ShardedCollection();
+
+  // the shard locks can't be copied
+  ShardedCollection(const ShardedCollection<K,V,Impl,Partition,Lock,Compare>& rhs) = delete;
+  ShardedCollection<K,V,Impl,Partition,Lock,Compare>&
+  operator=(const ShardedCollection<K,V,Impl,Partition,Lock,Compare>& rhs) = delete;
+
+  // add a new key-value pair into the collection
+  void add(const K& a_key, const V& a_val);
+
+  // remove a key-value pair from the collection
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // return the value associated with the key, adding the key with a
+  // default value if it isn't found (not thread safe: the shard lock is
+  // released on return, so the reference may only be used while no
+  // other thread writes to the shard; use update() instead)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found (not thread safe, as for find_or_insert)
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // call update(value) with exclusive access to the key's shard on the
+  // value associated with the key, adding the key with a default value
+  // if it isn't found
+  template<typename Update>
+  void update(const K& a_key, Update update);
+
+  // find and return each key >= k1 and <= k2 (in ascending order)
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return the number of bytes used by the collection
+  size_t memory_usage() const;
+
+  // number of shards, and the shard holding a key
+  size_t shard_count() const;
+  size_t shard_of(const K& a_key) const;
+
+private:
+
+  // an inner collection and its lock (on their own cache lines, so
+  // threads working on neighboring shards don't share a line)
+  struct alignas(64) Shard {
+    Impl collection;
+    mutable Lock lock;
+  };
+
+  // key to shard mapping
+  Partition partition;
+
+  // the shards (one per partition shard)
+  Shard* shards;
+  size_t count;
+
+  // key order of the compare policy (the shards' own)
+  static bool less(const K& a, const K& b) {return Compare()(a, b) < 0;}
+
+  // helper to merge sorted runs, where run i is
+  // keys[starts[i]..starts[i+1])
+  static void merge_runs(ArrayList<K>& keys, const ArrayList<size_t>& starts);
+};
+
+
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+ShardedCollection<K,V,Impl,Partition,Lock,Compare>::ShardedCollection(const Partition& a_partition)
+  : partition(a_partition), count(a_partition.shards())
+{
+  shards = new Shard[count];
+}
+
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+ShardedCollection<K,V,Impl,Partition,Lock,Compare>::~ShardedCollection()
+{
+  delete [] shards;
+}
+
+//  Function: add()
+//  Description: Adds a key-value pair to its shard while holding the
+//  shard's exclusive access
+//  Inputs: Key and value to be added
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::add(const K& a_key, const V& a_val)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  s.collection.add(a_key, a_val);
+}
+
+//  Function: remove()
+//  Description: Removes a key-value pair from its shard while holding
+//  the shard's exclusive access
+//  Inputs: The key of the pair to be removed
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::remove(const K& a_key)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  s.collection.remove(a_key);
+}
+
+//  Function: find()
+//  Description: Finds the value of a key in its shard while holding the
+//  shard's shared access
+//  Inputs: Key to search for, variable for the value
+//  Outputs: True if the key was found
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+bool ShardedCollection<K,V,Impl,Partition,Lock,Compare>::find(const K& search_key, V& the_val) const
+{
+  const Shard& s = shards[partition.shard(search_key)];
+  SharedGuard<Lock> guard(s.lock);
+  return s.collection.find(search_key, the_val);
+}
+
+//  Function: find_or_insert()
+//  Description: Finds or adds a key in its shard while holding the
+//  shard's exclusive access
+//  Inputs: Key to search for
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+V& ShardedCollection<K,V,Impl,Partition,Lock,Compare>::find_or_insert(const K& a_key)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  return s.collection.find_or_insert(a_key);
+}
+
+//  Function: insert_or_assign()
+//  Description: Adds or replaces a key-value pair in its shard while
+//  holding the shard's exclusive access
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+bool ShardedCollection<K,V,Impl,Partition,Lock,Compare>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  return s.collection.insert_or_assign(a_key, a_val);
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value of a key in place while holding the
+//  shard's exclusive (or, for the const version, shared) access
+//  Inputs: Key to search for
+//  Outputs: Pointer to the value (nullptr if not found)
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+V* ShardedCollection<K,V,Impl,Partition,Lock,Compare>::find_ptr(const K& a_key)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  return s.collection.find_ptr(a_key);
+}
+
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+const V* ShardedCollection<K,V,Impl,Partition,Lock,Compare>::find_ptr(const K& a_key) const
+{
+  const Shard& s = shards[partition.shard(a_key)];
+  SharedGuard<Lock> guard(s.lock);
+  return s.collection.find_ptr(a_key);
+}
+
+//  Function: update()
+//  Description: Finds or adds a key in its shard and runs an operation
+//  on its value while holding the shard's exclusive access
+//  Inputs: Key to search for, function called with a reference to the
+//  value
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+template<typename Update>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::update(const K& a_key, Update update)
+{
+  Shard& s = shards[partition.shard(a_key)];
+  std::lock_guard<Lock> guard(s.lock);
+  update(s.collection.find_or_insert(a_key));
+}
+
+//  Function: find()
+//  Description: Finds the keys in a range, one shard at a time. With a
+//  range partition only the shards covering the range are searched and
+//  their (sorted) results follow each other in order; otherwise every
+//  shard is searched and the sorted results are merged.
+//  Inputs: Smallest and largest key of the range, list for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::find(const K& k1, const K& k2,
+                                                              ArrayList<K>& keys) const
+{
+  if(less(k2, k1)) return;
+  size_t first = 0;
+  size_t last = count - 1;
+  if(Partition::ordered){
+    first = partition.shard(k1);
+    last = partition.shard(k2);
+  }
+  ArrayList<size_t> starts;
+  for(size_t i = first; i <= last; ++i){
+    size_t start = keys.size();
+    starts.add(start);
+    {
+      SharedGuard<Lock> guard(shards[i].lock);
+      shards[i].collection.find(k1, k2, keys);
+    }
+    // hash tables (and unsorted lists) find ranges out of order
+    if(UnorderedRangeFind<Impl>::value && keys.size() > start)
+      std::sort(&keys[start], &keys[0] + keys.size(), less);
+  }
+  starts.add(keys.size());
+  if(!Partition::ordered)
+    merge_runs(keys, starts);
+}
+
+//  Function: keys()
+//  Description: Returns all keys, one shard at a time
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::keys(ArrayList<K>& all_keys) const
+{
+  for(size_t i = 0; i < count; ++i){
+    SharedGuard<Lock> guard(shards[i].lock);
+    shards[i].collection.keys(all_keys);
+  }
+}
+
+//  Function: sort()
+//  Description: Returns all keys in order: each shard's sorted keys,
+//  one shard after another with a range partition, otherwise merged
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  ArrayList<size_t> starts;
+  for(size_t i = 0; i < count; ++i){
+    starts.add(all_keys_sorted.size());
+    SharedGuard<Lock> guard(shards[i].lock);
+    shards[i].collection.sort(all_keys_sorted);
+  }
+  starts.add(all_keys_sorted.size());
+  if(!Partition::ordered)
+    merge_runs(all_keys_sorted, starts);
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs, adding up the shards
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+size_t ShardedCollection<K,V,Impl,Partition,Lock,Compare>::size() const
+{
+  size_t total = 0;
+  for(size_t i = 0; i < count; ++i){
+    SharedGuard<Lock> guard(shards[i].lock);
+    total += shards[i].collection.size();
+  }
+  return total;
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the collection object, the
+//  partition, the shard array and locks, and each shard's collection
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+size_t ShardedCollection<K,V,Impl,Partition,Lock,Compare>::memory_usage() const
+{
+  size_t bytes = sizeof(*this) + partition.dynamic_memory()
+    + count * (sizeof(Shard) - sizeof(Impl));
+  for(size_t i = 0; i < count; ++i){
+    SharedGuard<Lock> guard(shards[i].lock);
+    bytes += shards[i].collection.memory_usage();
+  }
+  return bytes;
+}
+
+//  Function: shard_count()
+//  Description: Returns the number of shards
+//  Inputs: None
+//  Outputs: Number of shards
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+size_t ShardedCollection<K,V,Impl,Partition,Lock,Compare>::shard_count() const
+{
+  return count;
+}
+
+//  Function: shard_of()
+//  Description: Returns the shard a key belongs to
+//  Inputs: Key
+//  Outputs: Shard index (0 to shard_count() - 1)
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+size_t ShardedCollection<K,V,Impl,Partition,Lock,Compare>::shard_of(const K& a_key) const
+{
+  return partition.shard(a_key);
+}
+
+// helper function for find and sort: merge neighboring runs in pairs
+// until one run is left (log of the number of runs passes)
+template<typename K, typename V, typename Impl, typename Partition, typename Lock,
+         typename Compare>
+void ShardedCollection<K,V,Impl,Partition,Lock,Compare>::merge_runs(ArrayList<K>& keys,
+                                                                    const ArrayList<size_t>& starts)
+{
+  size_t runs = starts.size() - 1;
+  if(keys.size() == 0) return;
+  K* base = &keys[0];
+  for(size_t width = 1; width < runs; width *= 2){
+    for(size_t i = 0; i + width < runs; i += 2 * width){
+      size_t end = std::min(i + 2 * width, runs);
+      std::inplace_merge(base + starts[i], base + starts[i + width], base + starts[end],
+                         less);
+    }
+  }
+}
+
+
+#endif
@@ -0,0 +1,656 @@
+//----------------------------------------------------------------------
+// FILE: wal_collection.h
+// NAME: Joshua Seward
+// DATE: October 16, 2026
+// DESC: Durable wrapper around a collection (an RBTCollection by
+// default). Each add, remove, insert_or_assign and update is appended
+// to a write-ahead log before it is applied (values are changed in
+// place with update, since writes through find_or_insert and find_ptr
+// are not logged). Records are group committed:
+// they are buffered and written with one fsync once group_size of them
+// are pending (or on sync()), so a group_size of 1 makes every write
+// durable when it returns and larger groups trade the last few writes
+// for throughput. checkpoint() writes a snapshot of the collection and
+// starts an empty log, and open() recovers by loading the snapshot and
+// replaying the log on top of it.
+//
+// Log records are [length][checksum][type][key][value], with keys and
+// values written by Serializer (serialize.h). Recovery stops at the
+// first torn or corrupt record and cuts the log there. Adds are
+// replayed as insert_or_assign, so replaying a log whose writes are
+// already in the snapshot (a crash during checkpoint) changes nothing;
+// the catch is that a key added twice recovers as one pair holding the
+// last value.
+//
+// If a write or fsync of the log fails, the log is cut back to the end
+// of the last synced group and the collection stops taking writes:
+// add, remove, insert_or_assign and update change nothing
+// (find_or_insert returns a scratch value) until open is called again. failed() reports
+// this state.
+//----------------------------------------------------------------------
+
+#ifndef WAL_COLLECTION_H
+#define WAL_COLLECTION_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include "collection.h"
+#include "array_list.h"
+#include "rbt_collection.h"
+#include "serialize.h"
+
+
+template<typename K, typename V, typename Impl = RBTCollection<K,V>>
+class WALCollection : public Collection<K,V>
+{
+public:
+
+  // create a collection with no log open (writes are not logged until
+  // open is called)
+  WALCollection();
+
+  // sync and close the log
+  ~WALCollection();
+
+  // the log file can't be shared by two collections
+  WALCollection(const WALCollection<K,V,Impl>& rhs) = delete;
+  WALCollection<K,V,Impl>& operator=(const WALCollection<K,V,Impl>& rhs) = delete;
+
+  // recover the collection from the snapshot (if there is one) and the
+  // log (if there is one), then log every write to the end of the log,
+  // syncing once group_size records are pending; returns false if the
+  // snapshot or log can't be read or the log can't be opened
+  bool open(const std::string& snapshot_path, const std::string& log_path,
+            size_t group_size = 1);
+
+  // write and fsync every pending record; returns false on an I/O error
+  bool sync();
+
+  // write a snapshot of the collection (atomically replacing the old
+  // one) and empty the log; returns false on an I/O error
+  bool checkpoint();
+
+  // number of records logged but not yet synced
+  size_t pending() const;
+
+  // true if a log write failed (writes are refused until the next open)
+  bool failed() const;
+
+  // add a new key-value pair into the collection (not added if the
+  // record can't be logged; check failed())
+  void add(const K& a_key, const V& a_val);
+
+  // remove a key-value pair from the collection (not removed if the
+  // record can't be logged; check failed())
+  void remove(const K& a_key);
+
+  // find and return the value associated with the key
+  bool find(const K& search_key, V& the_val) const;
+
+  // return the value associated with the key, adding (and logging) the
+  // key with a default value if it isn't found (changes made through
+  // the reference are not logged; use update)
+  V& find_or_insert(const K& a_key);
+
+  // add the key-value pair, or replace the value if the key is
+  // already in the collection; returns true if the pair was added
+  // (false, with nothing changed, if the record can't be logged)
+  bool insert_or_assign(const K& a_key, const V& a_val);
+
+  // return a pointer to the value associated with the key, or nullptr
+  // if the key isn't found (changes made through the pointer are not
+  // logged; use update)
+  V* find_ptr(const K& a_key);
+  const V* find_ptr(const K& a_key) const;
+
+  // call update(value) on the value associated with the key (a default
+  // value if it isn't found) and log the new value, e.g., to bump a
+  // counter; the stored value is only changed once the record is
+  // logged (nothing is changed if it can't be; check failed())
+  template<typename Update>
+  void update(const K& a_key, Update update);
+
+  // find and return each key >= k1 and <= k2
+  void find(const K& k1, const K& k2, ArrayList<K>& keys) const;
+
+  // return all of the keys in the collection
+  void keys(ArrayList<K>& all_keys) const;
+
+  // return all of the keys in ascending (sorted) order
+  void sort(ArrayList<K>& all_keys_sorted) const;
+
+  // return the number of key-value pairs in the collection
+  size_t size() const;
+
+  // return the number of bytes used by the collection (including the
+  // buffer of records waiting to be synced)
+  size_t memory_usage() const;
+
+  // the wrapped collection (read only, since writes must be logged)
+  const Impl& wrapped() const;
+
+private:
+
+  // log record types
+  enum record_t : uint8_t {PUT = 1, REMOVE = 2};
+
+  // the wrapped collection
+  Impl collection;
+
+  // snapshot and log file paths
+  std::string snapshot_path;
+  std::string log_path;
+
+  // log file descriptor (-1 if no log is open)
+  int log_fd;
+
+  // records to sync at once
+  size_t group_size;
+
+  // records not yet written and synced, and how many there are
+  std::string buffer;
+  size_t buffered;
+
+  // log length as of the last successful sync
+  uint64_t synced_length;
+
+  // set when a log write fails, and cleared by open
+  bool io_error;
+
+  // returned by find_or_insert when the new key can't be logged
+  V rejected;
+
+  // helper to append a record to the buffer (syncing a full group);
+  // returns false if the record was not logged
+  bool log(record_t type, const K& a_key, const V* a_val);
+
+  // helper to replay the log, returning the length of its valid prefix
+  bool replay(const std::string& path, uint64_t& valid_length);
+
+  // helpers to write and read a snapshot (the RBTCollection save
+  // format, through save/load if the wrapped collection has them)
+  bool write_snapshot(const std::string& path) const;
+  bool read_snapshot(const std::string& path);
+
+  // helper to checksum a record (FNV-1a)
+  static uint32_t checksum(const char* data, size_t length);
+
+  // helper to write all of a byte string to a file descriptor
+  static bool write_all(int fd, const char* data, size_t length);
+
+  // helper to fsync the directory holding a file (making a rename in
+  // it durable)
+  static bool sync_directory(const std::string& path);
+};
+
+
+// detects collections with their own save(path) and load(path)
+template<typename T, typename = void>
+struct HasSaveLoad : std::false_type {};
+
+template<typename T>
+struct HasSaveLoad<T, std::void_t<decltype(std::declval<const T&>().save(std::string())),
+                                  decltype(std::declval<T&>().load(std::string()))>>
+  : std::true_type {};
+
+
+template<typename K, typename V, typename Impl>
+WALCollection<K,V,Impl>::WALCollection()
+  : log_fd(-1), group_size(1), buffered(0), synced_length(0),
+    io_error(false), rejected()
+{
+}
+
+template<typename K, typename V, typename Impl>
+WALCollection<K,V,Impl>::~WALCollection()
+{
+  if(log_fd >= 0){
+    sync();
+    ::close(log_fd);
+  }
+}
+
+//  Function: open()
+//  Description: Recovers the collection (snapshot, then log replay),
+//  cuts off any torn record at the end of the log, and opens the log
+//  for appending
+//  Inputs: Snapshot and log file paths, number of records per fsync
+//  Outputs: True if recovery succeeded and the log is open
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::open(const std::string& a_snapshot_path,
+                                   const std::string& a_log_path,
+                                   size_t a_group_size)
+{
+  if(log_fd >= 0){
+    sync();
+    ::close(log_fd);
+    log_fd = -1;
+  }
+  snapshot_path = a_snapshot_path;
+  log_path = a_log_path;
+  group_size = a_group_size ? a_group_size : 1;
+  collection = Impl();
+  buffer.clear();
+  buffered = 0;
+  io_error = false;
+  uint64_t valid_length = 0;
+  if(!read_snapshot(snapshot_path) || !replay(log_path, valid_length))
+    return false;
+  log_fd = ::open(log_path.c_str(), O_WRONLY | O_CREAT, 0644);
+  if(log_fd < 0) return false;
+  // drop a torn record left by a crash, so new records follow valid ones
+  if(ftruncate(log_fd, valid_length) != 0 || lseek(log_fd, 0, SEEK_END) < 0
+     || fsync(log_fd) != 0){
+    ::close(log_fd);
+    log_fd = -1;
+    return false;
+  }
+  synced_length = valid_length;
+  return true;
+}
+
+//  Function: sync()
+//  Description: Writes the pending records to the log with one write
+//  and makes them durable with one fsync (the group commit). If either
+//  fails, the log is cut back to its last synced length (so a torn
+//  group can't hide later records from recovery) and the collection
+//  stops taking writes.
+//  Inputs: None
+//  Outputs: True if the records are durable
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::sync()
+{
+  if(io_error) return false;
+  if(log_fd < 0 || buffered == 0) return true;
+  bool ok = write_all(log_fd, buffer.data(), buffer.size()) && fsync(log_fd) == 0;
+  if(ok)
+    synced_length += buffer.size();
+  else{
+    io_error = true;
+    if(ftruncate(log_fd, synced_length) == 0)
+      lseek(log_fd, synced_length, SEEK_SET);
+  }
+  buffer.clear();
+  buffered = 0;
+  return ok;
+}
+
+//  Function: checkpoint()
+//  Description: Writes a snapshot to a temporary file, syncs it, renames
+//  it over the old snapshot, syncs the snapshot's directory so the
+//  rename is on disk, and then empties the log. A crash before the
+//  rename keeps the old snapshot and the full log; a crash after it
+//  replays the log over the new snapshot, which changes nothing.
+//  Inputs: None
+//  Outputs: True if the snapshot was written and the log emptied
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::checkpoint()
+{
+  if(log_fd < 0 || !sync()) return false;
+  std::string tmp_path = snapshot_path + ".tmp";
+  if(!write_snapshot(tmp_path)) return false;
+  int fd = ::open(tmp_path.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+  bool synced = fsync(fd) == 0;
+  ::close(fd);
+  if(!synced || rename(tmp_path.c_str(), snapshot_path.c_str()) != 0
+     || !sync_directory(snapshot_path))
+    return false;
+  if(ftruncate(log_fd, 0) != 0 || lseek(log_fd, 0, SEEK_SET) != 0
+     || fsync(log_fd) != 0){
+    io_error = true;
+    return false;
+  }
+  synced_length = 0;
+  return true;
+}
+
+//  Function: pending()
+//  Description: Returns the number of records not yet synced
+//  Inputs: None
+//  Outputs: Number of buffered records
+template<typename K, typename V, typename Impl>
+size_t WALCollection<K,V,Impl>::pending() const
+{
+  return buffered;
+}
+
+//  Function: failed()
+//  Description: Returns whether a log write has failed since open
+//  Inputs: None
+//  Outputs: True if writes are being refused
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::failed() const
+{
+  return io_error;
+}
+
+//  Function: add()
+//  Description: Logs and then adds a key-value pair
+//  Inputs: Key and value to be added
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+void WALCollection<K,V,Impl>::add(const K& a_key, const V& a_val)
+{
+  if(log(PUT, a_key, &a_val))
+    collection.add(a_key, a_val);
+}
+
+//  Function: remove()
+//  Description: Logs and then removes a key-value pair
+//  Inputs: The key of the pair to be removed
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+void WALCollection<K,V,Impl>::remove(const K& a_key)
+{
+  if(log(REMOVE, a_key, nullptr))
+    collection.remove(a_key);
+}
+
+//  Function: find()
+//  Description: Finds the value of a key
+//  Inputs: Key to search for, variable for the value
+//  Outputs: True if the key was found
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::find(const K& search_key, V& the_val) const
+{
+  return collection.find(search_key, the_val);
+}
+
+//  Function: find_or_insert()
+//  Description: Finds a key, logging and adding it with a default value
+//  if it isn't found
+//  Inputs: Key to search for
+//  Outputs: Reference to the value associated with the key
+template<typename K, typename V, typename Impl>
+V& WALCollection<K,V,Impl>::find_or_insert(const K& a_key)
+{
+  V* val = collection.find_ptr(a_key);
+  if(val) return *val;
+  V default_val = V();
+  if(!log(PUT, a_key, &default_val)){
+    rejected = V();
+    return rejected;
+  }
+  return collection.find_or_insert(a_key);
+}
+
+//  Function: insert_or_assign()
+//  Description: Logs and then adds or replaces a key-value pair
+//  Inputs: Key and value to be stored
+//  Outputs: True if the pair was added
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::insert_or_assign(const K& a_key, const V& a_val)
+{
+  if(!log(PUT, a_key, &a_val)) return false;
+  return collection.insert_or_assign(a_key, a_val);
+}
+
+//  Function: find_ptr()
+//  Description: Finds the value of a key in place
+//  Inputs: Key to search for
+//  Outputs: Pointer to the value (nullptr if not found)
+template<typename K, typename V, typename Impl>
+V* WALCollection<K,V,Impl>::find_ptr(const K& a_key)
+{
+  return collection.find_ptr(a_key);
+}
+
+template<typename K, typename V, typename Impl>
+const V* WALCollection<K,V,Impl>::find_ptr(const K& a_key) const
+{
+  return collection.find_ptr(a_key);
+}
+
+//  Function: update()
+//  Description: Runs an operation on a copy of a key's value (or a
+//  default value), logs the result, and then stores it
+//  Inputs: Key to update, function called with a reference to the
+//  value
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+template<typename Update>
+void WALCollection<K,V,Impl>::update(const K& a_key, Update update)
+{
+  if(io_error) return;
+  V* val = collection.find_ptr(a_key);
+  V new_val = val ? *val : V();
+  update(new_val);
+  if(!log(PUT, a_key, &new_val)) return;
+  if(val)
+    *val = std::move(new_val);
+  else
+    collection.find_or_insert(a_key) = std::move(new_val);
+}
+
+//  Function: find()
+//  Description: Finds the keys in a range
+//  Inputs: Smallest and largest key of the range, list for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+void WALCollection<K,V,Impl>::find(const K& k1, const K& k2, ArrayList<K>& keys) const
+{
+  collection.find(k1, k2, keys);
+}
+
+//  Function: keys()
+//  Description: Returns all keys
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+void WALCollection<K,V,Impl>::keys(ArrayList<K>& all_keys) const
+{
+  collection.keys(all_keys);
+}
+
+//  Function: sort()
+//  Description: Returns all keys in order
+//  Inputs: List for the keys
+//  Outputs: None
+template<typename K, typename V, typename Impl>
+void WALCollection<K,V,Impl>::sort(ArrayList<K>& all_keys_sorted) const
+{
+  collection.sort(all_keys_sorted);
+}
+
+//  Function: size()
+//  Description: Returns the number of pairs
+//  Inputs: None
+//  Outputs: Number of key-value pairs
+template<typename K, typename V, typename Impl>
+size_t WALCollection<K,V,Impl>::size() const
+{
+  return collection.size();
+}
+
+//  Function: memory_usage()
+//  Description: Returns the bytes used by the wrapper, its record
+//  buffer and paths, and the wrapped collection
+//  Inputs: None
+//  Outputs: Number of bytes
+template<typename K, typename V, typename Impl>
+size_t WALCollection<K,V,Impl>::memory_usage() const
+{
+  return sizeof(*this) - sizeof(collection) + collection.memory_usage()
+    + DynamicMemory<std::string>::bytes(buffer)
+    + DynamicMemory<std::string>::bytes(snapshot_path)
+    + DynamicMemory<std::string>::bytes(log_path)
+    + DynamicMemory<V>::bytes(rejected);
+}
+
+//  Function: wrapped()
+//  Description: Returns the wrapped collection for read-only use
+//  Inputs: None
+//  Outputs: Const reference to the collection
+template<typename K, typename V, typename Impl>
+const Impl& WALCollection<K,V,Impl>::wrapped() const
+{
+  return collection;
+}
+
+// helper function for the writes: buffer one record
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::log(record_t type, const K& a_key, const V* a_val)
+{
+  if(io_error) return false;
+  if(log_fd < 0) return true;
+  std::ostringstream payload;
+  payload.put(char(type));
+  Serializer<K>::write(payload, a_key);
+  if(a_val) Serializer<V>::write(payload, *a_val);
+  std::string bytes = payload.str();
+  uint32_t header[2] = {uint32_t(bytes.size()), checksum(bytes.data(), bytes.size())};
+  buffer.append(reinterpret_cast<const char*>(header), sizeof(header));
+  buffer += bytes;
+  if(++buffered >= group_size) return sync();
+  return true;
+}
+
+// helper function for open: apply each complete record in the log
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::replay(const std::string& path, uint64_t& valid_length)
+{
+  valid_length = 0;
+  std::ifstream in(path, std::ios::binary);
+  if(!in) return true;  // no log yet
+  std::string log_bytes((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+  if(in.bad()) return false;
+  size_t pos = 0;
+  uint32_t header[2];
+  while(log_bytes.size() - pos >= sizeof(header)){
+    memcpy(header, log_bytes.data() + pos, sizeof(header));
+    size_t start = pos + sizeof(header);
+    // a torn or corrupt record ends the log
+    if(header[0] == 0 || log_bytes.size() - start < header[0]
+       || checksum(log_bytes.data() + start, header[0]) != header[1])
+      break;
+    std::istringstream record(log_bytes.substr(start, header[0]));
+    char type = 0;
+    K key;
+    V val;
+    record.get(type);
+    if(!Serializer<K>::read(record, key)) break;
+    if(type == PUT){
+      if(!Serializer<V>::read(record, val)) break;
+      collection.insert_or_assign(key, val);
+    }
+    else if(type == REMOVE)
+      collection.remove(key);
+    else
+      break;
+    pos = start + header[0];
+  }
+  valid_length = pos;
+  return true;
+}
+
+// helper function for checkpoint
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::write_snapshot(const std::string& path) const
+{
+  if constexpr(HasSaveLoad<Impl>::value)
+    return collection.save(path);
+  else{
+    // same layout as RBTCollection::save
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out) return false;
+    ArrayList<K> sorted;
+    collection.sort(sorted);
+    out.write("RBT1", 4);
+    Serializer<uint64_t>::write(out, sorted.size());
+    for(size_t i = 0; i < sorted.size(); ++i){
+      V val = V();
+      collection.find(sorted[i], val);
+      Serializer<K>::write(out, sorted[i]);
+      Serializer<V>::write(out, val);
+    }
+    out.flush();
+    return bool(out);
+  }
+}
+
+// helper function for open
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::read_snapshot(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if(!in) return true;  // no snapshot yet
+  if constexpr(HasSaveLoad<Impl>::value){
+    in.close();
+    return collection.load(path);
+  }
+  else{
+    char magic[4];
+    uint64_t n = 0;
+    if(!in.read(magic, sizeof(magic)) || memcmp(magic, "RBT1", 4) != 0
+       || !Serializer<uint64_t>::read(in, n))
+      return false;
+    for(uint64_t i = 0; i < n; ++i){
+      K key;
+      V val;
+      if(!Serializer<K>::read(in, key) || !Serializer<V>::read(in, val))
+        return false;
+      collection.add(key, val);
+    }
+    return true;
+  }
+}
+
+// helper function for log and replay
+template<typename K, typename V, typename Impl>
+uint32_t WALCollection<K,V,Impl>::checksum(const char* data, size_t length)
+{
+  uint32_t hash = 2166136261u;
+  for(size_t i = 0; i < length; ++i){
+    hash ^= (unsigned char)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// helper function for sync
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::write_all(int fd, const char* data, size_t length)
+{
+  while(length > 0){
+    ssize_t n = ::write(fd, data, length);
+    if(n < 0){
+      if(errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    length -= n;
+  }
+  return true;
+}
+
+// helper function for checkpoint
+template<typename K, typename V, typename Impl>
+bool WALCollection<K,V,Impl>::sync_directory(const std::string& path)
+{
+  size_t slash = path.rfind('/');
+  std::string dir = ".";
+  if(slash == 0)
+    dir = "/";
+  else if(slash != std::string::npos)
+    dir = path.substr(0, slash);
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if(fd < 0) return false;
+  bool synced = fsync(fd) == 0;
+  ::close(fd);
+  return synced;
+}
+
+
+#endif